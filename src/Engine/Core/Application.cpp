@@ -4,11 +4,17 @@
 #include "../../Scenes/Basic/TriangleScene.h"
 #include "../../Scenes/Basic/ModelLoadingScene.h"
 #include "../../Scenes/Performance/InstancingScene.h"
+#include "../../Scenes/Performance/MeshletScene.h"
+#include "../../Scenes/Performance/MathBenchmarkScene.h"
+#include "../../Scenes/Performance/GpuPrimitivesScene.h"
+#include "../../Scenes/Performance/ClusteredLightingScene.h"
 #include "../Renderer/VulkanDevice.h"
 #include "../Renderer/VulkanRenderer.h"
 #include "../Scene/Scene.h"
 #include "../UI/UISystem.h"
+#include "FramePacer.h"
 #include "Input.h"
+#include "JobSystem.h"
 
 #include <cstring>
 #include <iostream>
@@ -27,6 +33,9 @@ const bool enableValidationLayers = false;
 #endif
 
 Application::Application() {
+  // Created first: device and scene setup may already fan work out
+  jobSystem = std::make_unique<JobSystem>();
+
   initWindow();
   initVulkan();
 
@@ -52,9 +61,23 @@ Application::Application() {
   auto instancingScene = std::make_unique<InstancingScene>();
   sceneManager->addScene(std::move(instancingScene));
 
+  auto meshletScene = std::make_unique<MeshletScene>();
+  sceneManager->addScene(std::move(meshletScene));
+
+  auto mathBenchmarkScene = std::make_unique<MathBenchmarkScene>();
+  sceneManager->addScene(std::move(mathBenchmarkScene));
+
+  auto gpuPrimitivesScene = std::make_unique<GpuPrimitivesScene>();
+  sceneManager->addScene(std::move(gpuPrimitivesScene));
+
+  auto clusteredLightingScene = std::make_unique<ClusteredLightingScene>();
+  sceneManager->addScene(std::move(clusteredLightingScene));
+
   sceneManager->setCurrentScene("GPU Instancing Culling", renderer.get());
 
   uiSystem->setSceneManager(sceneManager.get());
+  uiSystem->setSimulationClock(&simulationClock);
+  uiSystem->setFramePacer(framePacer.get());
   uiSystem->setExitCallback(
       [this]() { glfwSetWindowShouldClose(window, GLFW_TRUE); });
 }
@@ -72,6 +95,14 @@ void Application::initWindow() {
       glfwCreateWindow(WIDTH, HEIGHT, "AhnrealEngine VK", nullptr, nullptr);
   glfwSetWindowUserPointer(window, this);
   glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+  glfwSetWindowFocusCallback(window, windowFocusCallback);
+  glfwSetWindowIconifyCallback(window, windowIconifyCallback);
+  glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+
+  framePacer = std::make_unique<FramePacer>(window);
+
+  // Main-thread jobs must not wait for the next input event when idle
+  jobSystem->setMainThreadWakeup([]() { glfwPostEmptyEvent(); });
 }
 
 void Application::initVulkan() {
@@ -91,11 +122,25 @@ void Application::initUI() {
 void Application::mainLoop() {
   auto currentTime = std::chrono::high_resolution_clock::now();
 
-  while (!glfwWindowShouldClose(window)) {
-    glfwPollEvents();
+  // Pending simulation of the next frame for pipelined scenes
+  JobCounter simulation;
+  bool simulationInFlight = false;
 
-    // Update Input system at start of frame
-    Input::update();
+  while (!glfwWindowShouldClose(window)) {
+    // The simulation job reads input and scene state, both of which change
+    // below, so it has to finish first
+    jobSystem->wait(simulation);
+
+    // Sleeps up to the frame cap of the window state, then pumps events,
+    // blocking while the window is minimized or the scene is idle
+    Scene *activeScene = sceneManager->getCurrentScene();
+    framePacer->limitFrameRate();
+    bool shouldRender = framePacer->pollEvents(
+        !activeScene || activeScene->needsContinuousRedraw());
+    jobSystem->processMainThreadJobs();
+    if (!shouldRender) {
+      continue;
+    }
 
     auto newTime = std::chrono::high_resolution_clock::now();
     float frameTime =
@@ -103,35 +148,119 @@ void Application::mainLoop() {
                                                                    currentTime)
             .count();
     currentTime = newTime;
+    if (framePacer->isIdle()) {
+      // Time spent blocked on events is not simulated; the event that woke
+      // us would otherwise apply a long delta (e.g. a camera jump)
+      frameTime = 0.0f;
+    }
+
+    if (sceneManager->processPendingSwitch(renderer.get())) {
+      // A packet simulated by the previous scene is of no use to this one
+      simulationInFlight = false;
+      // Loading time is not simulation time
+      simulationClock.reset();
+      currentTime = std::chrono::high_resolution_clock::now();
+    }
 
-    sceneManager->processPendingSwitch(renderer.get());
+    // UI widgets edit scene state, so the UI frame is built while no
+    // simulation is running and only its draw data is recorded later
+    uiSystem->newFrame();
+    sceneManager->renderUI();
+    ImDrawData *uiDrawData = uiSystem->finalizeFrame();
+
+    VkExtent2D extent = renderer->getSwapChainExtent();
+    bool minimized = extent.width == 0 || extent.height == 0;
+    float aspectRatio =
+        minimized ? 1.0f : (float)extent.width / (float)extent.height;
+
+    // While minimized, swap chain recreation pumps events on this thread,
+    // which must not overlap a simulation job reading input
+    Scene *scene = sceneManager->getCurrentScene();
+    if (scene && scene->supportsPipelinedUpdate() && !minimized) {
+      // The first frame of a pipelined scene has nothing simulated yet
+      if (!simulationInFlight) {
+        // This frame's time is simulated by the next packet below; priming
+        // with it as well would advance the clock twice. After a reset the
+        // clock still runs one step here.
+        FramePacket &packet = framePackets.simulationPacket();
+        beginSimulation(packet, 0.0f, aspectRatio);
+        simulate(packet);
+      }
+      framePackets.swap();
+
+      // Simulate frame N+1 while frame N is recorded below
+      FramePacket &next = framePackets.simulationPacket();
+      beginSimulation(next, frameTime, aspectRatio);
+      jobSystem->run([this, &next]() { simulate(next); }, &simulation);
+      simulationInFlight = true;
+    } else {
+      FramePacket &packet = framePackets.simulationPacket();
+      beginSimulation(packet, frameTime, aspectRatio);
+      simulate(packet);
+      framePackets.swap();
+      simulationInFlight = false;
+    }
 
-    if (auto commandBuffer = renderer->beginFrame()) {
-      sceneManager->update(frameTime);
-      sceneManager->preRender(renderer.get());
+    FramePacket &packet = framePackets.renderPacket();
+    packet.uiDrawData = uiDrawData;
 
-      renderer->beginSwapChainRenderPass(commandBuffer);
-      sceneManager->render(renderer.get());
+    if (auto commandBuffer = renderer->beginFrame()) {
+      sceneManager->preRender(renderer.get(), packet);
+
+      // Scenes replaying cached secondaries need the pass in secondary
+      // mode; their remaining draws go to the renderer's pass buffer
+      VkSubpassContents contents =
+          scene && scene->usesStaticCommandBuffers()
+              ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+              : VK_SUBPASS_CONTENTS_INLINE;
+      renderer->beginSwapChainRenderPass(commandBuffer, contents);
+      sceneManager->render(renderer.get(), packet);
+      renderer->flushRenderQueue(renderer->getPassCommandBuffer());
       renderer->endSwapChainRenderPass(commandBuffer);
 
-      uiSystem->newFrame();
-      sceneManager->renderUI();
-      uiSystem->render();
+      uiSystem->render(commandBuffer, packet.uiDrawData);
 
       renderer->endFrame();
     }
   }
 
-  vkDeviceWaitIdle(device->device());
+  jobSystem->wait(simulation);
+  device->waitIdle();
+}
+
+void Application::beginSimulation(FramePacket &packet, float frameTime,
+                                  float aspectRatio) {
+  Scene *scene = sceneManager->getCurrentScene();
+  uint32_t steps = simulationClock.advance(
+      frameTime, scene && scene->supportsFixedTimestep());
+
+  // The render packet holds the most recently simulated state
+  packet.reset(frameNumber++, simulationClock.getDeltaTime(), aspectRatio,
+               framePackets.renderPacket());
+  packet.simulationSteps = steps;
+  packet.interpolationAlpha = simulationClock.getAlpha();
+}
+
+void Application::simulate(FramePacket &packet) {
+  for (uint32_t step = 0; step < packet.simulationSteps; step++) {
+    // Input is sampled per step: the first step of a frame sees the mouse
+    // delta and key transitions, later steps see none
+    Input::update();
+
+    packet.previousCamera = packet.camera;
+    sceneManager->update(packet.deltaTime, packet);
+  }
 }
 
 void Application::cleanup() {
   // Ensure all GPU operations are finished before cleanup
   if (device) {
-    vkDeviceWaitIdle(device->device());
+    device->waitIdle();
   }
 
   sceneManager.reset();
+  // Workers may reference scene data until joined
+  jobSystem.reset();
   uiSystem.reset();
   renderer.reset();
   device.reset();
@@ -162,7 +291,8 @@ void Application::createInstance() {
   appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
   appInfo.pEngineName = "AhnrealEngine";
   appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-  appInfo.apiVersion = VK_API_VERSION_1_0;
+  // 1.2 for vkGetPhysicalDeviceFeatures2 and core descriptor indexing
+  appInfo.apiVersion = VK_API_VERSION_1_2;
 
   VkInstanceCreateInfo createInfo{};
   createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -272,6 +402,23 @@ void Application::framebufferResizeCallback(GLFWwindow *window, int width,
                                             int height) {
   auto app = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
   app->framebufferResized = true;
+  app->framePacer->notifyEvent();
+}
+
+void Application::windowFocusCallback(GLFWwindow *window, int focused) {
+  auto app = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
+  app->framePacer->setFocused(focused == GLFW_TRUE);
+}
+
+void Application::windowIconifyCallback(GLFWwindow *window, int iconified) {
+  auto app = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
+  app->framePacer->setIconified(iconified == GLFW_TRUE);
+}
+
+void Application::windowRefreshCallback(GLFWwindow *window) {
+  // Window contents were damaged (uncovered, resized); redraw even if idle
+  auto app = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
+  app->framePacer->notifyEvent();
 }
 
 VKAPI_ATTR VkBool32 VKAPI_CALL Application::debugCallback(
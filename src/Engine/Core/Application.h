@@ -5,6 +5,8 @@
 #include <memory>
 #include <vector>
 #include <chrono>
+#include "../Scene/FramePacket.h"
+#include "SimulationClock.h"
 
 namespace AhnrealEngine {
     
@@ -12,6 +14,8 @@ namespace AhnrealEngine {
     class VulkanRenderer;
     class UISystem;
     class SceneManager;
+    class JobSystem;
+    class FramePacer;
 
     class Application {
     public:
@@ -31,20 +35,35 @@ namespace AhnrealEngine {
         void initUI();
         void mainLoop();
         void cleanup();
+
+        // Main thread: advances the clock and prepares the packet
+        void beginSimulation(FramePacket& packet, float frameTime, float aspectRatio);
+        // Runs the steps planned by beginSimulation(); may run on a worker
+        void simulate(FramePacket& packet);
         
         static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+        static void windowFocusCallback(GLFWwindow* window, int focused);
+        static void windowIconifyCallback(GLFWwindow* window, int iconified);
+        static void windowRefreshCallback(GLFWwindow* window);
         
         GLFWwindow* window;
         VkInstance instance;
         VkDebugUtilsMessengerEXT debugMessenger;
         VkSurfaceKHR surface;
         
+        std::unique_ptr<JobSystem> jobSystem;
+        std::unique_ptr<FramePacer> framePacer;
         std::unique_ptr<VulkanDevice> device;
         std::unique_ptr<VulkanRenderer> renderer;
         std::unique_ptr<UISystem> uiSystem;
         std::unique_ptr<SceneManager> sceneManager;
         
         bool framebufferResized = false;
+
+        // Simulation writes one packet while the render stage reads the other
+        FramePacketBuffer framePackets;
+        uint64_t frameNumber = 0;
+        SimulationClock simulationClock;
         
         void createInstance();
         void setupDebugMessenger();
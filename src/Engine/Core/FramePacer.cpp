@@ -0,0 +1,155 @@
+#include "FramePacer.h"
+#include "Input.h"
+#include <algorithm>
+#include <thread>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+namespace AhnrealEngine {
+
+    // While nothing is visible the loop still wakes at this interval, so
+    // main-thread jobs and close requests are serviced
+    static constexpr double MINIMIZED_WAIT_SECONDS = 0.25;
+
+    // Upper bound on the yield phase of sleepUntil. Coarse sleeps can take
+    // far longer than asked (15.6 ms at the default Windows timer
+    // resolution), and spinning for that long every frame would burn the
+    // power the cap is meant to save.
+    static constexpr double MAX_SPIN_SECONDS = 0.001;
+
+    FramePacer::FramePacer(GLFWwindow* window)
+        : window{window}, lastEventTime{Clock::now()}, nextFrameTime{Clock::now()} {
+#ifdef _WIN32
+#ifdef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+        sleepTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+#endif
+    }
+
+    FramePacer::~FramePacer() {
+#ifdef _WIN32
+        if (sleepTimer != nullptr) {
+            CloseHandle(sleepTimer);
+            sleepTimer = nullptr;
+        }
+#endif
+    }
+
+    void FramePacer::notifyEvent() {
+        lastEventTime = Clock::now();
+    }
+
+    FramePacer::WindowState FramePacer::getWindowState() const {
+        if (iconified || isFramebufferEmpty()) return WindowState::Minimized;
+        if (!focused) return WindowState::Unfocused;
+        return WindowState::Active;
+    }
+
+    float FramePacer::getCurrentFrameCap() const {
+        switch (getWindowState()) {
+            case WindowState::Unfocused: return policy.unfocusedFrameCap;
+            default: return policy.activeFrameCap;
+        }
+    }
+
+    void FramePacer::limitFrameRate() {
+        float cap = getCurrentFrameCap();
+        Clock::time_point now = Clock::now();
+        if (cap <= 0.0f) {
+            nextFrameTime = now;
+            return;
+        }
+
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / cap));
+        if (nextFrameTime > now) {
+            sleepUntil(nextFrameTime);
+        }
+        // Advance on a fixed grid to avoid drift, but don't try to catch up
+        // on frames that were late
+        nextFrameTime = std::max(nextFrameTime + period, Clock::now());
+    }
+
+    bool FramePacer::pollEvents(bool sceneAnimating) {
+        WindowState state = getWindowState();
+        if (state == WindowState::Minimized) {
+            // Nothing to present to (the framebuffer is 0x0 on most
+            // platforms); block instead of spinning
+            idle = true;
+            glfwWaitEventsTimeout(MINIMIZED_WAIT_SECONDS);
+            return false;
+        }
+
+        double sinceEvent = std::chrono::duration<double>(Clock::now() - lastEventTime).count();
+        idle = policy.eventDrivenRedraw && !sceneAnimating && !Input::isAnyInputHeld() &&
+               sinceEvent > policy.idleLinger;
+
+        if (idle) {
+            glfwWaitEventsTimeout(policy.idleRedrawInterval);
+        } else {
+            glfwPollEvents();
+        }
+
+        uint64_t inputEvents = Input::getEventCount();
+        if (inputEvents != lastInputEventCount) {
+            lastInputEventCount = inputEvents;
+            notifyEvent();
+        }
+        return true;
+    }
+
+    void FramePacer::sleepUntil(Clock::time_point target) {
+        using namespace std::chrono;
+
+#ifdef _WIN32
+        // Without the high resolution timer, sleeps round up to the system
+        // timer period; raise it to 1 ms only for as long as we pace
+        const bool raiseTimerResolution = sleepTimer == nullptr;
+        if (raiseTimerResolution) timeBeginPeriod(1);
+#endif
+
+        while (true) {
+            double remaining = duration<double>(target - Clock::now()).count();
+            if (remaining <= std::min(sleepEstimate, MAX_SPIN_SECONDS)) break;
+
+            Clock::time_point start = Clock::now();
+            sleepOneMillisecond();
+            double observed = duration<double>(Clock::now() - start).count();
+
+            // Track the slow end of observed sleeps so we rarely overshoot
+            sleepEstimate = observed > sleepEstimate ? observed : sleepEstimate * 0.95 + observed * 0.05;
+        }
+
+#ifdef _WIN32
+        if (raiseTimerResolution) timeEndPeriod(1);
+#endif
+
+        while (Clock::now() < target) {
+            std::this_thread::yield();
+        }
+    }
+
+    void FramePacer::sleepOneMillisecond() {
+#ifdef _WIN32
+        if (sleepTimer != nullptr) {
+            // Relative due time in 100 ns units
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -10000;
+            if (SetWaitableTimerEx(sleepTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0)) {
+                WaitForSingleObject(sleepTimer, INFINITE);
+                return;
+            }
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    bool FramePacer::isFramebufferEmpty() const {
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window, &width, &height);
+        return width == 0 || height == 0;
+    }
+}
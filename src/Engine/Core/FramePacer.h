@@ -0,0 +1,86 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdint>
+
+namespace AhnrealEngine {
+
+    // Frame caps are in frames per second; 0 means uncapped (present mode
+    // still applies). Minimized windows have no cap: they never render, and
+    // the loop blocks on window events until the window is restored.
+    struct PowerPolicy {
+        float activeFrameCap = 0.0f;
+        float unfocusedFrameCap = 15.0f;
+
+        // Static scenes are only redrawn after input or window events
+        bool eventDrivenRedraw = true;
+        float idleLinger = 0.5f;          // Seconds of full-rate redraw after the last event (UI hover, fades)
+        float idleRedrawInterval = 1.0f;  // Longest wait between redraws while idle
+    };
+
+    // Decides how the main loop waits between frames. When the app is in
+    // use nothing is added to the frame; otherwise it blocks on window events
+    // or sleeps up to the cap of the current state instead of spinning.
+    class FramePacer {
+    public:
+        enum class WindowState {
+            Active,
+            Unfocused,
+            Minimized
+        };
+
+        explicit FramePacer(GLFWwindow* window);
+        ~FramePacer();
+
+        FramePacer(const FramePacer&) = delete;
+        FramePacer& operator=(const FramePacer&) = delete;
+
+        PowerPolicy& getPolicy() { return policy; }
+
+        // Fed from window callbacks
+        void setFocused(bool focused) { this->focused = focused; notifyEvent(); }
+        void setIconified(bool iconified) { this->iconified = iconified; notifyEvent(); }
+        void notifyEvent();
+
+        // Sleeps until the current state's cap allows the next frame
+        void limitFrameRate();
+
+        // Pumps window events, blocking while there is nothing to draw.
+        // Returns false when this iteration should not render.
+        bool pollEvents(bool sceneAnimating);
+
+        WindowState getWindowState() const;
+        bool isIdle() const { return idle; }
+        float getCurrentFrameCap() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        // Coarse sleeps while far from target, then yields for the remainder.
+        // The OS sleep granularity is learned from observed oversleep, but
+        // the yield phase never covers more than MAX_SPIN_SECONDS.
+        void sleepUntil(Clock::time_point target);
+        void sleepOneMillisecond();
+        bool isFramebufferEmpty() const;
+
+        GLFWwindow* window;
+        PowerPolicy policy;
+
+        bool focused = true;
+        bool iconified = false;
+        bool idle = false;
+
+        uint64_t lastInputEventCount = 0;
+        Clock::time_point lastEventTime;
+        Clock::time_point nextFrameTime;
+        double sleepEstimate = 0.002; // Seconds a 1 ms sleep is expected to take
+
+#ifdef _WIN32
+        // High resolution waitable timer; null where unsupported, in which
+        // case the system timer resolution is raised while sleeping instead
+        void* sleepTimer = nullptr;
+#endif
+    };
+}
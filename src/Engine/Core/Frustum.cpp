@@ -0,0 +1,62 @@
+#include "Frustum.h"
+#include "Camera.h"
+
+namespace AhnrealEngine {
+
+    Frustum Frustum::fromViewProjection(const glm::mat4& viewProj) {
+        // GLM is column-major; the transpose's columns are viewProj's rows
+        glm::mat4 rows = glm::transpose(viewProj);
+
+        Frustum frustum;
+        frustum.planes[Left] = rows[3] + rows[0];
+        frustum.planes[Right] = rows[3] - rows[0];
+        frustum.planes[Bottom] = rows[3] + rows[1];
+        frustum.planes[Top] = rows[3] - rows[1];
+        frustum.planes[Near] = rows[3] + rows[2];
+        frustum.planes[Far] = rows[3] - rows[2];
+
+        for (glm::vec4& plane : frustum.planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    Frustum Frustum::fromCamera(const Camera& camera, float aspectRatio) {
+        return fromViewProjection(camera.getProjectionMatrix(aspectRatio) * camera.getViewMatrix());
+    }
+
+    bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const {
+        for (const glm::vec4& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Frustum::intersectsBox(const glm::vec3& min, const glm::vec3& max) const {
+        for (const glm::vec4& plane : planes) {
+            // The corner furthest along the plane normal
+            glm::vec3 positive(plane.x >= 0.0f ? max.x : min.x,
+                               plane.y >= 0.0f ? max.y : min.y,
+                               plane.z >= 0.0f ? max.z : min.z);
+            if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Frustum::Containment Frustum::classifyBox(const glm::vec3& min, const glm::vec3& max) const {
+        glm::vec3 center = (min + max) * 0.5f;
+        glm::vec3 extent = (max - min) * 0.5f;
+        Containment result = Inside;
+        for (const glm::vec4& plane : planes) {
+            float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+            float reach = glm::dot(glm::abs(glm::vec3(plane)), extent);
+            if (distance + reach < 0.0f) return Outside;
+            if (distance - reach < 0.0f) result = Intersecting;
+        }
+        return result;
+    }
+}
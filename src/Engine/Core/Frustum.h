@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace AhnrealEngine {
+
+    class Camera;
+
+    // World-space view frustum as six inward-facing planes (xyz normal,
+    // w distance), normalized so plane distances are in world units. A point
+    // p is inside a plane when dot(plane.xyz, p) + plane.w >= 0.
+    struct Frustum {
+        enum Plane { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+        enum Containment { Outside, Intersecting, Inside };
+
+        glm::vec4 planes[PlaneCount];
+
+        // Gribb-Hartmann extraction from the rows of a view-projection matrix
+        static Frustum fromViewProjection(const glm::mat4& viewProj);
+        static Frustum fromCamera(const Camera& camera, float aspectRatio);
+
+        bool intersectsSphere(const glm::vec3& center, float radius) const;
+        bool intersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+        // Inside when the whole box is on the inner side of every plane, so
+        // hierarchies can accept a subtree without testing its children
+        Containment classifyBox(const glm::vec3& min, const glm::vec3& max) const;
+
+        // Batch tests over many spheres or boxes live in MathKernels and take
+        // planes directly
+    };
+}
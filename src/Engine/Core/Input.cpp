@@ -20,6 +20,7 @@ float Input::scrollDeltaY = 0.0f;
 float Input::scrollAccumulator = 0.0f;
 bool Input::firstMouse = true;
 bool Input::mouseCaptured = false;
+uint64_t Input::eventCount = 0;
 
 std::function<void(float, float)> Input::externalScrollCallback = nullptr;
 std::function<void(double, double)> Input::externalMouseMoveCallback = nullptr;
@@ -77,6 +78,18 @@ bool Input::isKeyJustReleased(int key) {
   return !keys[key] && keysLastFrame[key];
 }
 
+bool Input::isAnyInputHeld() {
+  for (int i = 0; i < MAX_MOUSE_BUTTONS; ++i) {
+    if (mouseButtons[i])
+      return true;
+  }
+  for (int i = 0; i < MAX_KEYS; ++i) {
+    if (keys[i])
+      return true;
+  }
+  return false;
+}
+
 bool Input::isMouseButtonPressed(int button) {
   if (button < 0 || button >= MAX_MOUSE_BUTTONS)
     return false;
@@ -129,6 +142,7 @@ void Input::setMouseMoveCallback(std::function<void(double, double)> callback) {
 
 void Input::keyCallback(GLFWwindow *window, int key, int scancode, int action,
                         int mods) {
+  eventCount++;
   if (key < 0 || key >= MAX_KEYS)
     return;
 
@@ -141,6 +155,7 @@ void Input::keyCallback(GLFWwindow *window, int key, int scancode, int action,
 
 void Input::mouseButtonCallback(GLFWwindow *window, int button, int action,
                                 int mods) {
+  eventCount++;
   if (button < 0 || button >= MAX_MOUSE_BUTTONS)
     return;
 
@@ -152,6 +167,7 @@ void Input::mouseButtonCallback(GLFWwindow *window, int button, int action,
 }
 
 void Input::cursorPosCallback(GLFWwindow *window, double xpos, double ypos) {
+  eventCount++;
   if (firstMouse) {
     lastMouseX = xpos;
     lastMouseY = ypos;
@@ -167,6 +183,7 @@ void Input::cursorPosCallback(GLFWwindow *window, double xpos, double ypos) {
 }
 
 void Input::scrollCallback(GLFWwindow *window, double xoffset, double yoffset) {
+  eventCount++;
   scrollAccumulator += static_cast<float>(yoffset);
 
   if (externalScrollCallback) {
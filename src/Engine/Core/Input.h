@@ -1,6 +1,7 @@
 #pragma once
 
 #include <GLFW/glfw3.h>
+#include <cstdint>
 #include <functional>
 #include <glm/glm.hpp>
 
@@ -29,6 +30,11 @@ public:
   static glm::vec2 getMouseDelta();
   static float getScrollDelta();
 
+  // Number of input callbacks received so far; changes whenever there was input
+  static uint64_t getEventCount() { return eventCount; }
+  // True while any key or mouse button is held down
+  static bool isAnyInputHeld();
+
   // Mouse capture (for FPS-style camera control)
   static void setMouseCaptured(bool captured);
   static bool isMouseCaptured();
@@ -64,6 +70,7 @@ private:
   static float scrollAccumulator;
   static bool firstMouse;
   static bool mouseCaptured;
+  static uint64_t eventCount;
 
   static std::function<void(float, float)> externalScrollCallback;
   static std::function<void(double, double)> externalMouseMoveCallback;
@@ -0,0 +1,296 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+namespace AhnrealEngine {
+
+    JobSystem* JobSystem::instance = nullptr;
+
+    // Deque owned by the current thread, or -1 for threads outside the pool
+    static thread_local int32_t currentQueueIndex = -1;
+
+    // Per-thread xorshift state for picking steal victims
+    static thread_local uint32_t stealSeed = 0;
+
+    static uint32_t nextRandom() {
+        uint32_t x = stealSeed ? stealSeed : 0x9E3779B9u ^ static_cast<uint32_t>(currentQueueIndex + 1);
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        stealSeed = x;
+        return x;
+    }
+
+    // ---------------------------------------------------------------- Deque
+
+    bool JobSystem::WorkStealingDeque::push(Job* job) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= CAPACITY) {
+            return false;
+        }
+        buffer[b & MASK].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job* JobSystem::WorkStealingDeque::pop() {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Empty
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = buffer[b & MASK].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last element: race thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* JobSystem::WorkStealingDeque::steal() {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b) {
+            return nullptr;
+        }
+
+        Job* job = buffer[t & MASK].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+    // ------------------------------------------------------------ JobSystem
+
+    JobSystem::JobSystem(uint32_t workerCount) : mainThreadId{std::this_thread::get_id()} {
+        if (workerCount == 0) {
+            uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+        }
+
+        queues.reserve(workerCount + 1);
+        for (uint32_t i = 0; i < workerCount + 1; i++) {
+            queues.push_back(std::make_unique<WorkStealingDeque>());
+        }
+
+        currentQueueIndex = 0;
+        instance = this;
+
+        workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++) {
+            workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        running.store(false);
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wakeCondition.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        // Jobs that never ran are dropped
+        for (auto& queue : queues) {
+            while (Job* job = queue->steal()) {
+                delete job;
+            }
+        }
+        for (Job* job : injectionQueue) {
+            delete job;
+        }
+
+        currentQueueIndex = -1;
+        if (instance == this) {
+            instance = nullptr;
+        }
+    }
+
+    void JobSystem::run(std::function<void()> function, JobCounter* counter) {
+        if (counter) {
+            counter->pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        schedule(new Job{std::move(function), counter});
+    }
+
+    void JobSystem::runAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter) {
+        if (counter) {
+            counter->pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        Job* job = new Job{std::move(function), counter};
+
+        {
+            std::lock_guard<std::mutex> lock(dependency.mutex);
+            if (!dependency.isDone()) {
+                dependency.continuations.push_back(job);
+                return;
+            }
+        }
+        schedule(job);
+    }
+
+    void JobSystem::parallelFor(uint32_t count, const RangeFunction& function, uint32_t minBatch) {
+        if (count == 0) return;
+
+        // About four batches per thread so stealing can even out uneven batches
+        uint32_t threadCount = getWorkerCount() + 1;
+        uint32_t batchSize = std::max(std::max(minBatch, 1u), (count + threadCount * 4 - 1) / (threadCount * 4));
+        if (batchSize >= count) {
+            function(0, count);
+            return;
+        }
+
+        JobCounter counter;
+        for (uint32_t begin = batchSize; begin < count; begin += batchSize) {
+            uint32_t end = std::min(begin + batchSize, count);
+            run([&function, begin, end]() { function(begin, end); }, &counter);
+        }
+        function(0, batchSize);
+        wait(counter);
+    }
+
+    void JobSystem::wait(JobCounter& counter) {
+        while (!counter.isDone()) {
+            if (Job* job = findJob()) {
+                execute(job);
+            } else if (isMainThread()) {
+                processMainThreadJobs();
+                std::this_thread::yield();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        // finish() may still hold the lock right after the final decrement
+        std::lock_guard<std::mutex> lock(counter.mutex);
+    }
+
+    void JobSystem::runOnMainThread(std::function<void()> function) {
+        {
+            std::lock_guard<std::mutex> lock(mainThreadMutex);
+            mainThreadJobs.push_back(std::move(function));
+        }
+        if (mainThreadWakeup) {
+            mainThreadWakeup();
+        }
+    }
+
+    void JobSystem::processMainThreadJobs() {
+        std::vector<std::function<void()>> jobs;
+        {
+            std::lock_guard<std::mutex> lock(mainThreadMutex);
+            jobs.swap(mainThreadJobs);
+        }
+        for (auto& job : jobs) {
+            job();
+        }
+    }
+
+    void JobSystem::workerLoop(uint32_t queueIndex) {
+        currentQueueIndex = static_cast<int32_t>(queueIndex);
+
+        while (running.load(std::memory_order_relaxed)) {
+            if (Job* job = findJob()) {
+                execute(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepingWorkers.fetch_add(1);
+            wakeCondition.wait(lock, [this]() {
+                return queuedJobs.load() > 0 || !running.load();
+            });
+            sleepingWorkers.fetch_sub(1);
+        }
+    }
+
+    void JobSystem::schedule(Job* job) {
+        // Counted before it becomes visible so a thief never sees the count underflow
+        queuedJobs.fetch_add(1);
+
+        bool queued = false;
+        if (currentQueueIndex >= 0) {
+            queued = queues[currentQueueIndex]->push(job);
+        }
+        if (!queued) {
+            std::lock_guard<std::mutex> lock(injectionMutex);
+            injectionQueue.push_back(job);
+            injectedJobs.fetch_add(1);
+        }
+
+        if (sleepingWorkers.load() > 0) {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+            }
+            wakeCondition.notify_one();
+        }
+    }
+
+    void JobSystem::execute(Job* job) {
+        job->function();
+        finish(job->counter);
+        delete job;
+    }
+
+    void JobSystem::finish(JobCounter* counter) {
+        if (!counter) return;
+
+        std::vector<Job*> ready;
+        {
+            std::lock_guard<std::mutex> lock(counter->mutex);
+            if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                ready.swap(counter->continuations);
+            }
+        }
+        for (Job* job : ready) {
+            schedule(job);
+        }
+    }
+
+    Job* JobSystem::findJob() {
+        Job* job = nullptr;
+
+        if (currentQueueIndex >= 0) {
+            job = queues[currentQueueIndex]->pop();
+        }
+
+        if (!job && injectedJobs.load() > 0) {
+            std::lock_guard<std::mutex> lock(injectionMutex);
+            if (!injectionQueue.empty()) {
+                job = injectionQueue.front();
+                injectionQueue.pop_front();
+                injectedJobs.fetch_sub(1);
+            }
+        }
+
+        if (!job) {
+            uint32_t queueCount = static_cast<uint32_t>(queues.size());
+            uint32_t start = nextRandom() % queueCount;
+            for (uint32_t i = 0; i < queueCount && !job; i++) {
+                uint32_t victim = (start + i) % queueCount;
+                if (static_cast<int32_t>(victim) == currentQueueIndex) continue;
+                job = queues[victim]->steal();
+            }
+        }
+
+        if (job) {
+            queuedJobs.fetch_sub(1);
+        }
+        return job;
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    class JobSystem;
+    struct Job;
+
+    // Counts unfinished jobs. Submitting a job with a counter increments it and
+    // the job's completion decrements it; JobSystem::wait() and runAfter()
+    // key off the counter reaching zero. Only destroy a counter after waiting on it.
+    class JobCounter {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<uint32_t> pending{0};
+        std::mutex mutex;                 // Guards continuations and the final decrement
+        std::vector<Job*> continuations;  // Jobs started by runAfter() once pending hits zero
+    };
+
+    struct Job {
+        std::function<void()> function;
+        JobCounter* counter = nullptr;
+    };
+
+    // Work-stealing task scheduler. Each worker thread owns a Chase-Lev deque:
+    // the owner pushes and pops at the bottom (LIFO, cache-warm), idle workers
+    // steal from the top. The main thread owns a deque too, so it can fan out
+    // work and help execute it while waiting instead of blocking.
+    //
+    // Threads outside the pool submit through a shared injection queue.
+    // Work that must run on the main thread (GLFW calls) goes through
+    // runOnMainThread() and is drained by the application once per frame.
+    class JobSystem {
+    public:
+        // Runs fn(begin, end) over [0, count)
+        using RangeFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+        // workerCount 0 picks one worker per hardware thread, minus the main thread
+        explicit JobSystem(uint32_t workerCount = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // The application's job system, or nullptr before it is created
+        static JobSystem* get() { return instance; }
+
+        void run(std::function<void()> function, JobCounter* counter = nullptr);
+
+        // Starts function once dependency reaches zero
+        void runAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter = nullptr);
+
+        // Splits [0, count) into batches of at least minBatch and waits for all
+        // of them. The calling thread executes batches as well.
+        void parallelFor(uint32_t count, const RangeFunction& function, uint32_t minBatch = 64);
+
+        // Executes other jobs until the counter reaches zero
+        void wait(JobCounter& counter);
+
+        // Queues function for the next processMainThreadJobs() call and wakes
+        // the main thread if it is blocked waiting for events
+        void runOnMainThread(std::function<void()> function);
+        void setMainThreadWakeup(std::function<void()> wakeup) { mainThreadWakeup = std::move(wakeup); }
+        void processMainThreadJobs();
+        bool isMainThread() const { return std::this_thread::get_id() == mainThreadId; }
+
+        uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+    private:
+        // Chase-Lev deque of fixed capacity. push()/pop() only from the owner.
+        class WorkStealingDeque {
+        public:
+            static constexpr int64_t CAPACITY = 4096;
+
+            bool push(Job* job);
+            Job* pop();
+            Job* steal();
+
+        private:
+            static constexpr int64_t MASK = CAPACITY - 1;
+
+            alignas(64) std::atomic<int64_t> top{0};
+            alignas(64) std::atomic<int64_t> bottom{0};
+            std::atomic<Job*> buffer[CAPACITY];
+        };
+
+        void workerLoop(uint32_t queueIndex);
+        void schedule(Job* job);
+        void execute(Job* job);
+        void finish(JobCounter* counter);
+        Job* findJob();
+
+        static JobSystem* instance;
+
+        // queues[0] belongs to the main thread, queues[i + 1] to workers[i]
+        std::vector<std::unique_ptr<WorkStealingDeque>> queues;
+        std::vector<std::thread> workers;
+        std::thread::id mainThreadId;
+
+        std::mutex injectionMutex;
+        std::deque<Job*> injectionQueue;
+        std::atomic<uint32_t> injectedJobs{0}; // Lets findJob() skip the lock when empty
+
+        std::mutex mainThreadMutex;
+        std::vector<std::function<void()>> mainThreadJobs;
+        std::function<void()> mainThreadWakeup;
+
+        // Idle workers sleep until queuedJobs is non-zero
+        std::atomic<uint32_t> queuedJobs{0};
+        std::atomic<uint32_t> sleepingWorkers{0};
+        std::mutex sleepMutex;
+        std::condition_variable wakeCondition;
+        std::atomic<bool> running{true};
+    };
+}
@@ -0,0 +1,391 @@
+#include "MathKernels.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AHNREAL_MATH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC compiles any intrinsic without per-function target flags
+#define AHNREAL_TARGET(isa)
+#else
+#define AHNREAL_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace AhnrealEngine {
+namespace MathKernels {
+
+    // --- Scalar ---
+
+    static void multiplyMatricesScalar(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            out[i] = a[i] * b[i];
+        }
+    }
+
+    static bool sphereInside(const glm::vec4* planes, float x, float y, float z, float radius) {
+        for (int p = 0; p < 6; p++) {
+            if (planes[p].x * x + planes[p].y * y + planes[p].z * z + planes[p].w < -radius) return false;
+        }
+        return true;
+    }
+
+    static bool boxInside(const glm::vec4* planes, float cx, float cy, float cz, float ex, float ey, float ez) {
+        for (int p = 0; p < 6; p++) {
+            // Distance of the center plus the box's reach along the normal
+            float distance = planes[p].x * cx + planes[p].y * cy + planes[p].z * cz + planes[p].w;
+            float reach = std::abs(planes[p].x) * ex + std::abs(planes[p].y) * ey + std::abs(planes[p].z) * ez;
+            if (distance + reach < 0.0f) return false;
+        }
+        return true;
+    }
+
+    static void testSpheresScalar(const glm::vec4* planes, const SphereStreams& s, uint32_t begin, uint32_t count, uint8_t* visible) {
+        for (uint32_t i = begin; i < count; i++) {
+            visible[i] = sphereInside(planes, s.x[i], s.y[i], s.z[i], s.radius[i]) ? 1 : 0;
+        }
+    }
+
+    static void testBoxesScalar(const glm::vec4* planes, const BoxStreams& b, uint32_t begin, uint32_t count, uint8_t* visible) {
+        for (uint32_t i = begin; i < count; i++) {
+            visible[i] = boxInside(planes, b.centerX[i], b.centerY[i], b.centerZ[i], b.extentX[i], b.extentY[i], b.extentZ[i]) ? 1 : 0;
+        }
+    }
+
+    static void composeTransformsScalar(const TransformStreams& t, uint32_t begin, uint32_t count, glm::mat4* out) {
+        for (uint32_t i = begin; i < count; i++) {
+            float x = t.rotationX[i], y = t.rotationY[i], z = t.rotationZ[i], w = t.rotationW[i];
+            float s = t.scale[i];
+            glm::mat4& m = out[i];
+            m[0] = glm::vec4((1.0f - 2.0f * (y * y + z * z)) * s, 2.0f * (x * y + w * z) * s, 2.0f * (x * z - w * y) * s, 0.0f);
+            m[1] = glm::vec4(2.0f * (x * y - w * z) * s, (1.0f - 2.0f * (x * x + z * z)) * s, 2.0f * (y * z + w * x) * s, 0.0f);
+            m[2] = glm::vec4(2.0f * (x * z + w * y) * s, 2.0f * (y * z - w * x) * s, (1.0f - 2.0f * (x * x + y * y)) * s, 0.0f);
+            m[3] = glm::vec4(t.positionX[i], t.positionY[i], t.positionZ[i], 1.0f);
+        }
+    }
+
+    static void testSpheresScalarAll(const glm::vec4* planes, const SphereStreams& s, uint32_t count, uint8_t* visible) {
+        testSpheresScalar(planes, s, 0, count, visible);
+    }
+
+    static void testBoxesScalarAll(const glm::vec4* planes, const BoxStreams& b, uint32_t count, uint8_t* visible) {
+        testBoxesScalar(planes, b, 0, count, visible);
+    }
+
+    static void composeTransformsScalarAll(const TransformStreams& t, uint32_t count, glm::mat4* out) {
+        composeTransformsScalar(t, 0, count, out);
+    }
+
+#ifdef AHNREAL_MATH_X86
+    static inline void storeMask4(int mask, uint8_t* visible) {
+        visible[0] = static_cast<uint8_t>(mask & 1);
+        visible[1] = static_cast<uint8_t>((mask >> 1) & 1);
+        visible[2] = static_cast<uint8_t>((mask >> 2) & 1);
+        visible[3] = static_cast<uint8_t>((mask >> 3) & 1);
+    }
+
+    // Writes column `column` of four consecutive matrices from per-component lanes
+    static inline void storeColumn4(glm::mat4* out, int column, __m128 x, __m128 y, __m128 z, __m128 w) {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&out[0][column][0], x);
+        _mm_storeu_ps(&out[1][column][0], y);
+        _mm_storeu_ps(&out[2][column][0], z);
+        _mm_storeu_ps(&out[3][column][0], w);
+    }
+
+    // --- SSE4.1 ---
+
+    AHNREAL_TARGET("sse4.1")
+    static void multiplyMatricesSSE4(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            const __m128 a0 = _mm_loadu_ps(&a[i][0][0]);
+            const __m128 a1 = _mm_loadu_ps(&a[i][1][0]);
+            const __m128 a2 = _mm_loadu_ps(&a[i][2][0]);
+            const __m128 a3 = _mm_loadu_ps(&a[i][3][0]);
+            for (int column = 0; column < 4; column++) {
+                // Column j of the result is a linear combination of a's columns
+                __m128 bColumn = _mm_loadu_ps(&b[i][column][0]);
+                __m128 result = _mm_mul_ps(a0, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(0, 0, 0, 0)));
+                result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(1, 1, 1, 1))));
+                result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(2, 2, 2, 2))));
+                result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(3, 3, 3, 3))));
+                _mm_storeu_ps(&out[i][column][0], result);
+            }
+        }
+    }
+
+    AHNREAL_TARGET("sse4.1")
+    static void testSpheresSSE4(const glm::vec4* planes, const SphereStreams& s, uint32_t count, uint8_t* visible) {
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = _mm_loadu_ps(s.x + i);
+            __m128 y = _mm_loadu_ps(s.y + i);
+            __m128 z = _mm_loadu_ps(s.z + i);
+            __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(s.radius + i));
+
+            __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps()); // All bits set
+            for (int p = 0; p < 6; p++) {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].x), x), _mm_set1_ps(planes[p].w));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes[p].y), y));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes[p].z), z));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+            }
+            storeMask4(_mm_movemask_ps(inside), visible + i);
+        }
+        testSpheresScalar(planes, s, i, count, visible);
+    }
+
+    AHNREAL_TARGET("sse4.1")
+    static void testBoxesSSE4(const glm::vec4* planes, const BoxStreams& b, uint32_t count, uint8_t* visible) {
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 cx = _mm_loadu_ps(b.centerX + i), cy = _mm_loadu_ps(b.centerY + i), cz = _mm_loadu_ps(b.centerZ + i);
+            __m128 ex = _mm_loadu_ps(b.extentX + i), ey = _mm_loadu_ps(b.extentY + i), ez = _mm_loadu_ps(b.extentZ + i);
+
+            __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps());
+            for (int p = 0; p < 6; p++) {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].x), cx), _mm_set1_ps(planes[p].w));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes[p].y), cy));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes[p].z), cz));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(std::abs(planes[p].x)), ex));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(std::abs(planes[p].y)), ey));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(std::abs(planes[p].z)), ez));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+            }
+            storeMask4(_mm_movemask_ps(inside), visible + i);
+        }
+        testBoxesScalar(planes, b, i, count, visible);
+    }
+
+    AHNREAL_TARGET("sse4.1")
+    static void composeTransformsSSE4(const TransformStreams& t, uint32_t count, glm::mat4* out) {
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 zero = _mm_setzero_ps();
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = _mm_loadu_ps(t.rotationX + i), y = _mm_loadu_ps(t.rotationY + i);
+            __m128 z = _mm_loadu_ps(t.rotationZ + i), w = _mm_loadu_ps(t.rotationW + i);
+            __m128 s = _mm_loadu_ps(t.scale + i);
+            __m128 s2 = _mm_mul_ps(two, s);
+
+            __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+            __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+            __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+            storeColumn4(out + i, 0,
+                _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), s),
+                _mm_mul_ps(_mm_add_ps(xy, wz), s2),
+                _mm_mul_ps(_mm_sub_ps(xz, wy), s2), zero);
+            storeColumn4(out + i, 1,
+                _mm_mul_ps(_mm_sub_ps(xy, wz), s2),
+                _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), s),
+                _mm_mul_ps(_mm_add_ps(yz, wx), s2), zero);
+            storeColumn4(out + i, 2,
+                _mm_mul_ps(_mm_add_ps(xz, wy), s2),
+                _mm_mul_ps(_mm_sub_ps(yz, wx), s2),
+                _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), s), zero);
+            storeColumn4(out + i, 3,
+                _mm_loadu_ps(t.positionX + i), _mm_loadu_ps(t.positionY + i), _mm_loadu_ps(t.positionZ + i), one);
+        }
+        composeTransformsScalar(t, i, count, out);
+    }
+
+    // --- AVX2 + FMA ---
+
+    AHNREAL_TARGET("avx2,fma")
+    static void multiplyMatricesAVX2(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            // a's columns in both 128-bit lanes, so two result columns are
+            // computed per step
+            const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][0][0]));
+            const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][1][0]));
+            const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][2][0]));
+            const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][3][0]));
+            for (int column = 0; column < 4; column += 2) {
+                __m256 bColumns = _mm256_loadu_ps(&b[i][column][0]);
+                __m256 result = _mm256_mul_ps(a0, _mm256_shuffle_ps(bColumns, bColumns, _MM_SHUFFLE(0, 0, 0, 0)));
+                result = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(bColumns, bColumns, _MM_SHUFFLE(1, 1, 1, 1)), result);
+                result = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(bColumns, bColumns, _MM_SHUFFLE(2, 2, 2, 2)), result);
+                result = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(bColumns, bColumns, _MM_SHUFFLE(3, 3, 3, 3)), result);
+                _mm256_storeu_ps(&out[i][column][0], result);
+            }
+        }
+    }
+
+    AHNREAL_TARGET("avx2,fma")
+    static void testSpheresAVX2(const glm::vec4* planes, const SphereStreams& s, uint32_t count, uint8_t* visible) {
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256 x = _mm256_loadu_ps(s.x + i);
+            __m256 y = _mm256_loadu_ps(s.y + i);
+            __m256 z = _mm256_loadu_ps(s.z + i);
+            __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(s.radius + i));
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (int p = 0; p < 6; p++) {
+                __m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[p].x), x, _mm256_set1_ps(planes[p].w));
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[p].y), y, distance);
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[p].z), z, distance);
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+            }
+            int mask = _mm256_movemask_ps(inside);
+            storeMask4(mask, visible + i);
+            storeMask4(mask >> 4, visible + i + 4);
+        }
+        testSpheresScalar(planes, s, i, count, visible);
+    }
+
+    AHNREAL_TARGET("avx2,fma")
+    static void testBoxesAVX2(const glm::vec4* planes, const BoxStreams& b, uint32_t count, uint8_t* visible) {
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256 cx = _mm256_loadu_ps(b.centerX + i), cy = _mm256_loadu_ps(b.centerY + i), cz = _mm256_loadu_ps(b.centerZ + i);
+            __m256 ex = _mm256_loadu_ps(b.extentX + i), ey = _mm256_loadu_ps(b.extentY + i), ez = _mm256_loadu_ps(b.extentZ + i);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (int p = 0; p < 6; p++) {
+                __m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[p].x), cx, _mm256_set1_ps(planes[p].w));
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[p].y), cy, distance);
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[p].z), cz, distance);
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(std::abs(planes[p].x)), ex, distance);
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(std::abs(planes[p].y)), ey, distance);
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(std::abs(planes[p].z)), ez, distance);
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+            int mask = _mm256_movemask_ps(inside);
+            storeMask4(mask, visible + i);
+            storeMask4(mask >> 4, visible + i + 4);
+        }
+        testBoxesScalar(planes, b, i, count, visible);
+    }
+
+    AHNREAL_TARGET("avx2,fma")
+    static void composeTransformsAVX2(const TransformStreams& t, uint32_t count, glm::mat4* out) {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256 x = _mm256_loadu_ps(t.rotationX + i), y = _mm256_loadu_ps(t.rotationY + i);
+            __m256 z = _mm256_loadu_ps(t.rotationZ + i), w = _mm256_loadu_ps(t.rotationW + i);
+            __m256 s = _mm256_loadu_ps(t.scale + i);
+            __m256 s2 = _mm256_mul_ps(two, s);
+
+            __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+            __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+            __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+            // Rotation-scale entries for eight instances, then written as two
+            // groups of four matrices
+            __m256 columns[4][4] = {
+                { _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), s),
+                  _mm256_mul_ps(_mm256_add_ps(xy, wz), s2),
+                  _mm256_mul_ps(_mm256_sub_ps(xz, wy), s2), _mm256_setzero_ps() },
+                { _mm256_mul_ps(_mm256_sub_ps(xy, wz), s2),
+                  _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), s),
+                  _mm256_mul_ps(_mm256_add_ps(yz, wx), s2), _mm256_setzero_ps() },
+                { _mm256_mul_ps(_mm256_add_ps(xz, wy), s2),
+                  _mm256_mul_ps(_mm256_sub_ps(yz, wx), s2),
+                  _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), s), _mm256_setzero_ps() },
+                { _mm256_loadu_ps(t.positionX + i), _mm256_loadu_ps(t.positionY + i), _mm256_loadu_ps(t.positionZ + i), one }
+            };
+            for (int column = 0; column < 4; column++) {
+                storeColumn4(out + i, column,
+                    _mm256_castps256_ps128(columns[column][0]), _mm256_castps256_ps128(columns[column][1]),
+                    _mm256_castps256_ps128(columns[column][2]), _mm256_castps256_ps128(columns[column][3]));
+                storeColumn4(out + i + 4, column,
+                    _mm256_extractf128_ps(columns[column][0], 1), _mm256_extractf128_ps(columns[column][1], 1),
+                    _mm256_extractf128_ps(columns[column][2], 1), _mm256_extractf128_ps(columns[column][3], 1));
+            }
+        }
+        composeTransformsScalar(t, i, count, out);
+    }
+#endif
+
+    // --- Dispatch ---
+
+    struct KernelTable {
+        void (*multiplyMatrices)(const glm::mat4*, const glm::mat4*, glm::mat4*, uint32_t);
+        void (*testSpheres)(const glm::vec4*, const SphereStreams&, uint32_t, uint8_t*);
+        void (*testBoxes)(const glm::vec4*, const BoxStreams&, uint32_t, uint8_t*);
+        void (*composeTransforms)(const TransformStreams&, uint32_t, glm::mat4*);
+    };
+
+    static KernelTable tableFor(SimdLevel level) {
+#ifdef AHNREAL_MATH_X86
+        if (level == SimdLevel::AVX2) {
+            return { multiplyMatricesAVX2, testSpheresAVX2, testBoxesAVX2, composeTransformsAVX2 };
+        }
+        if (level == SimdLevel::SSE4) {
+            return { multiplyMatricesSSE4, testSpheresSSE4, testBoxesSSE4, composeTransformsSSE4 };
+        }
+#endif
+        (void)level;
+        return { multiplyMatricesScalar, testSpheresScalarAll, testBoxesScalarAll, composeTransformsScalarAll };
+    }
+
+    SimdLevel detectSimdLevel() {
+#if defined(AHNREAL_MATH_X86) && defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        bool sse41 = (info[2] & (1 << 19)) != 0;
+        bool fma = (info[2] & (1 << 12)) != 0;
+        // AVX state must also be enabled by the OS (OSXSAVE + XCR0)
+        bool avx = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0;
+        if (avx && avx2 && fma) return SimdLevel::AVX2;
+        if (sse41) return SimdLevel::SSE4;
+#elif defined(AHNREAL_MATH_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.1")) return SimdLevel::SSE4;
+#endif
+        return SimdLevel::Scalar;
+    }
+
+    static SimdLevel& currentLevel() {
+        static SimdLevel level = detectSimdLevel();
+        return level;
+    }
+
+    static KernelTable& currentTable() {
+        static KernelTable table = tableFor(currentLevel());
+        return table;
+    }
+
+    SimdLevel getSimdLevel() {
+        return currentLevel();
+    }
+
+    void setSimdLevel(SimdLevel level) {
+        currentLevel() = std::min(level, detectSimdLevel());
+        currentTable() = tableFor(currentLevel());
+    }
+
+    const char* getSimdLevelName(SimdLevel level) {
+        switch (level) {
+            case SimdLevel::AVX2: return "AVX2";
+            case SimdLevel::SSE4: return "SSE4.1";
+            default: return "Scalar";
+        }
+    }
+
+    void multiplyMatrices(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, uint32_t count) {
+        currentTable().multiplyMatrices(a, b, out, count);
+    }
+
+    void testSpheres(const glm::vec4* planes, const SphereStreams& spheres, uint32_t count, uint8_t* visible) {
+        currentTable().testSpheres(planes, spheres, count, visible);
+    }
+
+    void testBoxes(const glm::vec4* planes, const BoxStreams& boxes, uint32_t count, uint8_t* visible) {
+        currentTable().testBoxes(planes, boxes, count, visible);
+    }
+
+    void composeTransforms(const TransformStreams& transforms, uint32_t count, glm::mat4* out) {
+        currentTable().composeTransforms(transforms, count, out);
+    }
+}
+}
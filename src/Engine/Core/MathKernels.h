@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+namespace AhnrealEngine {
+
+    // Batch math over structure-of-arrays inputs. Each kernel has a scalar,
+    // SSE4.1 and AVX2 (+FMA) version; the widest one the CPU supports is
+    // picked at startup and can be lowered with setSimdLevel, e.g. to compare
+    // them. Inputs need no particular alignment.
+    namespace MathKernels {
+
+        enum class SimdLevel { Scalar, SSE4, AVX2 };
+
+        SimdLevel detectSimdLevel();
+        SimdLevel getSimdLevel();
+        // Clamped to what detectSimdLevel reports
+        void setSimdLevel(SimdLevel level);
+        const char* getSimdLevelName(SimdLevel level);
+
+        // Bounding spheres, one stream per component
+        struct SphereStreams {
+            const float* x;
+            const float* y;
+            const float* z;
+            const float* radius;
+        };
+
+        // Axis-aligned boxes as center and half extent
+        struct BoxStreams {
+            const float* centerX;
+            const float* centerY;
+            const float* centerZ;
+            const float* extentX;
+            const float* extentY;
+            const float* extentZ;
+        };
+
+        // Translation, rotation quaternion and uniform scale (InstanceTransform)
+        struct TransformStreams {
+            const float* positionX;
+            const float* positionY;
+            const float* positionZ;
+            const float* rotationX;
+            const float* rotationY;
+            const float* rotationZ;
+            const float* rotationW;
+            const float* scale;
+        };
+
+        // out[i] = a[i] * b[i]. out may not alias a or b.
+        void multiplyMatrices(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, uint32_t count);
+
+        // visible[i] = 1 if the sphere or box is on the inner side of all six
+        // planes (Frustum::planes), else 0
+        void testSpheres(const glm::vec4* planes, const SphereStreams& spheres, uint32_t count, uint8_t* visible);
+        void testBoxes(const glm::vec4* planes, const BoxStreams& boxes, uint32_t count, uint8_t* visible);
+
+        // out[i] = translate * rotate * scale, the same matrix as the glm
+        // translate/mat4_cast/scale chain. Quaternions must be normalized.
+        void composeTransforms(const TransformStreams& transforms, uint32_t count, glm::mat4* out);
+    }
+}
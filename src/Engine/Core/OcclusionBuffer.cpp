@@ -0,0 +1,269 @@
+#include "OcclusionBuffer.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define AHNREAL_OCCLUSION_SSE 1
+#endif
+
+namespace AhnrealEngine {
+
+    // Vertices closer than this (clip w) reject their triangle or box; an
+    // occluder that reaches the camera is simply not used this frame
+    static constexpr float MIN_CLIP_W = 1e-3f;
+    static constexpr float CLEAR_DEPTH = std::numeric_limits<float>::max();
+
+    OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height) : width(width), height(height) {
+        if (width == 0 || height == 0 || width % 4 != 0) {
+            throw std::runtime_error("occlusion buffer width must be a non-zero multiple of 4!");
+        }
+
+        uint32_t levelWidth = width;
+        uint32_t levelHeight = height;
+        while (true) {
+            levels.push_back({levelWidth, levelHeight, std::vector<float>(levelWidth * levelHeight, CLEAR_DEPTH)});
+            if (levelWidth == 1 && levelHeight == 1) break;
+            levelWidth = std::max(1u, (levelWidth + 1) / 2);
+            levelHeight = std::max(1u, (levelHeight + 1) / 2);
+        }
+    }
+
+    void OcclusionBuffer::begin(const glm::mat4& viewProj) {
+        this->viewProj = viewProj;
+        occluders.clear();
+        occluderTriangleCount = 0;
+        rasterizedTriangleCount = 0;
+        for (Level& level : levels) {
+            std::fill(level.depth.begin(), level.depth.end(), CLEAR_DEPTH);
+        }
+    }
+
+    void OcclusionBuffer::addOccluder(const glm::vec3* positions, const uint32_t* indices, uint32_t indexCount,
+                                      const glm::mat4& world) {
+        uint32_t triangleCount = indexCount / 3;
+        if (triangleCount == 0) return;
+        occluders.push_back({positions, indices, triangleCount, occluderTriangleCount, viewProj * world});
+        occluderTriangleCount += triangleCount;
+    }
+
+    void OcclusionBuffer::rasterize() {
+        triangles.resize(occluderTriangleCount);
+        if (occluderTriangleCount == 0) return;
+
+        // Each occluder writes its own range of triangles, and each band its
+        // own rows of the depth buffer
+        const uint32_t occluderCount = static_cast<uint32_t>(occluders.size());
+        const uint32_t bandCount = (height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+        if (JobSystem* jobs = JobSystem::get()) {
+            jobs->parallelFor(occluderCount, [this](uint32_t begin, uint32_t end) {
+                setupTriangles(begin, end);
+            }, 4);
+            jobs->parallelFor(bandCount, [this](uint32_t begin, uint32_t end) {
+                for (uint32_t band = begin; band < end; band++) rasterizeBand(band);
+            }, 1);
+        } else {
+            setupTriangles(0, occluderCount);
+            for (uint32_t band = 0; band < bandCount; band++) rasterizeBand(band);
+        }
+
+        rasterizedTriangleCount = static_cast<uint32_t>(std::count_if(triangles.begin(), triangles.end(),
+            [](const ScreenTriangle& triangle) { return triangle.valid; }));
+
+        buildHierarchy();
+    }
+
+    void OcclusionBuffer::setupTriangles(uint32_t firstOccluder, uint32_t lastOccluder) {
+        const float halfWidth = 0.5f * static_cast<float>(width);
+        const float halfHeight = 0.5f * static_cast<float>(height);
+
+        for (uint32_t o = firstOccluder; o < lastOccluder; o++) {
+            const Occluder& occluder = occluders[o];
+            for (uint32_t t = 0; t < occluder.triangleCount; t++) {
+                ScreenTriangle& triangle = triangles[occluder.firstTriangle + t];
+                triangle.valid = false;
+
+                bool behind = false;
+                for (int v = 0; v < 3; v++) {
+                    glm::vec4 clip = occluder.transform * glm::vec4(occluder.positions[occluder.indices[t * 3 + v]], 1.0f);
+                    if (clip.w < MIN_CLIP_W) {
+                        behind = true;
+                        break;
+                    }
+                    float invW = 1.0f / clip.w;
+                    triangle.x[v] = (clip.x * invW + 1.0f) * halfWidth;
+                    triangle.y[v] = (clip.y * invW + 1.0f) * halfHeight;
+                    triangle.z[v] = clip.z * invW;
+                }
+                if (behind) continue;
+
+                float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) -
+                             (triangle.y[1] - triangle.y[0]) * (triangle.x[2] - triangle.x[0]);
+                if (area == 0.0f) continue;
+                if (area < 0.0f) {
+                    // Both windings occlude; edge tests expect positive area
+                    std::swap(triangle.x[1], triangle.x[2]);
+                    std::swap(triangle.y[1], triangle.y[2]);
+                    std::swap(triangle.z[1], triangle.z[2]);
+                }
+
+                float minX = std::min({triangle.x[0], triangle.x[1], triangle.x[2]});
+                float maxX = std::max({triangle.x[0], triangle.x[1], triangle.x[2]});
+                triangle.minY = std::min({triangle.y[0], triangle.y[1], triangle.y[2]});
+                triangle.maxY = std::max({triangle.y[0], triangle.y[1], triangle.y[2]});
+                if (maxX < 0.0f || minX > static_cast<float>(width) ||
+                    triangle.maxY < 0.0f || triangle.minY > static_cast<float>(height)) {
+                    continue;
+                }
+                triangle.valid = true;
+            }
+        }
+    }
+
+    void OcclusionBuffer::rasterizeBand(uint32_t band) {
+        const uint32_t rowBegin = band * BAND_HEIGHT;
+        const uint32_t rowEnd = std::min(rowBegin + BAND_HEIGHT, height);
+        const float bandTop = static_cast<float>(rowBegin);
+        const float bandBottom = static_cast<float>(rowEnd);
+
+        for (const ScreenTriangle& triangle : triangles) {
+            if (!triangle.valid || triangle.maxY < bandTop || triangle.minY > bandBottom) continue;
+            rasterizeTriangle(triangle, rowBegin, rowEnd);
+        }
+    }
+
+    void OcclusionBuffer::rasterizeTriangle(const ScreenTriangle& triangle, uint32_t rowBegin, uint32_t rowEnd) {
+        // Edge i is opposite vertex i: e(p) = a * px + b * py + c, >= 0 inside
+        float a[3], b[3], c[3];
+        for (int i = 0; i < 3; i++) {
+            int v0 = (i + 1) % 3;
+            int v1 = (i + 2) % 3;
+            a[i] = triangle.y[v0] - triangle.y[v1];
+            b[i] = triangle.x[v1] - triangle.x[v0];
+            c[i] = -(a[i] * triangle.x[v0] + b[i] * triangle.y[v0]);
+        }
+
+        // Depth is affine in screen space: z = zc + dzdx * px + dzdy * py
+        float area = a[0] * triangle.x[0] + b[0] * triangle.y[0] + c[0];
+        float invArea = 1.0f / area;
+        float dzdx = (a[0] * triangle.z[0] + a[1] * triangle.z[1] + a[2] * triangle.z[2]) * invArea;
+        float dzdy = (b[0] * triangle.z[0] + b[1] * triangle.z[1] + b[2] * triangle.z[2]) * invArea;
+        float zc = (c[0] * triangle.z[0] + c[1] * triangle.z[1] + c[2] * triangle.z[2]) * invArea;
+
+        // Pixels whose centers can fall inside; columns start on a 4-pixel boundary
+        float minX = std::min({triangle.x[0], triangle.x[1], triangle.x[2]});
+        float maxX = std::max({triangle.x[0], triangle.x[1], triangle.x[2]});
+        uint32_t columnBegin = static_cast<uint32_t>(std::max(0.0f, std::floor(minX - 0.5f))) & ~3u;
+        uint32_t columnEnd = static_cast<uint32_t>(std::min(static_cast<float>(width), std::ceil(maxX + 0.5f)));
+        uint32_t firstRow = std::max(rowBegin, static_cast<uint32_t>(std::max(0.0f, std::floor(triangle.minY - 0.5f))));
+        uint32_t lastRow = std::min(rowEnd, static_cast<uint32_t>(std::max(0.0f, std::ceil(triangle.maxY + 0.5f))));
+        if (columnBegin >= columnEnd) return;
+
+        float* depth = levels[0].depth.data();
+        const float startX = static_cast<float>(columnBegin) + 0.5f;
+
+        for (uint32_t row = firstRow; row < lastRow; row++) {
+            const float py = static_cast<float>(row) + 0.5f;
+            float* rowDepth = depth + row * width;
+            uint32_t x = columnBegin;
+#ifdef AHNREAL_OCCLUSION_SSE
+            const __m128 offsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+            const __m128 zero = _mm_setzero_ps();
+            __m128 e0 = _mm_add_ps(_mm_set1_ps(a[0] * startX + b[0] * py + c[0]), _mm_mul_ps(_mm_set1_ps(a[0]), offsets));
+            __m128 e1 = _mm_add_ps(_mm_set1_ps(a[1] * startX + b[1] * py + c[1]), _mm_mul_ps(_mm_set1_ps(a[1]), offsets));
+            __m128 e2 = _mm_add_ps(_mm_set1_ps(a[2] * startX + b[2] * py + c[2]), _mm_mul_ps(_mm_set1_ps(a[2]), offsets));
+            __m128 z = _mm_add_ps(_mm_set1_ps(zc + dzdx * startX + dzdy * py), _mm_mul_ps(_mm_set1_ps(dzdx), offsets));
+            const __m128 stepE0 = _mm_set1_ps(4.0f * a[0]);
+            const __m128 stepE1 = _mm_set1_ps(4.0f * a[1]);
+            const __m128 stepE2 = _mm_set1_ps(4.0f * a[2]);
+            const __m128 stepZ = _mm_set1_ps(4.0f * dzdx);
+
+            for (; x < columnEnd; x += 4) {
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside) != 0) {
+                    __m128 current = _mm_loadu_ps(rowDepth + x);
+                    __m128 nearest = _mm_min_ps(current, z);
+                    _mm_storeu_ps(rowDepth + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+                }
+                e0 = _mm_add_ps(e0, stepE0);
+                e1 = _mm_add_ps(e1, stepE1);
+                e2 = _mm_add_ps(e2, stepE2);
+                z = _mm_add_ps(z, stepZ);
+            }
+#endif
+            for (; x < columnEnd; x++) {
+                float px = static_cast<float>(x) + 0.5f;
+                if (a[0] * px + b[0] * py + c[0] >= 0.0f &&
+                    a[1] * px + b[1] * py + c[1] >= 0.0f &&
+                    a[2] * px + b[2] * py + c[2] >= 0.0f) {
+                    rowDepth[x] = std::min(rowDepth[x], zc + dzdx * px + dzdy * py);
+                }
+            }
+        }
+    }
+
+    void OcclusionBuffer::buildHierarchy() {
+        for (size_t l = 1; l < levels.size(); l++) {
+            const Level& source = levels[l - 1];
+            Level& target = levels[l];
+            for (uint32_t y = 0; y < target.height; y++) {
+                // Odd sizes repeat the last row or column
+                uint32_t y0 = std::min(y * 2, source.height - 1);
+                uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+                for (uint32_t x = 0; x < target.width; x++) {
+                    uint32_t x0 = std::min(x * 2, source.width - 1);
+                    uint32_t x1 = std::min(x * 2 + 1, source.width - 1);
+                    target.depth[y * target.width + x] = std::max(
+                        std::max(source.depth[y0 * source.width + x0], source.depth[y0 * source.width + x1]),
+                        std::max(source.depth[y1 * source.width + x0], source.depth[y1 * source.width + x1]));
+                }
+            }
+        }
+    }
+
+    bool OcclusionBuffer::isOccluded(const glm::vec3& min, const glm::vec3& max) const {
+        float minX = std::numeric_limits<float>::max(), maxX = -minX;
+        float minY = minX, maxY = -minX;
+        float nearestZ = minX;
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec4 clip = viewProj * glm::vec4(corner & 1 ? max.x : min.x,
+                                                  corner & 2 ? max.y : min.y,
+                                                  corner & 4 ? max.z : min.z, 1.0f);
+            if (clip.w < MIN_CLIP_W) return false;
+            float invW = 1.0f / clip.w;
+            float x = (clip.x * invW + 1.0f) * 0.5f * static_cast<float>(width);
+            float y = (clip.y * invW + 1.0f) * 0.5f * static_cast<float>(height);
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            nearestZ = std::min(nearestZ, clip.z * invW);
+        }
+        if (maxX < 0.0f || minX >= static_cast<float>(width) || maxY < 0.0f || minY >= static_cast<float>(height)) {
+            return false;
+        }
+
+        // Pixels touched by the screen rectangle
+        uint32_t x0 = static_cast<uint32_t>(std::max(0.0f, minX));
+        uint32_t y0 = static_cast<uint32_t>(std::max(0.0f, minY));
+        uint32_t x1 = std::min(static_cast<uint32_t>(maxX), width - 1);
+        uint32_t y1 = std::min(static_cast<uint32_t>(maxY), height - 1);
+
+        // Coarsest level where the rectangle spans at most 2x2 texels
+        uint32_t l = 0;
+        while (l + 1 < levels.size() && ((x1 >> l) - (x0 >> l) > 1 || (y1 >> l) - (y0 >> l) > 1)) {
+            l++;
+        }
+
+        const Level& level = levels[l];
+        for (uint32_t y = y0 >> l; y <= (y1 >> l); y++) {
+            for (uint32_t x = x0 >> l; x <= (x1 >> l); x++) {
+                if (level.depth[y * level.width + x] >= nearestZ) return false;
+            }
+        }
+        return true;
+    }
+}
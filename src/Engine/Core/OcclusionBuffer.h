@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    // Low-resolution software depth buffer for CPU occlusion culling.
+    // Each frame, a few large occluders are rasterized on the CPU and object
+    // bounds are tested against a max-depth hierarchy built from the result,
+    // so hidden objects are skipped before any draw is recorded and nothing
+    // is read back from the GPU.
+    //
+    //   begin(viewProj)  clear, set the camera
+    //   addOccluder(...) queue occluder triangles (no work yet)
+    //   rasterize()      transform and rasterize on the job system, build mips
+    //   isOccluded(box)  any number of tests, from any thread
+    //
+    // Depth is NDC z / w, which only needs to grow with distance, so both
+    // OpenGL and Vulkan depth ranges work. Pixels are sampled at their
+    // centers, so thin occluder edges can hide slightly more than they cover.
+    class OcclusionBuffer {
+    public:
+        // width must be a multiple of 4 (one SSE row step)
+        explicit OcclusionBuffer(uint32_t width = 256, uint32_t height = 128);
+
+        void begin(const glm::mat4& viewProj);
+
+        // Object-space positions and a triangle list; both must stay valid
+        // until rasterize() returns
+        void addOccluder(const glm::vec3* positions, const uint32_t* indices, uint32_t indexCount,
+                         const glm::mat4& world);
+
+        void rasterize();
+
+        // True if the world-space box lies entirely behind rasterized
+        // occluders. Boxes crossing the near plane or leaving the screen are
+        // never occluded.
+        bool isOccluded(const glm::vec3& min, const glm::vec3& max) const;
+
+        uint32_t getWidth() const { return width; }
+        uint32_t getHeight() const { return height; }
+        // Triangles queued since begin(), and those left after near-plane,
+        // off-screen and zero-area rejection
+        uint32_t getOccluderTriangleCount() const { return occluderTriangleCount; }
+        uint32_t getRasterizedTriangleCount() const { return rasterizedTriangleCount; }
+
+    private:
+        struct Occluder {
+            const glm::vec3* positions;
+            const uint32_t* indices;
+            uint32_t triangleCount;
+            uint32_t firstTriangle; // Into triangles
+            glm::mat4 transform;    // viewProj * world
+        };
+
+        // Screen-space triangle with counter-clockwise winding (positive
+        // area); valid == false for rejected triangles
+        struct ScreenTriangle {
+            float x[3];
+            float y[3];
+            float z[3];
+            float minY, maxY;
+            bool valid;
+        };
+
+        void setupTriangles(uint32_t firstOccluder, uint32_t lastOccluder);
+        void rasterizeBand(uint32_t band);
+        void rasterizeTriangle(const ScreenTriangle& triangle, uint32_t rowBegin, uint32_t rowEnd);
+        void buildHierarchy();
+
+        // Rows per job in rasterize(); bands never share pixels, so no locking
+        static constexpr uint32_t BAND_HEIGHT = 8;
+
+        uint32_t width;
+        uint32_t height;
+        glm::mat4 viewProj{1.0f};
+
+        std::vector<Occluder> occluders;
+        std::vector<ScreenTriangle> triangles;
+        uint32_t occluderTriangleCount = 0;
+        uint32_t rasterizedTriangleCount = 0;
+
+        // levels[0] is the full-resolution depth; each next level holds the
+        // farthest depth of a 2x2 block of the previous one, down to 1x1
+        struct Level {
+            uint32_t width;
+            uint32_t height;
+            std::vector<float> depth;
+        };
+        std::vector<Level> levels;
+    };
+}
@@ -0,0 +1,55 @@
+#include "SimulationClock.h"
+#include <algorithm>
+#include <cmath>
+
+namespace AhnrealEngine {
+
+    void SimulationClock::setFixedStep(bool enabled) {
+        if (fixedStep != enabled) {
+            fixedStep = enabled;
+            reset();
+        }
+    }
+
+    void SimulationClock::setTickRate(float ticksPerSecond) {
+        tickRate = std::clamp(ticksPerSecond, 1.0f, 1000.0f);
+        stepTime = 1.0f / tickRate;
+    }
+
+    uint32_t SimulationClock::advance(float frameTime, bool fixedAllowed) {
+        frameTime = std::max(frameTime, 0.0f);
+        if (frameTime > maxFrameTime) {
+            droppedTime += frameTime - maxFrameTime;
+            frameTime = maxFrameTime;
+        }
+
+        if (!fixedStep || !fixedAllowed) {
+            deltaTime = frameTime;
+            alpha = 1.0f;
+            totalSteps++;
+            return 1;
+        }
+
+        accumulator += frameTime;
+        uint32_t steps = static_cast<uint32_t>(accumulator / stepTime);
+        if (steps > maxStepsPerFrame) {
+            // Keep only the partial step so interpolation stays continuous
+            steps = maxStepsPerFrame;
+            double partial = std::fmod(accumulator, static_cast<double>(stepTime));
+            double kept = steps * static_cast<double>(stepTime) + partial;
+            droppedTime += static_cast<float>(accumulator - kept);
+            accumulator = kept;
+        }
+        accumulator -= steps * static_cast<double>(stepTime);
+
+        deltaTime = stepTime;
+        alpha = static_cast<float>(std::min(accumulator / stepTime, 1.0));
+        totalSteps += steps;
+        return steps;
+    }
+
+    void SimulationClock::reset() {
+        accumulator = fixedStep ? stepTime : 0.0;
+        alpha = 1.0f;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+namespace AhnrealEngine {
+
+    // Turns variable frame times into simulation steps.
+    //
+    // Variable mode: one step per frame of the measured frame time.
+    // Fixed mode: frame time feeds an accumulator that is drained in steps of
+    // exactly 1 / tickRate, so simulation cost depends on elapsed time, not on
+    // the render rate. What is left over becomes the interpolation alpha
+    // between the last two simulated states.
+    //
+    // Spiral-of-death clamp: a frame never contributes more than maxFrameTime
+    // and never runs more than maxStepsPerFrame steps; time beyond that is
+    // dropped so one slow frame cannot make the next one slower still.
+    class SimulationClock {
+    public:
+        void setFixedStep(bool enabled);
+        bool isFixedStep() const { return fixedStep; }
+
+        void setTickRate(float ticksPerSecond);
+        float getTickRate() const { return tickRate; }
+        float getStepTime() const { return stepTime; }
+
+        void setMaxStepsPerFrame(uint32_t steps) { maxStepsPerFrame = steps > 0 ? steps : 1; }
+        uint32_t getMaxStepsPerFrame() const { return maxStepsPerFrame; }
+        void setMaxFrameTime(float seconds) { maxFrameTime = seconds; }
+        float getMaxFrameTime() const { return maxFrameTime; }
+
+        // Consumes one frame's elapsed time and returns the number of steps
+        // to run. Without fixedAllowed the frame runs one variable step even
+        // in fixed mode, for scenes that can't interpolate.
+        uint32_t advance(float frameTime, bool fixedAllowed = true);
+
+        // Duration of each step returned by the last advance()
+        float getDeltaTime() const { return deltaTime; }
+
+        // Fraction of a step left in the accumulator, in [0, 1]. Always 1 in variable mode.
+        float getAlpha() const { return alpha; }
+
+        // Forgets accumulated time, e.g. after a scene switch. The next
+        // advance() runs at least one step so the new state is simulated.
+        void reset();
+
+        uint64_t getTotalSteps() const { return totalSteps; }
+        float getDroppedTime() const { return droppedTime; }
+
+    private:
+        bool fixedStep = false;
+        float tickRate = 60.0f;
+        float stepTime = 1.0f / 60.0f;
+        uint32_t maxStepsPerFrame = 8;
+        float maxFrameTime = 0.25f;
+
+        double accumulator = 0.0;
+        float deltaTime = 0.0f;
+        float alpha = 1.0f;
+
+        uint64_t totalSteps = 0;
+        float droppedTime = 0.0f; // Seconds discarded by the clamp since start
+    };
+}
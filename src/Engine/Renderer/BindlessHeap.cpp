@@ -0,0 +1,208 @@
+#include "BindlessHeap.h"
+#include "VulkanSwapChain.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace AhnrealEngine {
+
+    // Upper bounds for each array. Devices usually allow far more, but every slot
+    // costs descriptor memory, so clamp to what a scene can realistically use.
+    static constexpr uint32_t MAX_STORAGE_BUFFERS = 65536;
+    static constexpr uint32_t MAX_SAMPLED_IMAGES = 16384;
+    static constexpr uint32_t MAX_SAMPLERS = 1024;
+
+    // Per-stage descriptors left for the other sets of pipelines that use
+    // the heap; the per-stage limits count every set in a layout
+    static constexpr uint32_t RESERVED_STAGE_DESCRIPTORS = 64;
+
+    static uint32_t reserveFrom(uint32_t limit) {
+        return limit > RESERVED_STAGE_DESCRIPTORS ? limit - RESERVED_STAGE_DESCRIPTORS : limit / 2;
+    }
+
+    BindlessIndex BindlessHeap::SlotAllocator::allocate() {
+        if (!freeList.empty()) {
+            BindlessIndex index = freeList.back();
+            freeList.pop_back();
+            used++;
+            return index;
+        }
+        if (next >= capacity) {
+            throw std::runtime_error("bindless heap is full!");
+        }
+        used++;
+        return next++;
+    }
+
+    BindlessHeap::BindlessHeap(VulkanDevice* device) : device{device} {
+        const DeviceCapabilities& caps = device->capabilities();
+        if (!caps.descriptorIndexing) {
+            throw std::runtime_error("bindless heap requires descriptor indexing support!");
+        }
+
+        storageBuffers.capacity = std::min(reserveFrom(caps.maxBindlessStorageBuffers), MAX_STORAGE_BUFFERS);
+        sampledImages.capacity = std::min(reserveFrom(caps.maxBindlessSampledImages), MAX_SAMPLED_IMAGES);
+        samplers.capacity = std::min(reserveFrom(caps.maxBindlessSamplers), MAX_SAMPLERS);
+
+        // All three arrays are visible to every stage, so together they must
+        // also fit the per-stage resource limit; shrink them proportionally
+        const uint64_t resourceBudget = reserveFrom(caps.maxBindlessResources);
+        const uint64_t total = uint64_t(storageBuffers.capacity) + sampledImages.capacity + samplers.capacity;
+        if (total > resourceBudget) {
+            storageBuffers.capacity = static_cast<uint32_t>(storageBuffers.capacity * resourceBudget / total);
+            sampledImages.capacity = static_cast<uint32_t>(sampledImages.capacity * resourceBudget / total);
+            samplers.capacity = static_cast<uint32_t>(samplers.capacity * resourceBudget / total);
+        }
+
+        pendingReleases.resize(VulkanSwapChain::MAX_FRAMES_IN_FLIGHT);
+
+        createSetLayout();
+        createDescriptorPool();
+        allocateDescriptorSet();
+        createPipelineLayout();
+    }
+
+    BindlessHeap::~BindlessHeap() {
+        vkDestroyPipelineLayout(device->device(), pipelineLayout, nullptr);
+        // Destroying the pool frees the set as well
+        vkDestroyDescriptorPool(device->device(), descriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(device->device(), setLayout, nullptr);
+    }
+
+    void BindlessHeap::createSetLayout() {
+        std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+        bindings[0] = {STORAGE_BUFFER_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBuffers.capacity, VK_SHADER_STAGE_ALL, nullptr};
+        bindings[1] = {SAMPLED_IMAGE_BINDING, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, sampledImages.capacity, VK_SHADER_STAGE_ALL, nullptr};
+        bindings[2] = {SAMPLER_BINDING, VK_DESCRIPTOR_TYPE_SAMPLER, samplers.capacity, VK_SHADER_STAGE_ALL, nullptr};
+
+        // Partially bound: unused slots may stay empty.
+        // Update after bind: slots can be written while the set is bound in a
+        // pending command buffer, as long as that slot is not accessed by it.
+        std::array<VkDescriptorBindingFlags, 3> bindingFlags{};
+        bindingFlags.fill(VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT);
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+        flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        flagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+        flagsInfo.pBindingFlags = bindingFlags.data();
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.pNext = &flagsInfo;
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        if (vkCreateDescriptorSetLayout(device->device(), &layoutInfo, nullptr, &setLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create bindless descriptor set layout!");
+        }
+    }
+
+    void BindlessHeap::createDescriptorPool() {
+        std::array<VkDescriptorPoolSize, 3> poolSizes{};
+        poolSizes[0] = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBuffers.capacity};
+        poolSizes[1] = {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, sampledImages.capacity};
+        poolSizes[2] = {VK_DESCRIPTOR_TYPE_SAMPLER, samplers.capacity};
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+
+        if (vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create bindless descriptor pool!");
+        }
+    }
+
+    void BindlessHeap::allocateDescriptorSet() {
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &setLayout;
+
+        if (vkAllocateDescriptorSets(device->device(), &allocInfo, &descriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate bindless descriptor set!");
+        }
+    }
+
+    void BindlessHeap::createPipelineLayout() {
+        VkPushConstantRange pushConstantRange{VK_SHADER_STAGE_ALL, 0, PUSH_CONSTANT_SIZE};
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(device->device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create bindless pipeline layout!");
+        }
+    }
+
+    BindlessIndex BindlessHeap::registerStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+        BindlessIndex index = storageBuffers.allocate();
+        updateStorageBuffer(index, buffer, offset, range);
+        return index;
+    }
+
+    void BindlessHeap::updateStorageBuffer(BindlessIndex index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+        VkDescriptorBufferInfo bufferInfo{buffer, offset, range};
+        VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, descriptorSet, STORAGE_BUFFER_BINDING, index, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &bufferInfo, nullptr};
+        vkUpdateDescriptorSets(device->device(), 1, &write, 0, nullptr);
+    }
+
+    BindlessIndex BindlessHeap::registerSampledImage(VkImageView imageView, VkImageLayout layout) {
+        BindlessIndex index = sampledImages.allocate();
+
+        VkDescriptorImageInfo imageInfo{VK_NULL_HANDLE, imageView, layout};
+        VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, descriptorSet, SAMPLED_IMAGE_BINDING, index, 1, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, &imageInfo, nullptr, nullptr};
+        vkUpdateDescriptorSets(device->device(), 1, &write, 0, nullptr);
+        return index;
+    }
+
+    BindlessIndex BindlessHeap::registerSampler(VkSampler sampler) {
+        BindlessIndex index = samplers.allocate();
+
+        VkDescriptorImageInfo imageInfo{sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED};
+        VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, descriptorSet, SAMPLER_BINDING, index, 1, VK_DESCRIPTOR_TYPE_SAMPLER, &imageInfo, nullptr, nullptr};
+        vkUpdateDescriptorSets(device->device(), 1, &write, 0, nullptr);
+        return index;
+    }
+
+    void BindlessHeap::releaseStorageBuffer(BindlessIndex index) { release(StorageBufferSlot, index); }
+    void BindlessHeap::releaseSampledImage(BindlessIndex index) { release(SampledImageSlot, index); }
+    void BindlessHeap::releaseSampler(BindlessIndex index) { release(SamplerSlot, index); }
+
+    void BindlessHeap::release(SlotKind kind, BindlessIndex index) {
+        if (index == INVALID_BINDLESS_INDEX) return;
+        pendingReleases[currentFrame].push_back({kind, index});
+    }
+
+    BindlessHeap::SlotAllocator& BindlessHeap::allocatorFor(SlotKind kind) {
+        switch (kind) {
+            case StorageBufferSlot: return storageBuffers;
+            case SampledImageSlot: return sampledImages;
+            default: return samplers;
+        }
+    }
+
+    void BindlessHeap::beginFrame(uint32_t frameIndex) {
+        // The renderer calls this after the frame's fence was waited, so nothing
+        // recorded the last time this slot was used can still read the entries
+        currentFrame = frameIndex;
+        for (const auto& pending : pendingReleases[currentFrame]) {
+            SlotAllocator& slots = allocatorFor(pending.kind);
+            slots.freeList.push_back(pending.index);
+            slots.used--;
+        }
+        pendingReleases[currentFrame].clear();
+    }
+
+    void BindlessHeap::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t setIndex) const {
+        vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, setIndex, 1, &descriptorSet, 0, nullptr);
+    }
+}
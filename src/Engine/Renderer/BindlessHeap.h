@@ -0,0 +1,102 @@
+#pragma once
+
+#include "VulkanDevice.h"
+#include <cstdint>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    // Slot inside one of the global descriptor arrays. Shaders receive it as a
+    // plain uint (push constant or instance data) and index the matching array.
+    using BindlessIndex = uint32_t;
+    constexpr BindlessIndex INVALID_BINDLESS_INDEX = 0xFFFFFFFFu;
+
+    // Global descriptor heap built on descriptor indexing. One set holds large
+    // partially bound arrays of storage buffers, sampled images and samplers, so
+    // a draw selects its resources by index instead of binding a new set.
+    class BindlessHeap {
+    public:
+        // Binding slots inside the heap set (see instance_bindless.vert)
+        static constexpr uint32_t STORAGE_BUFFER_BINDING = 0;
+        static constexpr uint32_t SAMPLED_IMAGE_BINDING = 1;
+        static constexpr uint32_t SAMPLER_BINDING = 2;
+
+        // Size of the shared push constant block exposed to every stage; 128 bytes
+        // is the minimum maxPushConstantsSize guaranteed by the spec
+        static constexpr uint32_t PUSH_CONSTANT_SIZE = 128;
+
+        explicit BindlessHeap(VulkanDevice* device);
+        ~BindlessHeap();
+
+        BindlessHeap(const BindlessHeap&) = delete;
+        BindlessHeap& operator=(const BindlessHeap&) = delete;
+
+        BindlessIndex registerStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+        BindlessIndex registerSampledImage(VkImageView imageView, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        BindlessIndex registerSampler(VkSampler sampler);
+
+        // Rewrites an existing slot in place, e.g. after a buffer was reallocated
+        void updateStorageBuffer(BindlessIndex index, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+        // Released slots are recycled only after every frame in flight that could
+        // still reference them has retired
+        void releaseStorageBuffer(BindlessIndex index);
+        void releaseSampledImage(BindlessIndex index);
+        void releaseSampler(BindlessIndex index);
+
+        // Called once per frame by the renderer to recycle retired slots
+        void beginFrame(uint32_t frameIndex);
+
+        void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t setIndex = 0) const;
+
+        VkDescriptorSetLayout getSetLayout() const { return setLayout; }
+        VkDescriptorSet getDescriptorSet() const { return descriptorSet; }
+
+        // Set 0 = heap, one push constant range covering all stages. Scenes that
+        // need nothing else can use this layout directly.
+        VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
+
+        uint32_t getStorageBufferCount() const { return storageBuffers.used; }
+        uint32_t getSampledImageCount() const { return sampledImages.used; }
+        uint32_t getSamplerCount() const { return samplers.used; }
+
+    private:
+        enum SlotKind { StorageBufferSlot, SampledImageSlot, SamplerSlot };
+
+        struct SlotAllocator {
+            uint32_t capacity = 0;
+            uint32_t next = 0;
+            uint32_t used = 0;
+            std::vector<BindlessIndex> freeList;
+
+            BindlessIndex allocate();
+        };
+
+        struct PendingRelease {
+            SlotKind kind;
+            BindlessIndex index;
+        };
+
+        void createSetLayout();
+        void createDescriptorPool();
+        void allocateDescriptorSet();
+        void createPipelineLayout();
+        void release(SlotKind kind, BindlessIndex index);
+        SlotAllocator& allocatorFor(SlotKind kind);
+
+        VulkanDevice* device;
+
+        VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+        SlotAllocator storageBuffers;
+        SlotAllocator sampledImages;
+        SlotAllocator samplers;
+
+        // Slots released while recording each frame-in-flight slot
+        std::vector<std::vector<PendingRelease>> pendingReleases;
+        uint32_t currentFrame = 0;
+    };
+}
@@ -0,0 +1,208 @@
+#include "ClusteredLighting.h"
+#include "VulkanSwapChain.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace AhnrealEngine {
+
+    static std::vector<char> readShaderFile(const std::string& filename) {
+        std::vector<std::string> paths = {
+            "build/Debug/" + filename,
+            "../shaders/" + filename,
+            "../../shaders/" + filename,
+            "shaders/" + filename,
+            filename
+        };
+
+        for (const auto& path : paths) {
+            std::ifstream file(path, std::ios::ate | std::ios::binary);
+            if (file.is_open()) {
+                size_t fileSize = (size_t)file.tellg();
+                std::vector<char> buffer(fileSize);
+                file.seekg(0);
+                file.read(buffer.data(), fileSize);
+                return buffer;
+            }
+        }
+        throw std::runtime_error("Failed to find/open shader file: " + filename);
+    }
+
+    ClusteredLighting::ClusteredLighting(VulkanDevice* device, uint32_t maxLights)
+        : device(device), maxLights(maxLights), frames(VulkanSwapChain::MAX_FRAMES_IN_FLIGHT) {
+        createBuffers();
+        createDescriptors();
+        createPipeline();
+    }
+
+    ClusteredLighting::~ClusteredLighting() {
+        if (pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device->device(), pipeline, nullptr);
+        if (pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device->device(), pipelineLayout, nullptr);
+        if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device->device(), descriptorPool, nullptr);
+        if (setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device->device(), setLayout, nullptr);
+
+        for (FrameResources& frame : frames) {
+            for (Buffer* buffer : {&frame.params, &frame.lights, &frame.clusters, &frame.indices, &frame.counter}) {
+                destroyBuffer(*buffer);
+            }
+        }
+    }
+
+    void ClusteredLighting::createBuffers() {
+        for (FrameResources& frame : frames) {
+            frame.params = createBuffer(sizeof(ClusterParams), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, true);
+            frame.lights = createBuffer(sizeof(ClusterLight) * std::max(maxLights, 1u), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true);
+            frame.clusters = createBuffer(sizeof(uint32_t) * 2 * CLUSTER_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, false);
+            frame.indices = createBuffer(sizeof(uint32_t) * INDEX_CAPACITY, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, false);
+            // Host-visible so the UI can report how full the index list got
+            frame.counter = createBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, true);
+            memset(frame.counter.mapped, 0, sizeof(uint32_t));
+        }
+    }
+
+    void ClusteredLighting::createDescriptors() {
+        // [0: Params(U), 1: Lights, 2: Clusters, 3: LightIndices, 4: Counter]
+        // The fragment shaders read 0-3; the counter is only for binning
+        VkDescriptorSetLayoutBinding bindings[5];
+        for (uint32_t i = 0; i < 5; i++) {
+            VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT;
+            if (i < 4) stages |= VK_SHADER_STAGE_FRAGMENT_BIT;
+            bindings[i] = {i, i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, stages, nullptr};
+        }
+        VkDescriptorSetLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 5, bindings};
+        if (vkCreateDescriptorSetLayout(device->device(), &layoutInfo, nullptr, &setLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create cluster descriptor set layout!");
+        }
+
+        const uint32_t frameCount = static_cast<uint32_t>(frames.size());
+        VkDescriptorPoolSize poolSizes[] = {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frameCount },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 * frameCount }
+        };
+        VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, nullptr, 0, frameCount, 2, poolSizes};
+        if (vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create cluster descriptor pool!");
+        }
+
+        for (FrameResources& frame : frames) {
+            VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr, descriptorPool, 1, &setLayout};
+            if (vkAllocateDescriptorSets(device->device(), &allocInfo, &frame.set) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate cluster descriptor set!");
+            }
+
+            VkDescriptorBufferInfo infos[] = {
+                { frame.params.buffer, 0, sizeof(ClusterParams) },
+                { frame.lights.buffer, 0, VK_WHOLE_SIZE },
+                { frame.clusters.buffer, 0, VK_WHOLE_SIZE },
+                { frame.indices.buffer, 0, VK_WHOLE_SIZE },
+                { frame.counter.buffer, 0, VK_WHOLE_SIZE }
+            };
+            VkWriteDescriptorSet writes[5];
+            for (uint32_t i = 0; i < 5; i++) {
+                writes[i] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, frame.set, i, 0, 1, bindings[i].descriptorType, nullptr, &infos[i], nullptr};
+            }
+            vkUpdateDescriptorSets(device->device(), 5, writes, 0, nullptr);
+        }
+    }
+
+    void ClusteredLighting::createPipeline() {
+        VkPipelineLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        layoutInfo.setLayoutCount = 1;
+        layoutInfo.pSetLayouts = &setLayout;
+        if (vkCreatePipelineLayout(device->device(), &layoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create cluster pipeline layout!");
+        }
+
+        auto code = readShaderFile("cluster_lights.comp.spv");
+        VkShaderModuleCreateInfo moduleInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, nullptr, 0, code.size(), reinterpret_cast<const uint32_t*>(code.data())};
+        VkShaderModule module;
+        if (vkCreateShaderModule(device->device(), &moduleInfo, nullptr, &module) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shader module!");
+        }
+
+        VkComputePipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+        pipelineInfo.layout = pipelineLayout;
+        pipelineInfo.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, module, "main", nullptr};
+        VkResult result = vkCreateComputePipelines(device->device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        vkDestroyShaderModule(device->device(), module, nullptr);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to create cluster compute pipeline!");
+        }
+    }
+
+    void ClusteredLighting::setLights(uint32_t frameIndex, const std::vector<ClusterLight>& lights) {
+        FrameResources& frame = frames[frameIndex];
+        frame.lightCount = std::min(static_cast<uint32_t>(lights.size()), maxLights);
+        memcpy(frame.lights.mapped, lights.data(), sizeof(ClusterLight) * frame.lightCount);
+    }
+
+    void ClusteredLighting::recordAssignment(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                                             const FrameCamera& camera, VkExtent2D extent) {
+        FrameResources& frame = frames[frameIndex];
+
+        // Slice k starts at near * (far / near)^(k / CLUSTER_Z), so a view
+        // depth d falls in slice log(d) * scale + bias
+        const float logDepthRange = std::log(camera.farPlane / camera.nearPlane);
+        const float sliceScale = CLUSTER_Z / logDepthRange;
+        const float sliceBias = -CLUSTER_Z * std::log(camera.nearPlane) / logDepthRange;
+
+        ClusterParams params{};
+        params.view = camera.view;
+        params.grid = glm::uvec4(CLUSTER_X, CLUSTER_Y, CLUSTER_Z, frame.lightCount);
+        // proj[0][0] = 1 / (aspect * tan(fov / 2)); proj[1][1] is negated for Vulkan
+        params.screen = glm::vec4(static_cast<float>(CLUSTER_X) / std::max(extent.width, 1u),
+                                  static_cast<float>(CLUSTER_Y) / std::max(extent.height, 1u),
+                                  1.0f / camera.proj[0][0], 1.0f / std::abs(camera.proj[1][1]));
+        params.depth = glm::vec4(camera.nearPlane, camera.farPlane, sliceScale, sliceBias);
+        params.limits = glm::uvec4(INDEX_CAPACITY, 0, 0, 0);
+        memcpy(frame.params.mapped, &params, sizeof(ClusterParams));
+
+        // The slot's previous readers finished with its frame fence, so only
+        // the counter reset needs ordering
+        vkCmdFillBuffer(commandBuffer, frame.counter.buffer, 0, VK_WHOLE_SIZE, 0);
+
+        VkMemoryBarrier resetBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &resetBarrier, 0, nullptr, 0, nullptr);
+
+        // One workgroup per cluster
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &frame.set, 0, nullptr);
+        vkCmdDispatch(commandBuffer, CLUSTER_X, CLUSTER_Y, CLUSTER_Z);
+
+        // Barrier: Compute -> Fragment, and the counter to the host
+        VkMemoryBarrier lightBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        lightBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        lightBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &lightBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    uint32_t ClusteredLighting::getRequestedIndexCount(uint32_t frameIndex) const {
+        uint32_t count;
+        memcpy(&count, frames[frameIndex].counter.mapped, sizeof(uint32_t));
+        return count;
+    }
+
+    ClusteredLighting::Buffer ClusteredLighting::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, bool hostVisible) {
+        Buffer buffer;
+        VkMemoryPropertyFlags properties = hostVisible
+            ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+            : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        device->createBuffer(size, usage, properties, buffer.buffer, buffer.memory);
+        if (hostVisible) {
+            vkMapMemory(device->device(), buffer.memory, 0, size, 0, &buffer.mapped);
+        }
+        return buffer;
+    }
+
+    void ClusteredLighting::destroyBuffer(Buffer& buffer) {
+        if (buffer.buffer != VK_NULL_HANDLE) vkDestroyBuffer(device->device(), buffer.buffer, nullptr);
+        if (buffer.memory != VK_NULL_HANDLE) vkFreeMemory(device->device(), buffer.memory, nullptr);
+        buffer = Buffer{};
+    }
+}
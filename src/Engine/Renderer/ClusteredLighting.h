@@ -0,0 +1,117 @@
+#pragma once
+
+#include "VulkanDevice.h"
+#include "../Scene/FramePacket.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    // Light as stored on the GPU, in world space. Point lights have no cone:
+    // cosOuter -1 lets every direction through.
+    struct ClusterLight {
+        glm::vec3 position;
+        float range;        // Influence ends here
+        glm::vec3 color;    // Premultiplied by intensity
+        float cosInner;     // Spot falloff starts here
+        glm::vec3 direction;
+        float cosOuter;     // Spot cone edge
+    };
+
+    // Uniform block of cluster_lights.comp and the clustered fragment shaders
+    struct ClusterParams {
+        glm::mat4 view;
+        glm::uvec4 grid;    // Clusters along x, y, z; light count
+        glm::vec4 screen;   // Clusters per pixel (x, y); tan of the half field of view (x, y)
+        glm::vec4 depth;    // Near, far, slice scale, slice bias
+        glm::uvec4 limits;  // Light index capacity
+    };
+
+    // Clustered forward lighting. The view frustum is split into a froxel
+    // grid, CLUSTER_X x CLUSTER_Y screen tiles by CLUSTER_Z slices spaced
+    // exponentially between the camera's near and far planes, so slices stay
+    // roughly cubic. A compute pass bins every light into the clusters its
+    // sphere (and cone, for spots) touches and packs the results into one
+    // index list; each cluster gets an (offset, count) range of it. Fragment
+    // shaders find their cluster from gl_FragCoord and view depth and only
+    // loop over that range, so shading cost follows local light density
+    // rather than the total light count.
+    //
+    // Everything is per frame slot: setLights() writes the slot's mapped
+    // light buffer and recordAssignment() bins into the slot's lists, so
+    // neither waits on the other frame in flight.
+    class ClusteredLighting {
+    public:
+        static constexpr uint32_t CLUSTER_X = 16;
+        static constexpr uint32_t CLUSTER_Y = 9;
+        static constexpr uint32_t CLUSTER_Z = 24;
+        static constexpr uint32_t CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+        // Lights one cluster can hold; cluster_lights.comp drops the rest
+        static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 256;
+        // The shared index list is sized for this average per cluster
+        static constexpr uint32_t AVERAGE_LIGHTS_PER_CLUSTER = 64;
+        static constexpr uint32_t INDEX_CAPACITY = CLUSTER_COUNT * AVERAGE_LIGHTS_PER_CLUSTER;
+
+        ClusteredLighting(VulkanDevice* device, uint32_t maxLights);
+        ~ClusteredLighting();
+
+        ClusteredLighting(const ClusteredLighting&) = delete;
+        ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+        uint32_t getMaxLights() const { return maxLights; }
+
+        // Lights for the frame slot; anything past getMaxLights() is ignored
+        void setLights(uint32_t frameIndex, const std::vector<ClusterLight>& lights);
+
+        // Records the light binning for the slot's lights, outside a render
+        // pass. The grid follows the camera's projection, so its field of
+        // view is the one Camera::zoom gave, and extent is the framebuffer
+        // the fragment shaders shade. Ends with a barrier to fragment reads.
+        void recordAssignment(VkCommandBuffer commandBuffer, uint32_t frameIndex,
+                              const FrameCamera& camera, VkExtent2D extent);
+
+        // Set for the fragment shaders: 0 ClusterParams, 1 lights,
+        // 2 cluster ranges (uvec2 offset, count), 3 light indices
+        VkDescriptorSetLayout getDescriptorSetLayout() const { return setLayout; }
+        VkDescriptorSet getDescriptorSet(uint32_t frameIndex) const { return frames[frameIndex].set; }
+
+        // Indices the slot's last finished assignment asked for; above
+        // INDEX_CAPACITY some clusters lost lights. Read once the slot's
+        // frame has completed.
+        uint32_t getRequestedIndexCount(uint32_t frameIndex) const;
+
+    private:
+        struct Buffer {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            void* mapped = nullptr; // Host-visible buffers only
+        };
+
+        struct FrameResources {
+            Buffer params;
+            Buffer lights;
+            Buffer clusters;
+            Buffer indices;
+            Buffer counter;
+            uint32_t lightCount = 0;
+            VkDescriptorSet set = VK_NULL_HANDLE;
+        };
+
+        void createBuffers();
+        void createDescriptors();
+        void createPipeline();
+        Buffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, bool hostVisible);
+        void destroyBuffer(Buffer& buffer);
+
+        VulkanDevice* device;
+        uint32_t maxLights;
+
+        std::vector<FrameResources> frames;
+
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+    };
+}
@@ -0,0 +1,202 @@
+#include "DescriptorAllocator.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace AhnrealEngine {
+
+    // Pools double in size as they are chained, up to this many sets each
+    static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+    static const std::vector<DescriptorPoolRatio> DEFAULT_POOL_RATIOS = {
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f },
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f },
+        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f },
+        { VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f }
+    };
+
+    // ---------------------------------------------------------------- Allocator
+
+    DescriptorAllocator::DescriptorAllocator(VulkanDevice* device, uint32_t initialSetsPerPool)
+        : DescriptorAllocator(device, initialSetsPerPool, DEFAULT_POOL_RATIOS) {}
+
+    DescriptorAllocator::DescriptorAllocator(VulkanDevice* device, uint32_t initialSetsPerPool, const std::vector<DescriptorPoolRatio>& poolRatios)
+        : device{device}, ratios{poolRatios}, setsPerPool{std::max(initialSetsPerPool, 1u)} {}
+
+    DescriptorAllocator::~DescriptorAllocator() {
+        for (VkDescriptorPool pool : usedPools) {
+            vkDestroyDescriptorPool(device->device(), pool, nullptr);
+        }
+        for (VkDescriptorPool pool : freePools) {
+            vkDestroyDescriptorPool(device->device(), pool, nullptr);
+        }
+    }
+
+    VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout) {
+        if (currentPool == VK_NULL_HANDLE) {
+            currentPool = acquirePool();
+        }
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = currentPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &layout;
+
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        VkResult result = vkAllocateDescriptorSets(device->device(), &allocInfo, &set);
+
+        // Current pool is exhausted: chain a new one and retry once
+        if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+            currentPool = acquirePool();
+            allocInfo.descriptorPool = currentPool;
+            result = vkAllocateDescriptorSets(device->device(), &allocInfo, &set);
+        }
+
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate descriptor set!");
+        }
+        allocatedSets++;
+        return set;
+    }
+
+    void DescriptorAllocator::reset() {
+        for (VkDescriptorPool pool : usedPools) {
+            vkResetDescriptorPool(device->device(), pool, 0);
+            freePools.push_back(pool);
+        }
+        usedPools.clear();
+        currentPool = VK_NULL_HANDLE;
+        allocatedSets = 0;
+    }
+
+    VkDescriptorPool DescriptorAllocator::acquirePool() {
+        VkDescriptorPool pool;
+        if (!freePools.empty()) {
+            pool = freePools.back();
+            freePools.pop_back();
+        } else {
+            pool = createPool(setsPerPool);
+            setsPerPool = std::min(setsPerPool * 2, MAX_SETS_PER_POOL);
+        }
+        usedPools.push_back(pool);
+        return pool;
+    }
+
+    VkDescriptorPool DescriptorAllocator::createPool(uint32_t setCount) {
+        std::vector<VkDescriptorPoolSize> poolSizes;
+        poolSizes.reserve(ratios.size());
+        for (const auto& ratio : ratios) {
+            uint32_t count = std::max(1u, static_cast<uint32_t>(ratio.ratio * setCount));
+            poolSizes.push_back({ ratio.type, count });
+        }
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = setCount;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+
+        VkDescriptorPool pool;
+        if (vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor pool!");
+        }
+        return pool;
+    }
+
+    // ------------------------------------------------------------- Layout cache
+
+    DescriptorLayoutCache::~DescriptorLayoutCache() {
+        for (auto& [key, layout] : layouts) {
+            vkDestroyDescriptorSetLayout(device->device(), layout, nullptr);
+        }
+    }
+
+    VkDescriptorSetLayout DescriptorLayoutCache::getLayout(std::vector<VkDescriptorSetLayoutBinding> bindings) {
+        // Order-independent key: the same bindings listed differently are one layout
+        std::sort(bindings.begin(), bindings.end(),
+            [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+                return a.binding < b.binding;
+            });
+
+        LayoutKey key{ std::move(bindings) };
+        auto it = layouts.find(key);
+        if (it != layouts.end()) {
+            return it->second;
+        }
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(key.bindings.size());
+        layoutInfo.pBindings = key.bindings.data();
+
+        VkDescriptorSetLayout layout;
+        if (vkCreateDescriptorSetLayout(device->device(), &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor set layout!");
+        }
+        layouts.emplace(std::move(key), layout);
+        return layout;
+    }
+
+    bool DescriptorLayoutCache::LayoutKey::operator==(const LayoutKey& other) const {
+        if (bindings.size() != other.bindings.size()) return false;
+        for (size_t i = 0; i < bindings.size(); i++) {
+            const auto& a = bindings[i];
+            const auto& b = other.bindings[i];
+            if (a.binding != b.binding || a.descriptorType != b.descriptorType ||
+                a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t DescriptorLayoutCache::LayoutKeyHash::operator()(const LayoutKey& key) const {
+        size_t result = std::hash<size_t>()(key.bindings.size());
+        for (const auto& b : key.bindings) {
+            // Pack the binding into one 64-bit value, then mix it in
+            uint64_t packed = static_cast<uint64_t>(b.binding) |
+                              static_cast<uint64_t>(b.descriptorType) << 8 |
+                              static_cast<uint64_t>(b.descriptorCount) << 16 |
+                              static_cast<uint64_t>(b.stageFlags) << 40;
+            result ^= std::hash<uint64_t>()(packed) + 0x9e3779b9 + (result << 6) + (result >> 2);
+        }
+        return result;
+    }
+
+    // ---------------------------------------------------------- Update template
+
+    DescriptorUpdateTemplate::DescriptorUpdateTemplate(VulkanDevice* device, VkDescriptorSetLayout layout, const std::vector<VkDescriptorUpdateTemplateEntry>& entries)
+        : device{device} {
+        VkDescriptorUpdateTemplateCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        createInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+        createInfo.pDescriptorUpdateEntries = entries.data();
+        createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+        createInfo.descriptorSetLayout = layout;
+
+        if (vkCreateDescriptorUpdateTemplate(device->device(), &createInfo, nullptr, &updateTemplate) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor update template!");
+        }
+    }
+
+    DescriptorUpdateTemplate::~DescriptorUpdateTemplate() {
+        vkDestroyDescriptorUpdateTemplate(device->device(), updateTemplate, nullptr);
+    }
+
+    void DescriptorUpdateTemplate::update(VkDescriptorSet set, const void* data) const {
+        vkUpdateDescriptorSetWithTemplate(device->device(), set, updateTemplate, data);
+    }
+
+    VkDescriptorUpdateTemplateEntry DescriptorUpdateTemplate::bufferEntry(uint32_t binding, VkDescriptorType type, size_t offset, uint32_t count) {
+        return { binding, 0, count, type, offset, sizeof(VkDescriptorBufferInfo) };
+    }
+
+    VkDescriptorUpdateTemplateEntry DescriptorUpdateTemplate::imageEntry(uint32_t binding, VkDescriptorType type, size_t offset, uint32_t count) {
+        return { binding, 0, count, type, offset, sizeof(VkDescriptorImageInfo) };
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "VulkanDevice.h"
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    // Descriptors reserved per set in each new pool, by type. A pool created
+    // for N sets holds ratio * N descriptors of each type.
+    struct DescriptorPoolRatio {
+        VkDescriptorType type;
+        float ratio;
+    };
+
+    // Growable descriptor allocator. Sets come from a chain of pools; when the
+    // current pool runs out, a larger one is appended instead of failing.
+    // reset() recycles every pool at once with vkResetDescriptorPool, which makes
+    // it suitable for per-frame transient sets.
+    class DescriptorAllocator {
+    public:
+        explicit DescriptorAllocator(VulkanDevice* device, uint32_t initialSetsPerPool = 64);
+        DescriptorAllocator(VulkanDevice* device, uint32_t initialSetsPerPool, const std::vector<DescriptorPoolRatio>& poolRatios);
+        ~DescriptorAllocator();
+
+        DescriptorAllocator(const DescriptorAllocator&) = delete;
+        DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+        VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+        // Invalidates every set handed out so far. Pools are kept for reuse.
+        void reset();
+
+        uint32_t getPoolCount() const { return static_cast<uint32_t>(usedPools.size() + freePools.size()); }
+        uint32_t getAllocatedSetCount() const { return allocatedSets; }
+
+    private:
+        VkDescriptorPool acquirePool();
+        VkDescriptorPool createPool(uint32_t setCount);
+
+        VulkanDevice* device;
+        std::vector<DescriptorPoolRatio> ratios;
+        uint32_t setsPerPool;
+
+        VkDescriptorPool currentPool = VK_NULL_HANDLE;
+        std::vector<VkDescriptorPool> usedPools; // Full or partially used since the last reset
+        std::vector<VkDescriptorPool> freePools; // Reset and ready to hand out again
+        uint32_t allocatedSets = 0;
+    };
+
+    // Deduplicates descriptor set layouts. Identical binding lists map to the
+    // same VkDescriptorSetLayout, owned by the cache for the device lifetime.
+    class DescriptorLayoutCache {
+    public:
+        explicit DescriptorLayoutCache(VulkanDevice* device) : device{device} {}
+        ~DescriptorLayoutCache();
+
+        DescriptorLayoutCache(const DescriptorLayoutCache&) = delete;
+        DescriptorLayoutCache& operator=(const DescriptorLayoutCache&) = delete;
+
+        // Immutable samplers are not supported; pImmutableSamplers must be null
+        VkDescriptorSetLayout getLayout(std::vector<VkDescriptorSetLayoutBinding> bindings);
+
+        uint32_t getLayoutCount() const { return static_cast<uint32_t>(layouts.size()); }
+
+    private:
+        struct LayoutKey {
+            std::vector<VkDescriptorSetLayoutBinding> bindings;
+            bool operator==(const LayoutKey& other) const;
+        };
+
+        struct LayoutKeyHash {
+            size_t operator()(const LayoutKey& key) const;
+        };
+
+        VulkanDevice* device;
+        std::unordered_map<LayoutKey, VkDescriptorSetLayout, LayoutKeyHash> layouts;
+    };
+
+    // Wraps VkDescriptorUpdateTemplate. The entries describe where each
+    // descriptor info lives inside a plain struct, so a whole set is written
+    // with one call instead of building VkWriteDescriptorSet arrays.
+    class DescriptorUpdateTemplate {
+    public:
+        DescriptorUpdateTemplate(VulkanDevice* device, VkDescriptorSetLayout layout, const std::vector<VkDescriptorUpdateTemplateEntry>& entries);
+        ~DescriptorUpdateTemplate();
+
+        DescriptorUpdateTemplate(const DescriptorUpdateTemplate&) = delete;
+        DescriptorUpdateTemplate& operator=(const DescriptorUpdateTemplate&) = delete;
+
+        void update(VkDescriptorSet set, const void* data) const;
+
+        // Entry for `count` descriptors starting at `offset` bytes into the data
+        // struct, laid out as an array of VkDescriptorBufferInfo/VkDescriptorImageInfo
+        static VkDescriptorUpdateTemplateEntry bufferEntry(uint32_t binding, VkDescriptorType type, size_t offset, uint32_t count = 1);
+        static VkDescriptorUpdateTemplateEntry imageEntry(uint32_t binding, VkDescriptorType type, size_t offset, uint32_t count = 1);
+
+    private:
+        VulkanDevice* device;
+        VkDescriptorUpdateTemplate updateTemplate = VK_NULL_HANDLE;
+    };
+}
@@ -0,0 +1,386 @@
+#include "GpuPrimitives.h"
+#include "DescriptorAllocator.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace AhnrealEngine {
+
+    // Push constants, matching the primitive_*.comp shaders
+    struct ScanParams {
+        uint32_t count;
+        uint32_t inclusive;
+        uint32_t predicate;
+    };
+
+    struct CompactParams {
+        uint32_t count;
+        uint32_t elementWords;
+    };
+
+    struct ReduceParams {
+        uint32_t segmentCount;
+        uint32_t operation;
+    };
+
+    struct RadixParams {
+        uint32_t count;
+        uint32_t keyWords;
+        uint32_t wordIndex;
+        uint32_t shift;
+        uint32_t tileCount;
+        uint32_t indirect; // Count and tileCount come from the indirect arguments
+    };
+
+    struct RadixArgsParams {
+        uint32_t countWord;
+        uint32_t maxCount;
+        uint32_t scanLevels;
+    };
+
+    static constexpr uint32_t RADIX_BINS = 256;
+
+    // Arguments primitive_radix_args.comp writes for radixSortIndirect, at
+    // the end of its scratch, in words: element count, tile count, two
+    // unused, the tile dispatch, then one dispatch per scan level
+    static constexpr uint32_t RADIX_ARGS_TILE_DISPATCH = 4;
+    static constexpr uint32_t RADIX_ARGS_SCAN_DISPATCH = 7;
+    // Enough for any uint32 element count
+    static constexpr uint32_t MAX_SCAN_LEVELS = 4;
+    static constexpr VkDeviceSize RADIX_ARGS_SIZE = sizeof(uint32_t) * (RADIX_ARGS_SCAN_DISPATCH + 3 * MAX_SCAN_LEVELS);
+    // Reduction workgroups; more segments are looped over
+    static constexpr uint32_t MAX_REDUCE_GROUPS = 65535;
+
+    static std::vector<char> readShaderFile(const std::string& filename) {
+        std::vector<std::string> paths = {
+            "build/Debug/" + filename,
+            "../shaders/" + filename,
+            "../../shaders/" + filename,
+            "shaders/" + filename,
+            filename
+        };
+
+        for (const auto& path : paths) {
+            std::ifstream file(path, std::ios::ate | std::ios::binary);
+            if (file.is_open()) {
+                size_t fileSize = (size_t)file.tellg();
+                std::vector<char> buffer(fileSize);
+                file.seekg(0);
+                file.read(buffer.data(), fileSize);
+                return buffer;
+            }
+        }
+        throw std::runtime_error("Failed to find/open shader file: " + filename);
+    }
+
+    static uint32_t blockCount(uint32_t count) {
+        return (count + GpuPrimitives::BLOCK_SIZE - 1) / GpuPrimitives::BLOCK_SIZE;
+    }
+
+    // Levels recordScan recurses through for count elements
+    static uint32_t scanLevels(uint32_t count) {
+        uint32_t levels = 1;
+        for (uint32_t blocks = blockCount(count); blocks > 1; blocks = blockCount(blocks)) levels++;
+        return levels;
+    }
+
+    static VkDeviceSize scanDispatchOffset(uint32_t level) {
+        return sizeof(uint32_t) * (RADIX_ARGS_SCAN_DISPATCH + 3 * level);
+    }
+
+    // Compute-written arguments to the indirect dispatches and shader reads after them
+    static void indirectArgsBarrier(VkCommandBuffer commandBuffer) {
+        VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    GpuPrimitives::GpuPrimitives(VulkanDevice* device)
+        : device(device), alignment(std::max<VkDeviceSize>(device->capabilities().minStorageBufferOffsetAlignment, 4)) {
+        createKernel(scanBlocks, "primitive_scan_blocks.comp.spv", 3);
+        createKernel(scanAdd, "primitive_scan_add.comp.spv", 2);
+        createKernel(compactScatter, "primitive_compact.comp.spv", 5);
+        createKernel(segmentedReduceKernel, "primitive_segmented_reduce.comp.spv", 3);
+        createKernel(radixHistogram, "primitive_radix_histogram.comp.spv", 3);
+        createKernel(radixScatter, "primitive_radix_scatter.comp.spv", 6);
+        createKernel(radixArgs, "primitive_radix_args.comp.spv", 2);
+    }
+
+    GpuPrimitives::~GpuPrimitives() {
+        for (Kernel* kernel : {&scanBlocks, &scanAdd, &compactScatter, &segmentedReduceKernel, &radixHistogram, &radixScatter, &radixArgs}) {
+            if (kernel->pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device->device(), kernel->pipeline, nullptr);
+            if (kernel->layout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device->device(), kernel->layout, nullptr);
+            if (kernel->setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device->device(), kernel->setLayout, nullptr);
+            *kernel = Kernel{};
+        }
+    }
+
+    void GpuPrimitives::createKernel(Kernel& kernel, const std::string& shaderFile, uint32_t bindingCount) {
+        std::vector<VkDescriptorSetLayoutBinding> bindings(bindingCount);
+        for (uint32_t i = 0; i < bindingCount; i++) {
+            bindings[i] = {i, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr};
+        }
+        VkDescriptorSetLayoutCreateInfo setLayoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+        setLayoutInfo.bindingCount = bindingCount;
+        setLayoutInfo.pBindings = bindings.data();
+        if (vkCreateDescriptorSetLayout(device->device(), &setLayoutInfo, nullptr, &kernel.setLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create primitive descriptor set layout!");
+        }
+
+        VkPushConstantRange pushConstant{VK_SHADER_STAGE_COMPUTE_BIT, 0, PUSH_CONSTANT_SIZE};
+        VkPipelineLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        layoutInfo.setLayoutCount = 1;
+        layoutInfo.pSetLayouts = &kernel.setLayout;
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges = &pushConstant;
+        if (vkCreatePipelineLayout(device->device(), &layoutInfo, nullptr, &kernel.layout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create primitive pipeline layout!");
+        }
+
+        auto code = readShaderFile(shaderFile);
+        VkShaderModuleCreateInfo moduleInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, nullptr, 0, code.size(), reinterpret_cast<const uint32_t*>(code.data())};
+        VkShaderModule module;
+        if (vkCreateShaderModule(device->device(), &moduleInfo, nullptr, &module) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shader module!");
+        }
+
+        VkComputePipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+        pipelineInfo.layout = kernel.layout;
+        pipelineInfo.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, module, "main", nullptr};
+        VkResult result = vkCreateComputePipelines(device->device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &kernel.pipeline);
+        vkDestroyShaderModule(device->device(), module, nullptr);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to create primitive compute pipeline!");
+        }
+        kernel.bindingCount = bindingCount;
+    }
+
+    void GpuPrimitives::bind(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, const Kernel& kernel,
+                             std::initializer_list<GpuBufferRange> buffers, const void* pushConstants, uint32_t pushConstantSize) {
+        VkDescriptorSet set = descriptors.allocate(kernel.setLayout);
+
+        std::vector<VkDescriptorBufferInfo> infos;
+        infos.reserve(buffers.size());
+        for (const GpuBufferRange& buffer : buffers) {
+            infos.push_back({buffer.buffer, buffer.offset, buffer.range});
+        }
+        std::vector<VkWriteDescriptorSet> writes(infos.size());
+        for (uint32_t i = 0; i < writes.size(); i++) {
+            writes[i] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, set, i, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &infos[i], nullptr};
+        }
+        vkUpdateDescriptorSets(device->device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.layout, 0, 1, &set, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, kernel.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize, pushConstants);
+    }
+
+    void GpuPrimitives::dispatch(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, const Kernel& kernel,
+                                 std::initializer_list<GpuBufferRange> buffers, const void* pushConstants, uint32_t pushConstantSize,
+                                 uint32_t groupCount) {
+        bind(commandBuffer, descriptors, kernel, buffers, pushConstants, pushConstantSize);
+        vkCmdDispatch(commandBuffer, groupCount, 1, 1);
+    }
+
+    void GpuPrimitives::dispatchIndirect(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, const Kernel& kernel,
+                                         std::initializer_list<GpuBufferRange> buffers, const void* pushConstants, uint32_t pushConstantSize,
+                                         const GpuBufferRange& args, VkDeviceSize argsOffset) {
+        bind(commandBuffer, descriptors, kernel, buffers, pushConstants, pushConstantSize);
+        vkCmdDispatchIndirect(commandBuffer, args.buffer, args.offset + argsOffset);
+    }
+
+    void GpuPrimitives::computeBarrier(VkCommandBuffer commandBuffer) {
+        VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    VkDeviceSize GpuPrimitives::align(VkDeviceSize size) const {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    GpuBufferRange GpuPrimitives::subRange(const GpuBufferRange& range, VkDeviceSize offset, VkDeviceSize size) {
+        return {range.buffer, range.offset + offset, size};
+    }
+
+    // ------------------------------------------------------------------ Scan
+
+    // Block totals of this level, then the scratch of scanning them
+    VkDeviceSize GpuPrimitives::getScanScratchSize(uint32_t count) const {
+        uint32_t blocks = std::max(blockCount(count), 1u);
+        VkDeviceSize size = align(sizeof(uint32_t) * blocks);
+        return blocks > 1 ? size + getScanScratchSize(blocks) : size;
+    }
+
+    void GpuPrimitives::scan(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, ScanType type,
+                             const GpuBufferRange& input, const GpuBufferRange& output, uint32_t count,
+                             const GpuBufferRange& scratch) {
+        if (count == 0) return;
+        recordScan(commandBuffer, descriptors, input, output, count, type == ScanType::Inclusive, false, scratch);
+    }
+
+    void GpuPrimitives::recordScan(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors,
+                                   const GpuBufferRange& input, const GpuBufferRange& output, uint32_t count,
+                                   bool inclusive, bool predicate, const GpuBufferRange& scratch,
+                                   const GpuBufferRange* indirectArgs, uint32_t level) {
+        const uint32_t blocks = blockCount(count);
+        const VkDeviceSize sumsSize = align(sizeof(uint32_t) * blocks);
+        const GpuBufferRange blockSums = subRange(scratch, 0, sumsSize);
+
+        // Indirect scans dispatch only the blocks holding real elements. The
+        // stale ones past them are never scanned, and an exclusive scan of
+        // the leading elements does not depend on what follows them.
+        ScanParams params{count, inclusive ? 1u : 0u, predicate ? 1u : 0u};
+        if (indirectArgs) {
+            dispatchIndirect(commandBuffer, descriptors, scanBlocks, {input, output, blockSums}, &params, sizeof(params),
+                             *indirectArgs, scanDispatchOffset(level));
+        } else {
+            dispatch(commandBuffer, descriptors, scanBlocks, {input, output, blockSums}, &params, sizeof(params), blocks);
+        }
+        if (blocks == 1) return;
+
+        // Scan the block totals in place into per-block offsets, then add them
+        computeBarrier(commandBuffer);
+        recordScan(commandBuffer, descriptors, blockSums, blockSums, blocks, false, false,
+                   subRange(scratch, sumsSize, getScanScratchSize(blocks)), indirectArgs, level + 1);
+        computeBarrier(commandBuffer);
+        if (indirectArgs) {
+            dispatchIndirect(commandBuffer, descriptors, scanAdd, {output, blockSums}, &count, sizeof(count),
+                             *indirectArgs, scanDispatchOffset(level));
+        } else {
+            dispatch(commandBuffer, descriptors, scanAdd, {output, blockSums}, &count, sizeof(count), blocks);
+        }
+    }
+
+    // ------------------------------------------------------------ Compaction
+
+    VkDeviceSize GpuPrimitives::getCompactScratchSize(uint32_t count) const {
+        return align(sizeof(uint32_t) * std::max(count, 1u)) + getScanScratchSize(count);
+    }
+
+    void GpuPrimitives::compact(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors,
+                                const GpuBufferRange& input, const GpuBufferRange& flags, uint32_t count, uint32_t elementWords,
+                                const GpuBufferRange& output, const GpuBufferRange& outputCount,
+                                const GpuBufferRange& scratch) {
+        if (count == 0) {
+            vkCmdFillBuffer(commandBuffer, outputCount.buffer, outputCount.offset, sizeof(uint32_t), 0);
+            return;
+        }
+
+        const VkDeviceSize offsetsSize = align(sizeof(uint32_t) * count);
+        const GpuBufferRange offsets = subRange(scratch, 0, offsetsSize);
+        recordScan(commandBuffer, descriptors, flags, offsets, count, false, true,
+                   subRange(scratch, offsetsSize, getScanScratchSize(count)));
+        computeBarrier(commandBuffer);
+
+        CompactParams params{count, std::max(elementWords, 1u)};
+        dispatch(commandBuffer, descriptors, compactScatter, {input, flags, offsets, output, outputCount},
+                 &params, sizeof(params), (count + 255) / 256);
+    }
+
+    // ------------------------------------------------------- Segmented reduce
+
+    void GpuPrimitives::segmentedReduce(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, ReduceOp op,
+                                        const GpuBufferRange& values, const GpuBufferRange& segmentOffsets, uint32_t segmentCount,
+                                        const GpuBufferRange& output) {
+        if (segmentCount == 0) return;
+
+        ReduceParams params{segmentCount, static_cast<uint32_t>(op)};
+        dispatch(commandBuffer, descriptors, segmentedReduceKernel, {values, segmentOffsets, output},
+                 &params, sizeof(params), std::min(segmentCount, MAX_REDUCE_GROUPS));
+    }
+
+    // ------------------------------------------------------------ Radix sort
+
+    // Ping-pong keys and values, the digit histograms, their scan and the
+    // indirect arguments
+    VkDeviceSize GpuPrimitives::getRadixSortScratchSize(uint32_t count, uint32_t keyWords) const {
+        const uint32_t tiles = std::max(blockCount(count), 1u);
+        return align(sizeof(uint32_t) * keyWords * std::max(count, 1u)) +
+               align(sizeof(uint32_t) * std::max(count, 1u)) +
+               align(sizeof(uint32_t) * RADIX_BINS * tiles) +
+               getScanScratchSize(RADIX_BINS * tiles) +
+               align(RADIX_ARGS_SIZE);
+    }
+
+    void GpuPrimitives::radixSort(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors,
+                                  const GpuBufferRange& keys, const GpuBufferRange& values, uint32_t count,
+                                  uint32_t keyWords, uint32_t keyBits, const GpuBufferRange& scratch) {
+        if (count <= 1) return;
+        recordRadixSort(commandBuffer, descriptors, keys, values, count, keyWords, keyBits, scratch, nullptr, 0);
+    }
+
+    void GpuPrimitives::radixSortIndirect(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors,
+                                          const GpuBufferRange& keys, const GpuBufferRange& values,
+                                          const GpuBufferRange& count, uint32_t countWord, uint32_t maxCount,
+                                          uint32_t keyWords, uint32_t keyBits, const GpuBufferRange& scratch) {
+        if (maxCount <= 1) return;
+        recordRadixSort(commandBuffer, descriptors, keys, values, maxCount, keyWords, keyBits, scratch, &count, countWord);
+    }
+
+    void GpuPrimitives::recordRadixSort(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors,
+                                        const GpuBufferRange& keys, const GpuBufferRange& values, uint32_t count,
+                                        uint32_t keyWords, uint32_t keyBits, const GpuBufferRange& scratch,
+                                        const GpuBufferRange* indirectCount, uint32_t countWord) {
+        keyWords = std::clamp(keyWords, 1u, 2u);
+        if (keyBits == 0 || keyBits > 32 * keyWords) keyBits = 32 * keyWords;
+
+        // Sized for count; an indirect sort uses the leading part of each range
+        const uint32_t tiles = blockCount(count);
+        const uint32_t histogramCount = RADIX_BINS * tiles;
+        const VkDeviceSize keysSize = align(sizeof(uint32_t) * keyWords * count);
+        const VkDeviceSize valuesSize = align(sizeof(uint32_t) * count);
+        const VkDeviceSize histogramSize = align(sizeof(uint32_t) * histogramCount);
+        const VkDeviceSize scanScratchSize = getScanScratchSize(histogramCount);
+
+        const GpuBufferRange alternateKeys = subRange(scratch, 0, keysSize);
+        const GpuBufferRange alternateValues = subRange(scratch, keysSize, valuesSize);
+        const GpuBufferRange histograms = subRange(scratch, keysSize + valuesSize, histogramSize);
+        const GpuBufferRange scanScratch = subRange(scratch, keysSize + valuesSize + histogramSize, scanScratchSize);
+        const GpuBufferRange args = subRange(scratch, keysSize + valuesSize + histogramSize + scanScratchSize, align(RADIX_ARGS_SIZE));
+
+        const bool indirect = indirectCount != nullptr;
+        if (indirect) {
+            RadixArgsParams argsParams{countWord, count, scanLevels(histogramCount)};
+            dispatch(commandBuffer, descriptors, radixArgs, {*indirectCount, args}, &argsParams, sizeof(argsParams), 1);
+            indirectArgsBarrier(commandBuffer);
+        }
+
+        // An even pass count leaves the result back in keys and values
+        uint32_t passes = (keyBits + 7) / 8;
+        passes += passes & 1u;
+
+        for (uint32_t pass = 0; pass < passes; pass++) {
+            const bool fromOriginal = (pass & 1u) == 0;
+            const GpuBufferRange& keysIn = fromOriginal ? keys : alternateKeys;
+            const GpuBufferRange& valuesIn = fromOriginal ? values : alternateValues;
+            const GpuBufferRange& keysOut = fromOriginal ? alternateKeys : keys;
+            const GpuBufferRange& valuesOut = fromOriginal ? alternateValues : values;
+
+            RadixParams params{count, keyWords, pass / 4, (pass % 4) * 8, tiles, indirect ? 1u : 0u};
+            if (pass > 0) computeBarrier(commandBuffer);
+            if (indirect) {
+                dispatchIndirect(commandBuffer, descriptors, radixHistogram, {keysIn, histograms, args}, &params, sizeof(params),
+                                 args, sizeof(uint32_t) * RADIX_ARGS_TILE_DISPATCH);
+            } else {
+                dispatch(commandBuffer, descriptors, radixHistogram, {keysIn, histograms, args}, &params, sizeof(params), tiles);
+            }
+            computeBarrier(commandBuffer);
+            recordScan(commandBuffer, descriptors, histograms, histograms, histogramCount, false, false, scanScratch,
+                       indirect ? &args : nullptr);
+            computeBarrier(commandBuffer);
+            if (indirect) {
+                dispatchIndirect(commandBuffer, descriptors, radixScatter, {keysIn, valuesIn, keysOut, valuesOut, histograms, args},
+                                 &params, sizeof(params), args, sizeof(uint32_t) * RADIX_ARGS_TILE_DISPATCH);
+            } else {
+                dispatch(commandBuffer, descriptors, radixScatter, {keysIn, valuesIn, keysOut, valuesOut, histograms, args},
+                         &params, sizeof(params), tiles);
+            }
+        }
+    }
+}
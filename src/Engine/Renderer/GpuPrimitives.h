@@ -0,0 +1,143 @@
+#pragma once
+
+#include "VulkanDevice.h"
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    class DescriptorAllocator;
+
+    // Part of a storage buffer. offset must respect the device's
+    // minStorageBufferOffsetAlignment.
+    struct GpuBufferRange {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize range = VK_WHOLE_SIZE;
+    };
+
+    // Reusable compute building blocks over 32-bit words in any storage
+    // buffers: prefix scan, stream compaction, segmented reduction and a
+    // stable key-value radix sort.
+    //
+    // Each call records its dispatches into the given command buffer and
+    // allocates its descriptor sets from the given allocator, so sets live
+    // as long as the allocator's frame (use the renderer's frame allocator
+    // while recording a frame). Barriers between a primitive's own passes
+    // are recorded; the caller orders its inputs before and its outputs
+    // after the call, as for any compute dispatch.
+    //
+    // Scratch is caller-owned: pass a range of at least the matching
+    // get*ScratchSize() bytes. It may be reused once the call's work has
+    // finished on the GPU.
+    class GpuPrimitives {
+    public:
+        enum class ScanType { Exclusive, Inclusive };
+        enum class ReduceOp : uint32_t { Add = 0, Min = 1, Max = 2 };
+
+        explicit GpuPrimitives(VulkanDevice* device);
+        ~GpuPrimitives();
+
+        GpuPrimitives(const GpuPrimitives&) = delete;
+        GpuPrimitives& operator=(const GpuPrimitives&) = delete;
+
+        VkDeviceSize getScanScratchSize(uint32_t count) const;
+        VkDeviceSize getCompactScratchSize(uint32_t count) const;
+        VkDeviceSize getRadixSortScratchSize(uint32_t count, uint32_t keyWords) const;
+
+        // uint32 sums of input into output, which may be the same range
+        void scan(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, ScanType type,
+                  const GpuBufferRange& input, const GpuBufferRange& output, uint32_t count,
+                  const GpuBufferRange& scratch);
+
+        // Copies the elements (elementWords words each) whose flag is nonzero
+        // to output in input order and writes how many there were to
+        // outputCount (one uint32)
+        void compact(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors,
+                     const GpuBufferRange& input, const GpuBufferRange& flags, uint32_t count, uint32_t elementWords,
+                     const GpuBufferRange& output, const GpuBufferRange& outputCount,
+                     const GpuBufferRange& scratch);
+
+        // output[s] = values[segmentOffsets[s]] op ... op values[segmentOffsets[s + 1] - 1];
+        // segmentOffsets holds segmentCount + 1 ascending entries
+        void segmentedReduce(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, ReduceOp op,
+                             const GpuBufferRange& values, const GpuBufferRange& segmentOffsets, uint32_t segmentCount,
+                             const GpuBufferRange& output);
+
+        // Sorts keys ascending, moving one uint32 value with each key. Keys
+        // are keyWords (1 or 2) words each, least significant word first, so
+        // 64-bit keys are plain uint64_t arrays. Only the low keyBits bits are
+        // compared (0 for all of them); fewer bits means fewer 8-bit passes.
+        // Equal keys keep their input order.
+        void radixSort(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors,
+                       const GpuBufferRange& keys, const GpuBufferRange& values, uint32_t count,
+                       uint32_t keyWords, uint32_t keyBits, const GpuBufferRange& scratch);
+
+        // Same, for a count only the GPU knows: word countWord of count (e.g.
+        // the instanceCount of an indirect draw command it wrote), clamped to
+        // maxCount. The passes are dispatched indirectly for that count, so
+        // the cost follows it rather than maxCount. Scratch is sized for
+        // maxCount and must also have VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT.
+        void radixSortIndirect(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors,
+                               const GpuBufferRange& keys, const GpuBufferRange& values,
+                               const GpuBufferRange& count, uint32_t countWord, uint32_t maxCount,
+                               uint32_t keyWords, uint32_t keyBits, const GpuBufferRange& scratch);
+
+        // Compute-to-compute barrier for chaining primitives
+        static void computeBarrier(VkCommandBuffer commandBuffer);
+
+        // Elements per workgroup of the scan and radix passes
+        static constexpr uint32_t BLOCK_SIZE = 1024;
+
+    private:
+        struct Kernel {
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            VkPipelineLayout layout = VK_NULL_HANDLE;
+            VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+            uint32_t bindingCount = 0;
+        };
+
+        // Every kernel takes at most this many bytes of push constants
+        static constexpr uint32_t PUSH_CONSTANT_SIZE = 32;
+
+        void createKernel(Kernel& kernel, const std::string& shaderFile, uint32_t bindingCount);
+        void bind(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, const Kernel& kernel,
+                  std::initializer_list<GpuBufferRange> buffers, const void* pushConstants, uint32_t pushConstantSize);
+        void dispatch(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, const Kernel& kernel,
+                      std::initializer_list<GpuBufferRange> buffers, const void* pushConstants, uint32_t pushConstantSize,
+                      uint32_t groupCount);
+        // Group counts from a VkDispatchIndirectCommand at argsOffset of args
+        void dispatchIndirect(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, const Kernel& kernel,
+                              std::initializer_list<GpuBufferRange> buffers, const void* pushConstants, uint32_t pushConstantSize,
+                              const GpuBufferRange& args, VkDeviceSize argsOffset);
+        // With indirectArgs, each level's group count is read from the
+        // arguments primitive_radix_args.comp wrote, and count only bounds
+        // the dispatch (see radixSortIndirect)
+        void recordScan(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors,
+                        const GpuBufferRange& input, const GpuBufferRange& output, uint32_t count,
+                        bool inclusive, bool predicate, const GpuBufferRange& scratch,
+                        const GpuBufferRange* indirectArgs = nullptr, uint32_t level = 0);
+        // count is the element count, or the maximum one with indirectCount
+        void recordRadixSort(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors,
+                             const GpuBufferRange& keys, const GpuBufferRange& values, uint32_t count,
+                             uint32_t keyWords, uint32_t keyBits, const GpuBufferRange& scratch,
+                             const GpuBufferRange* indirectCount, uint32_t countWord);
+
+        VkDeviceSize align(VkDeviceSize size) const;
+        // Sub-range of scratch, which must already be aligned
+        static GpuBufferRange subRange(const GpuBufferRange& range, VkDeviceSize offset, VkDeviceSize size);
+
+        VulkanDevice* device;
+        VkDeviceSize alignment;
+
+        Kernel scanBlocks;
+        Kernel scanAdd;
+        Kernel compactScatter;
+        Kernel segmentedReduceKernel;
+        Kernel radixHistogram;
+        Kernel radixScatter;
+        Kernel radixArgs;
+    };
+}
@@ -0,0 +1,52 @@
+#include "InstanceStreams.h"
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace AhnrealEngine {
+
+    static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+        return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+    }
+
+    InstanceStreamLayout InstanceStreamLayout::compute(uint32_t capacity, VkDeviceSize alignment) {
+        InstanceStreamLayout layout;
+        layout.capacity = capacity;
+        layout.positionScaleOffset = 0;
+        layout.rotationOffset = alignUp(layout.positionScaleOffset + layout.positionScaleRange(), alignment);
+        layout.radiusOffset = alignUp(layout.rotationOffset + layout.rotationRange(), alignment);
+        layout.size = layout.radiusOffset + layout.radiusRange();
+        return layout;
+    }
+
+    void InstanceStreams::resize(uint32_t count) {
+        positionScale.resize(count, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+        rotation.resize(count, packRotation(glm::quat(1.0f, 0.0f, 0.0f, 0.0f)));
+        radius.resize(count, 0.0f);
+    }
+
+    void InstanceStreams::set(uint32_t index, const InstanceTransform& transform, float localRadius) {
+        positionScale[index] = glm::vec4(transform.position, transform.scale);
+        rotation[index] = packRotation(transform.rotation);
+        radius[index] = localRadius * transform.scale;
+    }
+
+    void InstanceStreams::write(void* mapped, const InstanceStreamLayout& layout) const {
+        uint32_t count = std::min(size(), layout.capacity);
+        char* base = static_cast<char*>(mapped);
+        std::memcpy(base + layout.positionScaleOffset, positionScale.data(), count * InstanceStreamLayout::POSITION_SCALE_STRIDE);
+        std::memcpy(base + layout.rotationOffset, rotation.data(), count * InstanceStreamLayout::ROTATION_STRIDE);
+        std::memcpy(base + layout.radiusOffset, radius.data(), count * InstanceStreamLayout::RADIUS_STRIDE);
+    }
+
+    glm::uvec2 InstanceStreams::packRotation(const glm::quat& rotation) {
+        glm::quat q = glm::normalize(rotation);
+        return glm::uvec2(glm::packSnorm2x16(glm::vec2(q.x, q.y)), glm::packSnorm2x16(glm::vec2(q.z, q.w)));
+    }
+
+    glm::quat InstanceStreams::unpackRotation(const glm::uvec2& packed) {
+        glm::vec2 xy = glm::unpackSnorm2x16(packed.x);
+        glm::vec2 zw = glm::unpackSnorm2x16(packed.y);
+        return glm::normalize(glm::quat(zw.y, xy.x, xy.y, zw.x));
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    // Instance placement as authored: translation, rotation and uniform scale
+    struct InstanceTransform {
+        glm::vec3 position{0.0f};
+        glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+        float scale = 1.0f;
+    };
+
+    // Byte offsets of each stream inside one buffer. Streams start on the
+    // device's storage buffer offset alignment so each can be bound on its own.
+    struct InstanceStreamLayout {
+        uint32_t capacity = 0;
+        VkDeviceSize positionScaleOffset = 0;
+        VkDeviceSize rotationOffset = 0;
+        VkDeviceSize radiusOffset = 0;
+        VkDeviceSize size = 0;
+
+        VkDeviceSize positionScaleRange() const { return capacity * POSITION_SCALE_STRIDE; }
+        VkDeviceSize rotationRange() const { return capacity * ROTATION_STRIDE; }
+        VkDeviceSize radiusRange() const { return capacity * RADIUS_STRIDE; }
+
+        static constexpr VkDeviceSize POSITION_SCALE_STRIDE = sizeof(glm::vec4);
+        static constexpr VkDeviceSize ROTATION_STRIDE = sizeof(glm::uvec2);
+        static constexpr VkDeviceSize RADIUS_STRIDE = sizeof(float);
+
+        static InstanceStreamLayout compute(uint32_t capacity, VkDeviceSize alignment);
+    };
+
+    // CPU side of the compact instance format, stored as structure of arrays
+    // so each GPU pass reads only the streams it needs (28 bytes per instance
+    // in total, against 64 for a matrix):
+    //   positionScale  vec4   xyz translation, w uniform scale   (cull, vertex)
+    //   rotation       uvec2  unit quaternion as 4 x snorm16     (vertex)
+    //   radius         float  bounding sphere around the translation (cull)
+    // Decoding lives in cull.comp and the instance vertex shaders.
+    class InstanceStreams {
+    public:
+        void resize(uint32_t count);
+        uint32_t size() const { return static_cast<uint32_t>(positionScale.size()); }
+
+        // localRadius bounds the mesh around its origin (Mesh::getBoundingRadius)
+        void set(uint32_t index, const InstanceTransform& transform, float localRadius);
+
+        // Copies every stream to its offset in a mapped buffer
+        void write(void* mapped, const InstanceStreamLayout& layout) const;
+
+        // Quaternion (x, y, z, w) packed as two snorm16x2 words, matching
+        // unpackSnorm2x16 in GLSL
+        static glm::uvec2 packRotation(const glm::quat& rotation);
+        static glm::quat unpackRotation(const glm::uvec2& packed);
+
+    private:
+        std::vector<glm::vec4> positionScale;
+        std::vector<glm::uvec2> rotation;
+        std::vector<float> radius;
+    };
+}
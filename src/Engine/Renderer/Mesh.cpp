@@ -1,15 +1,20 @@
 #include "Mesh.h"
+#include "Meshlet.h"
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <stdexcept>
 
 namespace AhnrealEngine {
 
-VkVertexInputBindingDescription Vertex::getBindingDescription() {
-  VkVertexInputBindingDescription bindingDescription{};
-  bindingDescription.binding = 0;
-  bindingDescription.stride = sizeof(Vertex);
-  bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-  return bindingDescription;
+std::vector<VkVertexInputBindingDescription> Vertex::getBindingDescriptions() {
+  std::vector<VkVertexInputBindingDescription> bindingDescriptions(2);
+  bindingDescriptions[0] = getPositionBindingDescription();
+
+  bindingDescriptions[1].binding = ATTRIBUTE_BINDING;
+  bindingDescriptions[1].stride = sizeof(VertexAttributes);
+  bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+  return bindingDescriptions;
 }
 
 std::vector<VkVertexInputAttributeDescription>
@@ -17,64 +22,112 @@ Vertex::getAttributeDescriptions() {
   std::vector<VkVertexInputAttributeDescription> attributeDescriptions(5);
 
   // Position
-  attributeDescriptions[0].binding = 0;
-  attributeDescriptions[0].location = 0;
-  attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-  attributeDescriptions[0].offset = offsetof(Vertex, position);
+  attributeDescriptions[0] = getPositionAttributeDescription();
 
   // Normal
-  attributeDescriptions[1].binding = 0;
+  attributeDescriptions[1].binding = ATTRIBUTE_BINDING;
   attributeDescriptions[1].location = 1;
   attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-  attributeDescriptions[1].offset = offsetof(Vertex, normal);
+  attributeDescriptions[1].offset = offsetof(VertexAttributes, normal);
 
   // TexCoord
-  attributeDescriptions[2].binding = 0;
+  attributeDescriptions[2].binding = ATTRIBUTE_BINDING;
   attributeDescriptions[2].location = 2;
   attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-  attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
+  attributeDescriptions[2].offset = offsetof(VertexAttributes, texCoord);
   
   // Tangent
-  attributeDescriptions[3].binding = 0;
+  attributeDescriptions[3].binding = ATTRIBUTE_BINDING;
   attributeDescriptions[3].location = 3;
   attributeDescriptions[3].format = VK_FORMAT_R32G32B32_SFLOAT;
-  attributeDescriptions[3].offset = offsetof(Vertex, tangent);
+  attributeDescriptions[3].offset = offsetof(VertexAttributes, tangent);
 
   // Bitangent
-  attributeDescriptions[4].binding = 0;
+  attributeDescriptions[4].binding = ATTRIBUTE_BINDING;
   attributeDescriptions[4].location = 4;
   attributeDescriptions[4].format = VK_FORMAT_R32G32B32_SFLOAT;
-  attributeDescriptions[4].offset = offsetof(Vertex, bitangent);
+  attributeDescriptions[4].offset = offsetof(VertexAttributes, bitangent);
 
   return attributeDescriptions;
 }
 
+VkVertexInputBindingDescription Vertex::getPositionBindingDescription() {
+  VkVertexInputBindingDescription bindingDescription{};
+  bindingDescription.binding = POSITION_BINDING;
+  bindingDescription.stride = sizeof(glm::vec3);
+  bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+  return bindingDescription;
+}
+
+VkVertexInputAttributeDescription Vertex::getPositionAttributeDescription() {
+  VkVertexInputAttributeDescription attributeDescription{};
+  attributeDescription.binding = POSITION_BINDING;
+  attributeDescription.location = 0;
+  attributeDescription.format = VK_FORMAT_R32G32B32_SFLOAT;
+  attributeDescription.offset = 0;
+  return attributeDescription;
+}
+
 Mesh::Mesh(VulkanDevice *device, const std::vector<Vertex> &vertices,
-           const std::vector<uint32_t> &indices)
+           const std::vector<uint32_t> &indices, bool buildMeshlets)
     : device(device) {
-  createVertexBuffer(vertices);
+  if (!vertices.empty()) {
+    bounds.min = bounds.max = vertices[0].position;
+  }
+  for (const Vertex &vertex : vertices) {
+    boundingRadius = std::max(boundingRadius, glm::length(vertex.position));
+    bounds.min = glm::min(bounds.min, vertex.position);
+    bounds.max = glm::max(bounds.max, vertex.position);
+  }
+  // Sphere around the box center; tighter than the origin-centered radius
+  // for meshes modeled away from their origin
+  glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+  float radius = 0.0f;
+  for (const Vertex &vertex : vertices) {
+    radius = std::max(radius, glm::length(vertex.position - center));
+  }
+  bounds.sphere = glm::vec4(center, radius);
+  createVertexBuffers(vertices);
   createIndexBuffer(indices);
+
+  if (buildMeshlets && !indices.empty()) {
+    meshlets = std::make_unique<MeshletBuffers>(
+        device, MeshletData::build(vertices, indices));
+  }
 }
 
 Mesh::~Mesh() {
+  meshlets.reset();
+
   if (indexBuffer != VK_NULL_HANDLE) {
     vkDestroyBuffer(device->device(), indexBuffer, nullptr);
     vkFreeMemory(device->device(), indexBufferMemory, nullptr);
   }
 
-  if (vertexBuffer != VK_NULL_HANDLE) {
-    vkDestroyBuffer(device->device(), vertexBuffer, nullptr);
-    vkFreeMemory(device->device(), vertexBufferMemory, nullptr);
+  if (positionBuffer != VK_NULL_HANDLE) {
+    vkDestroyBuffer(device->device(), positionBuffer, nullptr);
+    vkFreeMemory(device->device(), positionBufferMemory, nullptr);
+  }
+
+  if (attributeBuffer != VK_NULL_HANDLE) {
+    vkDestroyBuffer(device->device(), attributeBuffer, nullptr);
+    vkFreeMemory(device->device(), attributeBufferMemory, nullptr);
   }
 }
 
 Mesh::Mesh(Mesh &&other) noexcept
-    : device(other.device), vertexBuffer(other.vertexBuffer),
-      vertexBufferMemory(other.vertexBufferMemory),
+    : device(other.device), positionBuffer(other.positionBuffer),
+      positionBufferMemory(other.positionBufferMemory),
+      attributeBuffer(other.attributeBuffer),
+      attributeBufferMemory(other.attributeBufferMemory),
       vertexCount(other.vertexCount), indexBuffer(other.indexBuffer),
-      indexBufferMemory(other.indexBufferMemory), indexCount(other.indexCount) {
-  other.vertexBuffer = VK_NULL_HANDLE;
-  other.vertexBufferMemory = VK_NULL_HANDLE;
+      indexBufferMemory(other.indexBufferMemory), indexCount(other.indexCount),
+      boundingRadius(other.boundingRadius), bounds(other.bounds),
+      meshlets(std::move(other.meshlets)) {
+  other.positionBuffer = VK_NULL_HANDLE;
+  other.positionBufferMemory = VK_NULL_HANDLE;
+  other.attributeBuffer = VK_NULL_HANDLE;
+  other.attributeBufferMemory = VK_NULL_HANDLE;
   other.indexBuffer = VK_NULL_HANDLE;
   other.indexBufferMemory = VK_NULL_HANDLE;
   other.vertexCount = 0;
@@ -88,16 +141,23 @@ Mesh &Mesh::operator=(Mesh &&other) noexcept {
 
     // Move resources
     device = other.device;
-    vertexBuffer = other.vertexBuffer;
-    vertexBufferMemory = other.vertexBufferMemory;
+    positionBuffer = other.positionBuffer;
+    positionBufferMemory = other.positionBufferMemory;
+    attributeBuffer = other.attributeBuffer;
+    attributeBufferMemory = other.attributeBufferMemory;
     vertexCount = other.vertexCount;
     indexBuffer = other.indexBuffer;
     indexBufferMemory = other.indexBufferMemory;
     indexCount = other.indexCount;
+    boundingRadius = other.boundingRadius;
+    bounds = other.bounds;
+    meshlets = std::move(other.meshlets);
 
     // Invalidate other
-    other.vertexBuffer = VK_NULL_HANDLE;
-    other.vertexBufferMemory = VK_NULL_HANDLE;
+    other.positionBuffer = VK_NULL_HANDLE;
+    other.positionBufferMemory = VK_NULL_HANDLE;
+    other.attributeBuffer = VK_NULL_HANDLE;
+    other.attributeBufferMemory = VK_NULL_HANDLE;
     other.indexBuffer = VK_NULL_HANDLE;
     other.indexBufferMemory = VK_NULL_HANDLE;
     other.vertexCount = 0;
@@ -107,51 +167,64 @@ Mesh &Mesh::operator=(Mesh &&other) noexcept {
 }
 
 void Mesh::draw(VkCommandBuffer commandBuffer) {
-  VkBuffer vertexBuffers[] = {vertexBuffer};
-  VkDeviceSize offsets[] = {0};
-  vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+  bind(commandBuffer);
+  drawInstanced(commandBuffer, 1, 0);
+}
+
+void Mesh::bind(VkCommandBuffer commandBuffer, VertexStreams streams) {
+  VkBuffer vertexBuffers[] = {positionBuffer, attributeBuffer};
+  VkDeviceSize offsets[] = {0, 0};
+  uint32_t bindingCount = streams == VertexStreams::PositionOnly ? 1 : 2;
+  vkCmdBindVertexBuffers(commandBuffer, Vertex::POSITION_BINDING, bindingCount,
+                         vertexBuffers, offsets);
 
   if (indexCount > 0) {
     vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-    vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+  }
+}
+
+void Mesh::drawInstanced(VkCommandBuffer commandBuffer, uint32_t instanceCount,
+                         uint32_t firstInstance) {
+  if (indexCount > 0) {
+    vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, 0, 0,
+                     firstInstance);
   } else {
-    vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+    vkCmdDraw(commandBuffer, vertexCount, instanceCount, 0, firstInstance);
   }
 }
 
-void Mesh::createVertexBuffer(const std::vector<Vertex> &vertices) {
+void Mesh::createVertexBuffers(const std::vector<Vertex> &vertices) {
   vertexCount = static_cast<uint32_t>(vertices.size());
-  VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
-
-  VkBuffer stagingBuffer;
-  VkDeviceMemory stagingBufferMemory;
-  device->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                           VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                       stagingBuffer, stagingBufferMemory);
-
-  void *data;
-  vkMapMemory(device->device(), stagingBufferMemory, 0, bufferSize, 0, &data);
-  memcpy(data, vertices.data(), (size_t)bufferSize);
-  vkUnmapMemory(device->device(), stagingBufferMemory);
-
-  device->createBuffer(
-      bufferSize,
-      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
-
-  device->copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
+  if (vertexCount == 0) return;
+
+  std::vector<glm::vec3> positions(vertexCount);
+  std::vector<VertexAttributes> attributes(vertexCount);
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    positions[i] = vertices[i].position;
+    attributes[i] = {vertices[i].normal, vertices[i].texCoord,
+                     vertices[i].tangent, vertices[i].bitangent};
+  }
 
-  vkDestroyBuffer(device->device(), stagingBuffer, nullptr);
-  vkFreeMemory(device->device(), stagingBufferMemory, nullptr);
+  const VkBufferUsageFlags usage =
+      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+  uploadBuffer(positions.data(), sizeof(positions[0]) * vertexCount, usage,
+               positionBuffer, positionBufferMemory);
+  uploadBuffer(attributes.data(), sizeof(attributes[0]) * vertexCount, usage,
+               attributeBuffer, attributeBufferMemory);
 }
 
 void Mesh::createIndexBuffer(const std::vector<uint32_t> &indices) {
   indexCount = static_cast<uint32_t>(indices.size());
   if (indexCount == 0) return;
 
-  VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;
+  uploadBuffer(indices.data(), sizeof(indices[0]) * indexCount,
+               VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexBuffer,
+               indexBufferMemory);
+}
 
+void Mesh::uploadBuffer(const void *source, VkDeviceSize bufferSize,
+                        VkBufferUsageFlags usage, VkBuffer &buffer,
+                        VkDeviceMemory &memory) {
   VkBuffer stagingBuffer;
   VkDeviceMemory stagingBufferMemory;
   device->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
@@ -161,15 +234,13 @@ void Mesh::createIndexBuffer(const std::vector<uint32_t> &indices) {
 
   void *data;
   vkMapMemory(device->device(), stagingBufferMemory, 0, bufferSize, 0, &data);
-  memcpy(data, indices.data(), (size_t)bufferSize);
+  memcpy(data, source, (size_t)bufferSize);
   vkUnmapMemory(device->device(), stagingBufferMemory);
 
-  device->createBuffer(
-      bufferSize,
-      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+  device->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
+                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory);
 
-  device->copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+  device->copyBuffer(stagingBuffer, buffer, bufferSize);
 
   vkDestroyBuffer(device->device(), stagingBuffer, nullptr);
   vkFreeMemory(device->device(), stagingBufferMemory, nullptr);
@@ -2,11 +2,15 @@
 
 #include "VulkanDevice.h"
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 #include <vulkan/vulkan.h>
 
 namespace AhnrealEngine {
 
+// Vertex as imported. On the GPU a mesh keeps it as two streams: tightly
+// packed positions (binding 0, 12 bytes) and VertexAttributes (binding 1),
+// so depth-only passes fetch positions alone.
 struct Vertex {
   glm::vec3 position;
   glm::vec3 normal;
@@ -14,15 +18,45 @@ struct Vertex {
   glm::vec3 tangent;
   glm::vec3 bitangent;
 
-  static VkVertexInputBindingDescription getBindingDescription();
+  static constexpr uint32_t POSITION_BINDING = 0;
+  static constexpr uint32_t ATTRIBUTE_BINDING = 1;
+
+  // Both streams, locations 0-4 as in the fields above
+  static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
   static std::vector<VkVertexInputAttributeDescription>
   getAttributeDescriptions();
+
+  // Position stream only (location 0), for depth-only pipelines
+  static VkVertexInputBindingDescription getPositionBindingDescription();
+  static VkVertexInputAttributeDescription getPositionAttributeDescription();
+};
+
+// Everything but the position, 44 bytes per vertex
+struct VertexAttributes {
+  glm::vec3 normal;
+  glm::vec2 texCoord;
+  glm::vec3 tangent;
+  glm::vec3 bitangent;
 };
 
+// Vertex streams a draw binds
+enum class VertexStreams { All, PositionOnly };
+
+// Mesh-space bounds, filled from the vertices when the mesh is created
+struct MeshBounds {
+  glm::vec3 min{0.0f};
+  glm::vec3 max{0.0f};
+  glm::vec4 sphere{0.0f}; // xyz center (of the box), w radius
+};
+
+class MeshletBuffers;
+
 class Mesh {
 public:
+  // buildMeshlets also splits the mesh into meshlets for cluster culling
+  // (see Meshlet.h). Both vertex streams are readable as storage buffers.
   Mesh(VulkanDevice *device, const std::vector<Vertex> &vertices,
-       const std::vector<uint32_t> &indices);
+       const std::vector<uint32_t> &indices, bool buildMeshlets = false);
   ~Mesh();
 
   // Disable copying to prevent double-free of Vulkan resources
@@ -35,23 +69,47 @@ public:
 
   void draw(VkCommandBuffer commandBuffer);
 
-    VkBuffer getVertexBuffer() const { return vertexBuffer; }
+  // Split form of draw() so several draws can share one bind
+  void bind(VkCommandBuffer commandBuffer,
+            VertexStreams streams = VertexStreams::All);
+  void drawInstanced(VkCommandBuffer commandBuffer, uint32_t instanceCount,
+                     uint32_t firstInstance);
+
+    VkBuffer getPositionBuffer() const { return positionBuffer; }
+    VkBuffer getAttributeBuffer() const { return attributeBuffer; }
     VkBuffer getIndexBuffer() const { return indexBuffer; }
     uint32_t getIndexCount() const { return indexCount; }
+    // Radius of the smallest origin-centered sphere containing every vertex
+    float getBoundingRadius() const { return boundingRadius; }
+    const MeshBounds& getBounds() const { return bounds; }
+    uint32_t getVertexCount() const { return vertexCount; }
+    // Null unless the mesh was built with meshlets
+    const MeshletBuffers* getMeshlets() const { return meshlets.get(); }
 
 private:
-  void createVertexBuffer(const std::vector<Vertex> &vertices);
+  void createVertexBuffers(const std::vector<Vertex> &vertices);
   void createIndexBuffer(const std::vector<uint32_t> &indices);
+  // Device-local copy of data through a staging buffer
+  void uploadBuffer(const void *data, VkDeviceSize size,
+                    VkBufferUsageFlags usage, VkBuffer &buffer,
+                    VkDeviceMemory &memory);
 
   VulkanDevice *device;
 
-  VkBuffer vertexBuffer = VK_NULL_HANDLE;
-  VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
+  VkBuffer positionBuffer = VK_NULL_HANDLE;
+  VkDeviceMemory positionBufferMemory = VK_NULL_HANDLE;
+  VkBuffer attributeBuffer = VK_NULL_HANDLE;
+  VkDeviceMemory attributeBufferMemory = VK_NULL_HANDLE;
   uint32_t vertexCount = 0;
 
   VkBuffer indexBuffer = VK_NULL_HANDLE;
   VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
   uint32_t indexCount = 0;
+
+  float boundingRadius = 0.0f;
+  MeshBounds bounds;
+
+  std::unique_ptr<MeshletBuffers> meshlets;
 };
 
 } // namespace AhnrealEngine
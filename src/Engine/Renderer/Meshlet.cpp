@@ -0,0 +1,172 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace AhnrealEngine {
+
+    static MeshletBounds computeBounds(const Meshlet& meshlet, const MeshletData& data, const std::vector<Vertex>& vertices) {
+        // Sphere around the AABB center; not minimal, but cheap and stable
+        glm::vec3 minPos(std::numeric_limits<float>::max());
+        glm::vec3 maxPos(-std::numeric_limits<float>::max());
+        for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+            const glm::vec3& p = vertices[data.vertices[meshlet.vertexOffset + i]].position;
+            minPos = glm::min(minPos, p);
+            maxPos = glm::max(maxPos, p);
+        }
+        glm::vec3 center = (minPos + maxPos) * 0.5f;
+        float radius = 0.0f;
+        for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+            radius = std::max(radius, glm::length(vertices[data.vertices[meshlet.vertexOffset + i]].position - center));
+        }
+
+        // Face normals from positions; vertex normals may be smoothed across
+        // the silhouette and would make the cone too narrow
+        std::vector<glm::vec3> normals;
+        normals.reserve(meshlet.triangleCount);
+        glm::vec3 normalSum(0.0f);
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+            uint32_t packed = data.triangles[meshlet.triangleOffset + t];
+            const glm::vec3& a = vertices[data.vertices[meshlet.vertexOffset + (packed & 0xFF)]].position;
+            const glm::vec3& b = vertices[data.vertices[meshlet.vertexOffset + ((packed >> 8) & 0xFF)]].position;
+            const glm::vec3& c = vertices[data.vertices[meshlet.vertexOffset + ((packed >> 16) & 0xFF)]].position;
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float length = glm::length(n);
+            if (length > 0.0f) {
+                normals.push_back(n / length);
+                normalSum += n / length;
+            }
+        }
+
+        MeshletBounds bounds;
+        bounds.sphere = glm::vec4(center, radius);
+        bounds.cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        float sumLength = glm::length(normalSum);
+        if (sumLength > 0.0f) {
+            glm::vec3 axis = normalSum / sumLength;
+            float minDot = 1.0f;
+            for (const glm::vec3& n : normals) {
+                minDot = std::min(minDot, glm::dot(axis, n));
+            }
+            // Normals spread over (almost) a hemisphere leave nothing to cull.
+            // Otherwise cutoff = sin(spread angle), see MeshletBounds.
+            float cutoff = minDot <= 0.1f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+            bounds.cone = glm::vec4(axis, cutoff);
+        }
+        return bounds;
+    }
+
+    MeshletData MeshletData::build(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                                   uint32_t maxVertices, uint32_t maxTriangles) {
+        MeshletData data;
+        data.triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+        // Mesh vertex -> local index in the meshlet being built
+        constexpr uint32_t UNUSED = UINT32_MAX;
+        std::vector<uint32_t> localIndex(vertices.size(), UNUSED);
+        Meshlet current{0, 0, 0, 0};
+
+        auto flush = [&]() {
+            if (current.triangleCount == 0) return;
+            for (uint32_t i = 0; i < current.vertexCount; i++) {
+                localIndex[data.vertices[current.vertexOffset + i]] = UNUSED;
+            }
+            data.meshlets.push_back(current);
+            data.bounds.push_back(computeBounds(current, data, vertices));
+            current = {static_cast<uint32_t>(data.vertices.size()), static_cast<uint32_t>(data.triangles.size()), 0, 0};
+        };
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const uint32_t corners[3] = {indices[i], indices[i + 1], indices[i + 2]};
+
+            uint32_t newVertices = 0;
+            for (int c = 0; c < 3; c++) {
+                bool seen = localIndex[corners[c]] != UNUSED ||
+                            (c > 0 && corners[c] == corners[0]) || (c > 1 && corners[c] == corners[1]);
+                if (!seen) newVertices++;
+            }
+            if (current.vertexCount + newVertices > maxVertices || current.triangleCount + 1 > maxTriangles) {
+                flush();
+            }
+
+            uint32_t packed = 0;
+            for (int c = 0; c < 3; c++) {
+                uint32_t& local = localIndex[corners[c]];
+                if (local == UNUSED) {
+                    local = current.vertexCount++;
+                    data.vertices.push_back(corners[c]);
+                }
+                packed |= local << (8 * c);
+            }
+            data.triangles.push_back(packed);
+            current.triangleCount++;
+        }
+        flush();
+
+        return data;
+    }
+
+    MeshletBuffers::MeshletBuffers(VulkanDevice* device, const MeshletData& data)
+        : device(device),
+          meshletCount(static_cast<uint32_t>(data.meshlets.size())),
+          triangleCount(data.triangleCount) {
+        if (meshletCount == 0) return;
+
+        // Expanded indices for the vertex shader path, in meshlet order
+        std::vector<uint32_t> indices;
+        indices.reserve(data.triangles.size() * 3);
+        for (const Meshlet& meshlet : data.meshlets) {
+            for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+                uint32_t packed = data.triangles[meshlet.triangleOffset + t];
+                for (int c = 0; c < 3; c++) {
+                    indices.push_back(data.vertices[meshlet.vertexOffset + ((packed >> (8 * c)) & 0xFF)]);
+                }
+            }
+        }
+
+        meshletBuffer = upload(data.meshlets.data(), sizeof(Meshlet) * data.meshlets.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        boundsBuffer = upload(data.bounds.data(), sizeof(MeshletBounds) * data.bounds.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        vertexIndexBuffer = upload(data.vertices.data(), sizeof(uint32_t) * data.vertices.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        triangleBuffer = upload(data.triangles.data(), sizeof(uint32_t) * data.triangles.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        // Also a copy source, for index buffers that extend it
+        indexBuffer = upload(indices.data(), sizeof(uint32_t) * indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    }
+
+    MeshletBuffers::~MeshletBuffers() {
+        destroy(meshletBuffer);
+        destroy(boundsBuffer);
+        destroy(vertexIndexBuffer);
+        destroy(triangleBuffer);
+        destroy(indexBuffer);
+    }
+
+    MeshletBuffers::DeviceBuffer MeshletBuffers::upload(const void* data, VkDeviceSize size, VkBufferUsageFlags usage) {
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        device->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer, stagingBufferMemory);
+
+        void* mapped;
+        vkMapMemory(device->device(), stagingBufferMemory, 0, size, 0, &mapped);
+        std::memcpy(mapped, data, static_cast<size_t>(size));
+        vkUnmapMemory(device->device(), stagingBufferMemory);
+
+        DeviceBuffer result;
+        device->createBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, result.buffer, result.memory);
+        device->copyBuffer(stagingBuffer, result.buffer, size);
+
+        vkDestroyBuffer(device->device(), stagingBuffer, nullptr);
+        vkFreeMemory(device->device(), stagingBufferMemory, nullptr);
+        return result;
+    }
+
+    void MeshletBuffers::destroy(DeviceBuffer& buffer) {
+        if (buffer.buffer != VK_NULL_HANDLE) vkDestroyBuffer(device->device(), buffer.buffer, nullptr);
+        if (buffer.memory != VK_NULL_HANDLE) vkFreeMemory(device->device(), buffer.memory, nullptr);
+        buffer = {};
+    }
+}
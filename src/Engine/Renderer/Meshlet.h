@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Mesh.h"
+#include "VulkanDevice.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    // A small cluster of a mesh's triangles. Vertices are referenced through
+    // MeshletData::vertices, triangles through MeshletData::triangles.
+    struct Meshlet {
+        uint32_t vertexOffset;   // First entry in MeshletData::vertices
+        uint32_t triangleOffset; // First entry in MeshletData::triangles
+        uint32_t vertexCount;
+        uint32_t triangleCount;
+    };
+
+    // Culling data per meshlet, in mesh space:
+    //   sphere  xyz center, w radius
+    //   cone    xyz axis (average face normal), w cutoff
+    // The meshlet faces away from every viewer at cameraPosition when
+    //   dot(center - cameraPosition, axis) >= cutoff * length(center - cameraPosition) + radius
+    // A cutoff of 1 disables the cone test.
+    struct MeshletBounds {
+        glm::vec4 sphere;
+        glm::vec4 cone;
+    };
+
+    // Common mesh shader output sizes (64 vertices, 124 triangles fit every
+    // vendor's preferred limits)
+    constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+    constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+    struct MeshletData {
+        std::vector<Meshlet> meshlets;
+        std::vector<MeshletBounds> bounds;
+        std::vector<uint32_t> vertices;  // Mesh vertex index per meshlet vertex
+        std::vector<uint32_t> triangles; // Meshlet-local indices, 8 bits each: a | b << 8 | c << 16
+        uint32_t triangleCount = 0;
+
+        // Splits an indexed triangle list greedily in index order, so meshes
+        // with good vertex locality produce compact meshlets
+        static MeshletData build(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                                 uint32_t maxVertices = MESHLET_MAX_VERTICES,
+                                 uint32_t maxTriangles = MESHLET_MAX_TRIANGLES);
+    };
+
+    // Device copies of MeshletData for cluster culling. Alongside the
+    // storage buffers read by mesh shaders, indexBuffer holds the same
+    // triangles as plain mesh indices in meshlet order, so meshlet i can be
+    // drawn with vkCmdDrawIndexed(triangleCount * 3, ..., triangleOffset * 3).
+    class MeshletBuffers {
+    public:
+        MeshletBuffers(VulkanDevice* device, const MeshletData& data);
+        ~MeshletBuffers();
+
+        MeshletBuffers(const MeshletBuffers&) = delete;
+        MeshletBuffers& operator=(const MeshletBuffers&) = delete;
+
+        VkBuffer getMeshletBuffer() const { return meshletBuffer.buffer; }
+        VkBuffer getBoundsBuffer() const { return boundsBuffer.buffer; }
+        VkBuffer getVertexIndexBuffer() const { return vertexIndexBuffer.buffer; }
+        VkBuffer getTriangleBuffer() const { return triangleBuffer.buffer; }
+        VkBuffer getIndexBuffer() const { return indexBuffer.buffer; }
+
+        uint32_t getMeshletCount() const { return meshletCount; }
+        uint32_t getTriangleCount() const { return triangleCount; }
+
+    private:
+        struct DeviceBuffer {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+        };
+
+        DeviceBuffer upload(const void* data, VkDeviceSize size, VkBufferUsageFlags usage);
+        void destroy(DeviceBuffer& buffer);
+
+        VulkanDevice* device;
+        DeviceBuffer meshletBuffer;
+        DeviceBuffer boundsBuffer;
+        DeviceBuffer vertexIndexBuffer;
+        DeviceBuffer triangleBuffer;
+        DeviceBuffer indexBuffer;
+        uint32_t meshletCount = 0;
+        uint32_t triangleCount = 0;
+    };
+}
@@ -1,10 +1,25 @@
 #include "Model.h"
+#include "../Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 
 namespace AhnrealEngine {
 
-Model::Model(VulkanDevice *device, const std::string &path) : device(device) {
+Model::Model(VulkanDevice *device, const std::string &path, bool buildMeshlets)
+    : device(device), buildMeshlets(buildMeshlets) {
+  if (JobSystem *jobs = JobSystem::get()) {
+    sceneGraph.setParallelFor(
+        [jobs](uint32_t count, const SceneGraph::RangeFunction &function) {
+          jobs->parallelFor(count, function);
+        });
+    instanceBvh.setParallelFor(
+        [jobs](uint32_t count,
+               const BoundingVolumeHierarchy::RangeFunction &function) {
+          jobs->parallelFor(count, function, 1);
+        });
+  }
   loadModel(path);
 }
 
@@ -12,12 +27,142 @@ Model::~Model() {
     // Meshes are managed by unique_ptr, so they will be automatically cleaned up.
 }
 
-void Model::draw(VkCommandBuffer commandBuffer) {
-  for (const auto &mesh : meshes) {
-    mesh->draw(commandBuffer);
+void Model::draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout,
+                 VkShaderStageFlags pushConstantStages,
+                 VertexStreams streams) {
+  // Picks up any local transform edits made since the last draw
+  updateTransforms();
+
+  for (uint32_t m = 0; m < meshes.size(); m++) {
+    meshes[m]->bind(commandBuffer, streams);
+    const InstanceRange &range = instanceRanges[m];
+    for (uint32_t i = range.first; i < range.first + range.count; i++) {
+      const glm::mat4 &world = sceneGraph.getWorldTransform(instances[i].node);
+      vkCmdPushConstants(commandBuffer, layout, pushConstantStages, 0,
+                         sizeof(glm::mat4), &world);
+      meshes[m]->drawInstanced(commandBuffer, 1, 0);
+    }
   }
 }
 
+glm::vec4 Model::getWorldSphere(uint32_t instance) const {
+  // The radius is scaled by the largest axis scale of the world matrix
+  const glm::mat4 &world = sceneGraph.getWorldTransform(instances[instance].node);
+  const glm::vec4 &sphere = meshes[instances[instance].meshIndex]->getBounds().sphere;
+  float scaleSquared = std::max({glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+                                 glm::dot(glm::vec3(world[1]), glm::vec3(world[1])),
+                                 glm::dot(glm::vec3(world[2]), glm::vec3(world[2]))});
+  glm::vec3 center = glm::vec3(world * glm::vec4(glm::vec3(sphere), 1.0f));
+  return glm::vec4(center, sphere.w * std::sqrt(scaleSquared));
+}
+
+void Model::updateTransforms() {
+  if (sceneGraph.updateWorldTransforms() > 0) {
+    instancesMoved = true;
+  }
+}
+
+void Model::updateInstanceBvh() {
+  if (!instancesMoved) return;
+  instancesMoved = false;
+
+  // World-space boxes around the transformed local boxes (Arvo's method)
+  instanceBounds.resize(instances.size());
+  for (uint32_t i = 0; i < instances.size(); i++) {
+    const MeshBounds &bounds = meshes[instances[i].meshIndex]->getBounds();
+    const glm::vec3 localCenter = (bounds.min + bounds.max) * 0.5f;
+    const glm::vec3 halfExtent = (bounds.max - bounds.min) * 0.5f;
+    const glm::mat4 &world = sceneGraph.getWorldTransform(instances[i].node);
+    glm::vec3 center = glm::vec3(world * glm::vec4(localCenter, 1.0f));
+    glm::vec3 extent = glm::abs(glm::vec3(world[0])) * halfExtent.x +
+                       glm::abs(glm::vec3(world[1])) * halfExtent.y +
+                       glm::abs(glm::vec3(world[2])) * halfExtent.z;
+    instanceBounds[i].min = center - extent;
+    instanceBounds[i].max = center + extent;
+  }
+
+  // Instances are fixed after loading, so moves never need a rebuild
+  if (instanceBvh.empty()) {
+    instanceBvh.build(instanceBounds.data(),
+                      static_cast<uint32_t>(instanceBounds.size()));
+  } else {
+    instanceBvh.refit(instanceBounds.data());
+    instanceBvh.optimize();
+  }
+}
+
+uint32_t Model::draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout,
+                     VkShaderStageFlags pushConstantStages,
+                     const Frustum &frustum, const OcclusionBuffer *occlusion,
+                     VertexStreams streams) {
+  updateTransforms();
+  updateInstanceBvh();
+
+  visibleInstances.clear();
+  instanceBvh.queryFrustum(frustum, visibleInstances);
+  cullVisible.assign(instances.size(), 0);
+  for (uint32_t i : visibleInstances) {
+    cullVisible[i] = 1;
+  }
+
+  uint32_t drawn = 0;
+  for (uint32_t m = 0; m < meshes.size(); m++) {
+    const InstanceRange &range = instanceRanges[m];
+    bool bound = false;
+
+    for (uint32_t i = range.first; i < range.first + range.count; i++) {
+      if (!cullVisible[i]) continue;
+      if (occlusion && occlusion->isOccluded(instanceBounds[i].min, instanceBounds[i].max)) continue;
+
+      if (!bound) {
+        meshes[m]->bind(commandBuffer, streams);
+        bound = true;
+      }
+      const glm::mat4 &world = sceneGraph.getWorldTransform(instances[i].node);
+      vkCmdPushConstants(commandBuffer, layout, pushConstantStages, 0,
+                         sizeof(glm::mat4), &world);
+      meshes[m]->drawInstanced(commandBuffer, 1, 0);
+      drawn++;
+    }
+  }
+  return drawn;
+}
+
+uint32_t Model::addOccluders(OcclusionBuffer &occlusion, const Frustum &frustum,
+                             const glm::vec3 &cameraPosition,
+                             uint32_t triangleBudget) {
+  updateTransforms();
+  updateInstanceBvh();
+
+  // Projected size is roughly radius / distance
+  visibleInstances.clear();
+  instanceBvh.queryFrustum(frustum, visibleInstances);
+  occluderCandidates.clear();
+  for (uint32_t i : visibleInstances) {
+    glm::vec4 sphere = getWorldSphere(i);
+    float distance = glm::length(glm::vec3(sphere) - cameraPosition);
+    occluderCandidates.push_back({sphere.w / std::max(distance, 1e-3f), i});
+  }
+  std::sort(occluderCandidates.begin(), occluderCandidates.end(),
+            [](const std::pair<float, uint32_t> &a,
+               const std::pair<float, uint32_t> &b) { return a.first > b.first; });
+
+  uint32_t occluderCount = 0;
+  for (const auto &candidate : occluderCandidates) {
+    const MeshInstance &instance = instances[candidate.second];
+    const OccluderMesh &geometry = occluderMeshes[instance.meshIndex];
+    uint32_t triangleCount = static_cast<uint32_t>(geometry.indices.size() / 3);
+    if (triangleCount > triangleBudget) continue;
+
+    occlusion.addOccluder(geometry.positions.data(), geometry.indices.data(),
+                          static_cast<uint32_t>(geometry.indices.size()),
+                          sceneGraph.getWorldTransform(instance.node));
+    triangleBudget -= triangleCount;
+    occluderCount++;
+  }
+  return occluderCount;
+}
+
 void Model::loadModel(const std::string &path) {
   Assimp::Importer importer;
   // Presets: Triangulate, FlipUVs for Vulkan/OpenGL, CalcTangentSpace for normal mapping
@@ -41,19 +186,61 @@ void Model::loadModel(const std::string &path) {
       if (directory == path) directory = "";
   }
 
-  processNode(scene->mRootNode, scene);
+  importedMeshIndices.assign(scene->mNumMeshes, UINT32_MAX);
+  processNode(scene->mRootNode, scene, INVALID_NODE);
+  buildInstanceRanges();
+  sceneGraph.updateWorldTransforms();
+
+  std::cout << "Loaded model " << path << ": " << meshes.size()
+            << " unique meshes, " << instances.size() << " instances"
+            << std::endl;
 }
 
-void Model::processNode(aiNode *node, const aiScene *scene) {
-  // Process all meshes at this node
+void Model::buildInstanceRanges() {
+  // Group instances by mesh so each mesh's instances are contiguous
+  std::stable_sort(instances.begin(), instances.end(),
+                   [](const MeshInstance &a, const MeshInstance &b) {
+                     return a.meshIndex < b.meshIndex;
+                   });
+
+  instanceRanges.assign(meshes.size(), InstanceRange{});
+  for (uint32_t i = 0; i < instances.size(); i++) {
+    InstanceRange &range = instanceRanges[instances[i].meshIndex];
+    if (range.count == 0) {
+      range.first = i;
+    }
+    range.count++;
+  }
+}
+
+void Model::processNode(aiNode *node, const aiScene *scene, NodeHandle parent) {
+  // aiMatrix4x4 is row-major, GLM is column-major
+  const aiMatrix4x4 &m = node->mTransformation;
+  glm::mat4 localTransform(m.a1, m.b1, m.c1, m.d1,
+                           m.a2, m.b2, m.c2, m.d2,
+                           m.a3, m.b3, m.c3, m.d3,
+                           m.a4, m.b4, m.c4, m.d4);
+  NodeHandle handle = sceneGraph.createNode(parent, localTransform);
+  if (parent == INVALID_NODE) {
+    rootNode = handle;
+  }
+
+  // Each aiMesh is uploaded the first time a node references it; later
+  // references only add an instance
   for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-    aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-    meshes.push_back(std::make_unique<Mesh>(processMesh(mesh, scene)));
+    unsigned int sceneMeshIndex = node->mMeshes[i];
+    uint32_t &meshIndex = importedMeshIndices[sceneMeshIndex];
+    if (meshIndex == UINT32_MAX) {
+      meshIndex = static_cast<uint32_t>(meshes.size());
+      meshes.push_back(std::make_unique<Mesh>(
+          processMesh(scene->mMeshes[sceneMeshIndex], scene)));
+    }
+    instances.push_back({meshIndex, handle});
   }
 
   // Recursively process children
   for (unsigned int i = 0; i < node->mNumChildren; i++) {
-    processNode(node->mChildren[i], scene);
+    processNode(node->mChildren[i], scene, handle);
   }
 }
 
@@ -102,7 +289,15 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene) {
 
   // TODO: Process materials here
 
-  return Mesh(device, vertices, indices);
+  OccluderMesh occluder;
+  occluder.positions.reserve(vertices.size());
+  for (const Vertex &vertex : vertices) {
+    occluder.positions.push_back(vertex.position);
+  }
+  occluder.indices = indices;
+  occluderMeshes.push_back(std::move(occluder));
+
+  return Mesh(device, vertices, indices, buildMeshlets);
 }
 
 } // namespace AhnrealEngine
@@ -2,18 +2,32 @@
 
 #include "Mesh.h"
 #include "VulkanDevice.h"
+#include "../Scene/BoundingVolumeHierarchy.h"
+#include "../Scene/SceneGraph.h"
+#include "../Core/Frustum.h"
+#include "../Core/OcclusionBuffer.h"
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace AhnrealEngine {
 
+// One node's reference to a mesh. Several instances may share a mesh; its
+// GPU buffers exist only once.
+struct MeshInstance {
+  uint32_t meshIndex;
+  NodeHandle node;
+};
+
 class Model {
 public:
-  Model(VulkanDevice *device, const std::string &path);
+  // buildMeshlets splits every mesh into meshlets on import (see Mesh)
+  Model(VulkanDevice *device, const std::string &path,
+        bool buildMeshlets = false);
   ~Model();
 
   // Prevent copying to avoid resource management issues
@@ -24,17 +38,94 @@ public:
   Model(Model&&) = default;
   Model& operator=(Model&&) = default;
 
-  void draw(VkCommandBuffer commandBuffer);
+  // Draws every instance with its node's world matrix pushed as a mat4 at
+  // offset 0 of the given layout's push constant range. Each mesh is bound
+  // once for all of its instances, with only the vertex streams asked for
+  // (positions alone for a depth pre-pass).
+  void draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout,
+            VkShaderStageFlags pushConstantStages,
+            VertexStreams streams = VertexStreams::All);
+
+  // Same, but skips instances whose world-space bounds lie outside the
+  // frustum, found through the instance BVH, then those the occlusion
+  // buffer hides if a rasterized one is given. Meshes with no visible
+  // instance aren't bound. Returns the number of instances drawn.
+  uint32_t draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout,
+                VkShaderStageFlags pushConstantStages, const Frustum &frustum,
+                const OcclusionBuffer *occlusion = nullptr,
+                VertexStreams streams = VertexStreams::All);
+
+  // Queues instances inside the frustum as occluders, largest on screen
+  // first, while they fit in triangleBudget. Call between
+  // OcclusionBuffer::begin() and rasterize(); the geometry is the model's
+  // CPU copy of its positions. Returns the number of occluder instances.
+  uint32_t addOccluders(OcclusionBuffer &occlusion, const Frustum &frustum,
+                        const glm::vec3 &cameraPosition,
+                        uint32_t triangleBudget);
 
+    // Unique meshes, one per aiMesh referenced by the file
     const std::vector<std::unique_ptr<Mesh>>& getMeshes() const { return meshes; }
 
+    // Node references, sorted by meshIndex. Instances of mesh m are
+    // instances[getFirstInstance(m) .. getFirstInstance(m) + getInstanceCount(m)).
+    const std::vector<MeshInstance>& getInstances() const { return instances; }
+    uint32_t getFirstInstance(uint32_t meshIndex) const { return instanceRanges[meshIndex].first; }
+    uint32_t getInstanceCount(uint32_t meshIndex) const { return instanceRanges[meshIndex].count; }
+
+    // Node hierarchy from the file
+    SceneGraph& getSceneGraph() { return sceneGraph; }
+    const SceneGraph& getSceneGraph() const { return sceneGraph; }
+    NodeHandle getRootNode() const { return rootNode; }
+
+    // World-space boxes of every instance, items indexed like instances.
+    // Built on the first culled draw and refit whenever nodes move.
+    const BoundingVolumeHierarchy& getInstanceBvh() const { return instanceBvh; }
+
 private:
+  struct InstanceRange {
+    uint32_t first = 0;
+    uint32_t count = 0;
+  };
+
   void loadModel(const std::string &path);
-  void processNode(aiNode *node, const aiScene *scene);
+  void processNode(aiNode *node, const aiScene *scene, NodeHandle parent);
+  void buildInstanceRanges();
   Mesh processMesh(aiMesh *mesh, const aiScene *scene);
+  // World-space bounding sphere (center, radius) of an instance
+  glm::vec4 getWorldSphere(uint32_t instance) const;
+  // Updates world matrices and notes whether any instance moved
+  void updateTransforms();
+  // Builds the instance BVH, or refits and rotates it after a move
+  void updateInstanceBvh();
+
+  // Positions and indices kept on the CPU for occlusion rasterization,
+  // indexed like meshes
+  struct OccluderMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+  };
 
   VulkanDevice *device;
+  bool buildMeshlets = false;
   std::vector<std::unique_ptr<Mesh>> meshes;
+  std::vector<MeshInstance> instances;
+  std::vector<InstanceRange> instanceRanges;
+
+  BoundingVolumeHierarchy instanceBvh;
+  std::vector<Aabb> instanceBounds;
+  bool instancesMoved = true;
+
+  // Per-instance culling scratch, reused across draws
+  std::vector<uint32_t> visibleInstances;
+  std::vector<uint8_t> cullVisible;
+  std::vector<std::pair<float, uint32_t>> occluderCandidates; // (score, instance)
+  std::vector<OccluderMesh> occluderMeshes;
+
+  // aiScene mesh index -> index into meshes, or UINT32_MAX if not built yet
+  std::vector<uint32_t> importedMeshIndices;
+
+  SceneGraph sceneGraph;
+  NodeHandle rootNode = INVALID_NODE;
   std::string directory;
 };
 
@@ -0,0 +1,182 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace AhnrealEngine {
+
+    namespace SortKey {
+
+        static constexpr uint64_t mask(uint32_t bits) { return (uint64_t(1) << bits) - 1; }
+
+        uint64_t make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t depth) {
+            return (uint64_t(pass) & mask(PASS_BITS)) << (PIPELINE_BITS + MATERIAL_BITS + DEPTH_BITS) |
+                   (uint64_t(pipeline) & mask(PIPELINE_BITS)) << (MATERIAL_BITS + DEPTH_BITS) |
+                   (uint64_t(material) & mask(MATERIAL_BITS)) << DEPTH_BITS |
+                   (uint64_t(depth) & mask(DEPTH_BITS));
+        }
+
+        uint32_t quantizeDepth(float viewDistance, float nearPlane, float farPlane, bool backToFront) {
+            float t = (viewDistance - nearPlane) / (farPlane - nearPlane);
+            t = std::clamp(t, 0.0f, 1.0f);
+            uint32_t depth = static_cast<uint32_t>(t * static_cast<float>(mask(DEPTH_BITS)));
+            return backToFront ? static_cast<uint32_t>(mask(DEPTH_BITS)) - depth : depth;
+        }
+
+        // 64-bit mix (splitmix64 finalizer) so nearby handle values spread out
+        static uint64_t mix(uint64_t x) {
+            x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+            x ^= x >> 27; x *= 0x94d049bb133111ebull;
+            x ^= x >> 31;
+            return x;
+        }
+
+        uint32_t pipelineId(VkPipeline pipeline) {
+            return static_cast<uint32_t>(mix((uint64_t)pipeline) & mask(PIPELINE_BITS));
+        }
+
+        uint32_t materialId(uint64_t handle) {
+            return static_cast<uint32_t>(mix(handle) & mask(MATERIAL_BITS));
+        }
+    }
+
+    void RenderQueue::submit(const DrawPacket& packet, const void* pushConstants, uint32_t pushConstantSize) {
+        PushConstantRange range{0, 0};
+        if (pushConstants && pushConstantSize > 0) {
+            range.offset = static_cast<uint32_t>(pushConstantData.size());
+            range.size = pushConstantSize;
+            const uint8_t* bytes = static_cast<const uint8_t*>(pushConstants);
+            pushConstantData.insert(pushConstantData.end(), bytes, bytes + pushConstantSize);
+        }
+
+        entries.push_back({packet.sortKey, static_cast<uint32_t>(packets.size())});
+        packets.push_back(packet);
+        pushConstantRanges.push_back(range);
+    }
+
+    void RenderQueue::sortEntries() {
+        // LSD radix sort, 8 bits per pass. Stable, so equal keys keep their
+        // submission order. Passes where every key shares the same byte are skipped.
+        constexpr uint32_t RADIX = 256;
+        const size_t count = entries.size();
+        scratch.resize(count);
+
+        std::array<std::array<uint32_t, RADIX>, 8> histograms{};
+        for (const auto& entry : entries) {
+            for (uint32_t pass = 0; pass < 8; pass++) {
+                histograms[pass][(entry.key >> (pass * 8)) & 0xFF]++;
+            }
+        }
+
+        for (uint32_t pass = 0; pass < 8; pass++) {
+            auto& histogram = histograms[pass];
+            uint32_t firstByte = (entries[0].key >> (pass * 8)) & 0xFF;
+            if (histogram[firstByte] == count) continue;
+
+            uint32_t sum = 0;
+            for (uint32_t i = 0; i < RADIX; i++) {
+                uint32_t c = histogram[i];
+                histogram[i] = sum;
+                sum += c;
+            }
+
+            for (const auto& entry : entries) {
+                scratch[histogram[(entry.key >> (pass * 8)) & 0xFF]++] = entry;
+            }
+            entries.swap(scratch);
+        }
+    }
+
+    void RenderQueue::flush(VkCommandBuffer commandBuffer) {
+        stats = Stats{};
+        if (packets.empty()) return;
+
+        sortEntries();
+
+        VkPipeline boundPipeline = VK_NULL_HANDLE;
+        VkPipelineLayout boundLayout = VK_NULL_HANDLE;
+        VkPipelineLayout pushLayout = VK_NULL_HANDLE;
+        VkShaderStageFlags pushStages = 0;
+        uint32_t pushOffset = 0;
+        VkDescriptorSet boundSet = VK_NULL_HANDLE;
+        VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+        VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+        VkIndexType boundIndexType = VK_INDEX_TYPE_UINT32;
+        PushConstantRange lastPush{0, 0};
+
+        uint32_t requestedBinds = 0;
+
+        for (const auto& entry : entries) {
+            const DrawPacket& packet = packets[entry.packetIndex];
+            const PushConstantRange& push = pushConstantRanges[entry.packetIndex];
+
+            if (packet.pipeline != VK_NULL_HANDLE) {
+                requestedBinds++;
+                if (packet.pipeline != boundPipeline) {
+                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, packet.pipeline);
+                    boundPipeline = packet.pipeline;
+                    stats.pipelineBinds++;
+                }
+            }
+
+            if (packet.descriptorSet != VK_NULL_HANDLE) {
+                requestedBinds++;
+                // A different layout may disturb set 0, so rebind even if the set is unchanged
+                if (packet.descriptorSet != boundSet || packet.pipelineLayout != boundLayout) {
+                    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, packet.pipelineLayout, 0, 1, &packet.descriptorSet, 0, nullptr);
+                    boundSet = packet.descriptorSet;
+                    boundLayout = packet.pipelineLayout;
+                    stats.descriptorBinds++;
+                }
+            }
+
+            if (packet.vertexBuffer != VK_NULL_HANDLE) {
+                requestedBinds++;
+                if (packet.vertexBuffer != boundVertexBuffer) {
+                    VkDeviceSize offset = 0;
+                    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &packet.vertexBuffer, &offset);
+                    boundVertexBuffer = packet.vertexBuffer;
+                    stats.vertexBufferBinds++;
+                }
+            }
+
+            if (packet.indexBuffer != VK_NULL_HANDLE) {
+                requestedBinds++;
+                if (packet.indexBuffer != boundIndexBuffer || packet.indexType != boundIndexType) {
+                    vkCmdBindIndexBuffer(commandBuffer, packet.indexBuffer, 0, packet.indexType);
+                    boundIndexBuffer = packet.indexBuffer;
+                    boundIndexType = packet.indexType;
+                    stats.indexBufferBinds++;
+                }
+            }
+
+            if (push.size > 0) {
+                requestedBinds++;
+                // Equal bytes only count if they land in the same range
+                bool samePush = push.size == lastPush.size && packet.pipelineLayout == pushLayout &&
+                    packet.pushConstantStages == pushStages && packet.pushConstantOffset == pushOffset &&
+                    std::memcmp(&pushConstantData[push.offset], &pushConstantData[lastPush.offset], push.size) == 0;
+                if (!samePush) {
+                    vkCmdPushConstants(commandBuffer, packet.pipelineLayout, packet.pushConstantStages, packet.pushConstantOffset,
+                                       push.size, &pushConstantData[push.offset]);
+                    pushLayout = packet.pipelineLayout;
+                    pushStages = packet.pushConstantStages;
+                    pushOffset = packet.pushConstantOffset;
+                    lastPush = push;
+                    stats.pushConstantUpdates++;
+                }
+            }
+
+            vkCmdDrawIndexed(commandBuffer, packet.indexCount, packet.instanceCount, packet.firstIndex, packet.vertexOffset, packet.firstInstance);
+            stats.draws++;
+        }
+
+        uint32_t issuedBinds = stats.pipelineBinds + stats.descriptorBinds + stats.vertexBufferBinds + stats.indexBufferBinds + stats.pushConstantUpdates;
+        stats.bindsSaved = requestedBinds - issuedBinds;
+
+        packets.clear();
+        pushConstantRanges.clear();
+        pushConstantData.clear();
+        entries.clear();
+    }
+}
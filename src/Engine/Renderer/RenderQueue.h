@@ -0,0 +1,106 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    // 64-bit draw sort key, compared as an unsigned integer:
+    //   [63:60] pass      - coarse ordering (opaque before transparent, ...)
+    //   [59:44] pipeline  - groups draws sharing a VkPipeline
+    //   [43:24] material  - groups draws sharing descriptor sets / buffers
+    //   [23:0]  depth     - front-to-back inside a group for early-Z
+    // Pipeline and material are identifiers, not handles; pipelineId() and
+    // materialId() fold handles into the available bits.
+    namespace SortKey {
+        constexpr uint32_t PASS_BITS = 4;
+        constexpr uint32_t PIPELINE_BITS = 16;
+        constexpr uint32_t MATERIAL_BITS = 20;
+        constexpr uint32_t DEPTH_BITS = 24;
+
+        uint64_t make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t depth);
+
+        // Quantizes view-space distance in [nearPlane, farPlane] to DEPTH_BITS.
+        // Pass backToFront for blended geometry to reverse the order.
+        uint32_t quantizeDepth(float viewDistance, float nearPlane, float farPlane, bool backToFront = false);
+
+        uint32_t pipelineId(VkPipeline pipeline);
+        uint32_t materialId(uint64_t handle);
+    }
+
+    // Everything needed to record one indexed draw. Null handles mean "no
+    // binding of that kind"; the previous state is kept.
+    struct DrawPacket {
+        uint64_t sortKey = 0;
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE; // Bound to set 0
+
+        VkBuffer vertexBuffer = VK_NULL_HANDLE;
+        VkBuffer indexBuffer = VK_NULL_HANDLE;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+
+        uint32_t indexCount = 0;
+        uint32_t instanceCount = 1;
+        uint32_t firstIndex = 0;
+        int32_t vertexOffset = 0;
+        uint32_t firstInstance = 0;
+
+        // Where the submitted push constant bytes go
+        VkShaderStageFlags pushConstantStages = 0;
+        uint32_t pushConstantOffset = 0;
+    };
+
+    // Per-frame list of draw packets. Scenes submit in any order; flush()
+    // radix-sorts by key and records the draws, skipping binds that would set
+    // state which is already current.
+    class RenderQueue {
+    public:
+        struct Stats {
+            uint32_t draws = 0;
+            uint32_t pipelineBinds = 0;
+            uint32_t descriptorBinds = 0;
+            uint32_t vertexBufferBinds = 0;
+            uint32_t indexBufferBinds = 0;
+            uint32_t pushConstantUpdates = 0;
+            uint32_t bindsSaved = 0; // Binds packets asked for that were skipped as already current
+        };
+
+        // pushConstants (optional) is copied, so it may point at a temporary
+        void submit(const DrawPacket& packet, const void* pushConstants = nullptr, uint32_t pushConstantSize = 0);
+
+        // Sorts and records every submitted packet, then clears the queue
+        void flush(VkCommandBuffer commandBuffer);
+
+        bool empty() const { return packets.empty(); }
+        size_t size() const { return packets.size(); }
+
+        // Counters of the most recent flush
+        const Stats& getStats() const { return stats; }
+
+    private:
+        struct SortEntry {
+            uint64_t key;
+            uint32_t packetIndex;
+        };
+
+        struct PushConstantRange {
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        void sortEntries();
+
+        std::vector<DrawPacket> packets;
+        std::vector<PushConstantRange> pushConstantRanges; // Parallel to packets
+        std::vector<uint8_t> pushConstantData;
+
+        std::vector<SortEntry> entries;
+        std::vector<SortEntry> scratch;
+
+        Stats stats;
+    };
+}
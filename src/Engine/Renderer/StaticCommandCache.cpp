@@ -0,0 +1,99 @@
+#include "StaticCommandCache.h"
+#include "VulkanRenderer.h"
+#include "VulkanSwapChain.h"
+#include <stdexcept>
+
+namespace AhnrealEngine {
+
+    StaticCommandCache::StaticCommandCache(VulkanDevice* device) : device{device} {
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        // Buffers are re-recorded individually, not per frame
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = device->findPhysicalQueueFamilies().graphicsFamily.value();
+
+        if (vkCreateCommandPool(device->device(), &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create static command pool!");
+        }
+    }
+
+    StaticCommandCache::~StaticCommandCache() {
+        freeEntries();
+        vkDestroyCommandPool(device->device(), commandPool, nullptr);
+    }
+
+    void StaticCommandCache::execute(VulkanRenderer* renderer, const RecordFunction& record) {
+        uint32_t swapChainImages = static_cast<uint32_t>(renderer->getSwapChain()->imageCount());
+        if (swapChainImages != imageCount) {
+            // Recreation waited for the device, so none of the old buffers is pending
+            freeEntries();
+            imageCount = swapChainImages;
+            allocateEntries(imageCount * VulkanSwapChain::MAX_FRAMES_IN_FLIGHT);
+        }
+
+        uint32_t frameIndex = static_cast<uint32_t>(renderer->getFrameIndex());
+        Entry& entry = entries[frameIndex * imageCount + renderer->getImageIndex()];
+
+        if (entry.dirty || entry.swapChainGeneration != renderer->getSwapChainGeneration()) {
+            VkCommandBufferInheritanceInfo inheritance = renderer->getSwapChainPassInheritance();
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+            beginInfo.pInheritanceInfo = &inheritance;
+
+            if (vkBeginCommandBuffer(entry.commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording static command buffer!");
+            }
+            // Dynamic state is not inherited from the primary
+            renderer->setSwapChainViewport(entry.commandBuffer);
+            record(entry.commandBuffer, frameIndex);
+            if (vkEndCommandBuffer(entry.commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record static command buffer!");
+            }
+
+            entry.dirty = false;
+            entry.swapChainGeneration = renderer->getSwapChainGeneration();
+            recordCount++;
+        }
+
+        vkCmdExecuteCommands(renderer->getCurrentCommandBuffer(), 1, &entry.commandBuffer);
+    }
+
+    void StaticCommandCache::markDirty() {
+        for (Entry& entry : entries) {
+            entry.dirty = true;
+        }
+    }
+
+    void StaticCommandCache::allocateEntries(uint32_t count) {
+        std::vector<VkCommandBuffer> commandBuffers(count);
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandPool = commandPool;
+        allocInfo.commandBufferCount = count;
+
+        if (vkAllocateCommandBuffers(device->device(), &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate static command buffers!");
+        }
+
+        entries.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            entries[i] = Entry{commandBuffers[i], 0, true};
+        }
+    }
+
+    void StaticCommandCache::freeEntries() {
+        if (entries.empty()) return;
+
+        std::vector<VkCommandBuffer> commandBuffers;
+        commandBuffers.reserve(entries.size());
+        for (const Entry& entry : entries) {
+            commandBuffers.push_back(entry.commandBuffer);
+        }
+        vkFreeCommandBuffers(device->device(), commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+        entries.clear();
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "VulkanDevice.h"
+#include <functional>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    class VulkanRenderer;
+
+    // Draw commands recorded once into secondary command buffers and replayed
+    // every frame. There is one buffer per (frame in flight, swap chain image)
+    // pair: the secondary inherits the image's framebuffer, and when a frame
+    // slot comes around its fence has been waited, so that slot's buffers are
+    // no longer pending and can be re-recorded without stalling.
+    //
+    // Buffers are re-recorded when the scene calls markDirty() (state baked
+    // into the commands changed) or when the swap chain was recreated.
+    class StaticCommandCache {
+    public:
+        // Records the draw; viewport and scissor are already set.
+        // frameIndex selects per-frame resources such as uniform buffers.
+        using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t frameIndex)>;
+
+        explicit StaticCommandCache(VulkanDevice* device);
+        ~StaticCommandCache();
+
+        StaticCommandCache(const StaticCommandCache&) = delete;
+        StaticCommandCache& operator=(const StaticCommandCache&) = delete;
+
+        // Replays the cached commands into the current frame, recording them
+        // first if needed. The swap chain pass must have been begun with
+        // VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+        void execute(VulkanRenderer* renderer, const RecordFunction& record);
+
+        void markDirty();
+
+        // Number of times a buffer was (re-)recorded
+        uint32_t getRecordCount() const { return recordCount; }
+
+    private:
+        struct Entry {
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            uint64_t swapChainGeneration = 0;
+            bool dirty = true;
+        };
+
+        void allocateEntries(uint32_t count);
+        void freeEntries();
+
+        VulkanDevice* device;
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+
+        std::vector<Entry> entries; // [frameIndex * imageCount + imageIndex]
+        uint32_t imageCount = 0;
+        uint32_t recordCount = 0;
+    };
+}
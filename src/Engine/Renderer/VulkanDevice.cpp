@@ -1,4 +1,5 @@
 #include "VulkanDevice.h"
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <set>
@@ -15,13 +16,18 @@ namespace AhnrealEngine {
         return VK_FALSE;
     }
 
-    VulkanDevice::VulkanDevice(VkInstance instance, VkSurfaceKHR surface) : instance{instance}, surface_{surface} {
+    VulkanDevice::VulkanDevice(VkInstance instance, VkSurfaceKHR surface)
+        : instance{instance}, surface_{surface}, ownerThread{std::this_thread::get_id()} {
         pickPhysicalDevice();
+        queryCapabilities();
         createLogicalDevice();
         createCommandPool();
     }
 
     VulkanDevice::~VulkanDevice() {
+        for (auto& [thread, pool] : threadCommandPools) {
+            vkDestroyCommandPool(device_, pool, nullptr);
+        }
         vkDestroyCommandPool(device_, commandPool, nullptr);
         vkDestroyDevice(device_, nullptr);
     }
@@ -52,6 +58,83 @@ namespace AhnrealEngine {
         std::cout << "Physical device: " << properties.deviceName << std::endl;
     }
 
+    void VulkanDevice::queryCapabilities() {
+        VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+        // Extension structs are only chained when the extension exists
+        bool meshShaderExtension = isExtensionAvailable(physicalDevice_, VK_EXT_MESH_SHADER_EXTENSION_NAME);
+        VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures{};
+        meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+        if (meshShaderExtension) {
+            indexingFeatures.pNext = &meshShaderFeatures;
+        }
+
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &indexingFeatures;
+        vkGetPhysicalDeviceFeatures2(physicalDevice_, &features2);
+
+        VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+        indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+        VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+        subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+        indexingProperties.pNext = &subgroupProperties;
+
+        VkPhysicalDeviceProperties2 properties2{};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &indexingProperties;
+        vkGetPhysicalDeviceProperties2(physicalDevice_, &properties2);
+
+        capabilities_.minStorageBufferOffsetAlignment = properties2.properties.limits.minStorageBufferOffsetAlignment;
+
+        const VkSubgroupFeatureFlags requiredSubgroupOps = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT;
+        capabilities_.subgroupArithmetic =
+            properties2.properties.apiVersion >= VK_API_VERSION_1_1 &&
+            (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+            (subgroupProperties.supportedOperations & requiredSubgroupOps) == requiredSubgroupOps;
+        capabilities_.subgroupSize = std::max(subgroupProperties.subgroupSize, 1u);
+
+        // Bindless needs runtime-sized, partially bound arrays that can be
+        // updated while a command buffer referencing the set is pending
+        capabilities_.descriptorIndexing =
+            (properties2.properties.apiVersion >= VK_API_VERSION_1_2 ||
+             isExtensionAvailable(physicalDevice_, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) &&
+            indexingFeatures.runtimeDescriptorArray &&
+            indexingFeatures.descriptorBindingPartiallyBound &&
+            indexingFeatures.shaderStorageBufferArrayNonUniformIndexing &&
+            indexingFeatures.shaderSampledImageArrayNonUniformIndexing &&
+            indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind &&
+            indexingFeatures.descriptorBindingSampledImageUpdateAfterBind;
+
+        if (capabilities_.descriptorIndexing) {
+            // Bindless bindings are visible to every stage, so the per-stage
+            // limits apply on top of the per-set ones
+            capabilities_.maxBindlessStorageBuffers = std::min(indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                                                               indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+            capabilities_.maxBindlessSampledImages = std::min(indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                                              indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+            capabilities_.maxBindlessSamplers = std::min(indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                                                         indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers);
+            capabilities_.maxBindlessResources = indexingProperties.maxPerStageUpdateAfterBindResources;
+        }
+
+        // Mesh shader SPIR-V needs 1.4, which is core from Vulkan 1.2
+        capabilities_.meshShader =
+            meshShaderExtension &&
+            properties2.properties.apiVersion >= VK_API_VERSION_1_2 &&
+            meshShaderFeatures.taskShader && meshShaderFeatures.meshShader;
+        capabilities_.drawIndirectCount = isExtensionAvailable(physicalDevice_, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        capabilities_.drawIndirectFirstInstance = features2.features.drawIndirectFirstInstance;
+        capabilities_.pipelineStatistics = features2.features.pipelineStatisticsQuery;
+
+        std::cout << "Descriptor indexing: " << (capabilities_.descriptorIndexing ? "supported" : "not supported") << std::endl;
+        std::cout << "Subgroup arithmetic: " << (capabilities_.subgroupArithmetic ? "supported" : "not supported")
+                  << " (size " << capabilities_.subgroupSize << ")" << std::endl;
+        std::cout << "Mesh shaders: " << (capabilities_.meshShader ? "supported" : "not supported") << std::endl;
+    }
+
     void VulkanDevice::createLogicalDevice() {
         QueueFamilyIndices indices = findQueueFamilies(physicalDevice_);
 
@@ -68,19 +151,55 @@ namespace AhnrealEngine {
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
-        VkPhysicalDeviceFeatures deviceFeatures{};
-        deviceFeatures.samplerAnisotropy = VK_TRUE;
-        deviceFeatures.multiDrawIndirect = VK_TRUE; // Enable Indirect Draw for GPU Instancing
+        VkPhysicalDeviceFeatures2 deviceFeatures{};
+        deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        deviceFeatures.features.samplerAnisotropy = VK_TRUE;
+        deviceFeatures.features.multiDrawIndirect = VK_TRUE; // Enable Indirect Draw for GPU Instancing
+        deviceFeatures.features.drawIndirectFirstInstance = capabilities_.drawIndirectFirstInstance ? VK_TRUE : VK_FALSE;
+        deviceFeatures.features.pipelineStatisticsQuery = capabilities_.pipelineStatistics ? VK_TRUE : VK_FALSE;
+
+        std::vector<const char*> enabledExtensions = deviceExtensions;
+
+        VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+        if (capabilities_.descriptorIndexing) {
+            indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+            indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+            indexingFeatures.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+            indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+            indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+            indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            deviceFeatures.pNext = &indexingFeatures;
+
+            if (isExtensionAvailable(physicalDevice_, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+                enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+            }
+        }
+
+        VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures{};
+        meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+        if (capabilities_.meshShader) {
+            meshShaderFeatures.taskShader = VK_TRUE;
+            meshShaderFeatures.meshShader = VK_TRUE;
+            meshShaderFeatures.pNext = deviceFeatures.pNext;
+            deviceFeatures.pNext = &meshShaderFeatures;
+            enabledExtensions.push_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+        }
+
+        if (capabilities_.drawIndirectCount) {
+            enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        }
 
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext = &deviceFeatures;
 
         createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
-        createInfo.pEnabledFeatures = &deviceFeatures;
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        createInfo.pEnabledFeatures = nullptr; // Passed through VkPhysicalDeviceFeatures2 in pNext
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 #ifdef DEBUG
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -96,9 +215,29 @@ namespace AhnrealEngine {
         vkGetDeviceQueue(device_, indices.graphicsFamily.value(), 0, &graphicsQueue_);
         vkGetDeviceQueue(device_, indices.presentFamily.value(), 0, &presentQueue_);
         vkGetDeviceQueue(device_, indices.computeFamily.value(), 0, &computeQueue_);
+
+        if (capabilities_.meshShader) {
+            vkCmdDrawMeshTasks_ = reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(vkGetDeviceProcAddr(device_, "vkCmdDrawMeshTasksEXT"));
+        }
+        if (capabilities_.drawIndirectCount) {
+            vkCmdDrawIndexedIndirectCount_ = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(device_, "vkCmdDrawIndexedIndirectCountKHR"));
+        }
+    }
+
+    void VulkanDevice::cmdDrawMeshTasks(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+        vkCmdDrawMeshTasks_(commandBuffer, groupCountX, groupCountY, groupCountZ);
+    }
+
+    void VulkanDevice::cmdDrawIndexedIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset,
+                                                   VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride) {
+        vkCmdDrawIndexedIndirectCount_(commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
     }
 
     void VulkanDevice::createCommandPool() {
+        commandPool = createGraphicsCommandPool();
+    }
+
+    VkCommandPool VulkanDevice::createGraphicsCommandPool() {
         QueueFamilyIndices queueFamilyIndices = findPhysicalQueueFamilies();
 
         VkCommandPoolCreateInfo poolInfo{};
@@ -106,9 +245,25 @@ namespace AhnrealEngine {
         poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
         poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
 
-        if (vkCreateCommandPool(device_, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+        VkCommandPool pool;
+        if (vkCreateCommandPool(device_, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
             throw std::runtime_error("failed to create command pool!");
         }
+        return pool;
+    }
+
+    VkCommandPool VulkanDevice::getThreadCommandPool() {
+        std::thread::id thread = std::this_thread::get_id();
+        if (thread == ownerThread) {
+            return commandPool;
+        }
+
+        std::lock_guard<std::mutex> lock(threadCommandPoolMutex);
+        auto it = threadCommandPools.find(thread);
+        if (it == threadCommandPools.end()) {
+            it = threadCommandPools.emplace(thread, createGraphicsCommandPool()).first;
+        }
+        return it->second;
     }
 
     bool VulkanDevice::isDeviceSuitable(VkPhysicalDevice device) {
@@ -175,6 +330,21 @@ namespace AhnrealEngine {
         return requiredExtensions.empty();
     }
 
+    bool VulkanDevice::isExtensionAvailable(VkPhysicalDevice device, const char* extensionName) {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        for (const auto& extension : availableExtensions) {
+            if (strcmp(extension.extensionName, extensionName) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     SwapChainSupportDetails VulkanDevice::querySwapChainSupport(VkPhysicalDevice device) {
         SwapChainSupportDetails details;
         vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface_, &details.capabilities);
@@ -231,6 +401,9 @@ namespace AhnrealEngine {
         if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
             throw std::runtime_error("failed to allocate buffer memory!");
         }
+        if (properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+            deviceLocalBytesAllocated.fetch_add(memRequirements.size, std::memory_order_relaxed);
+        }
 
         vkBindBufferMemory(device_, buffer, bufferMemory, 0);
     }
@@ -239,7 +412,7 @@ namespace AhnrealEngine {
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool = commandPool;
+        allocInfo.commandPool = getThreadCommandPool();
         allocInfo.commandBufferCount = 1;
 
         VkCommandBuffer commandBuffer;
@@ -261,10 +434,37 @@ namespace AhnrealEngine {
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = &commandBuffer;
 
-        vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(graphicsQueue_);
+        // Wait for this submission only; frames in flight on the same queue
+        // don't have to drain
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkFence fence;
+        if (vkCreateFence(device_, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create transfer fence!");
+        }
+
+        if (submitGraphics(1, &submitInfo, fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit transfer command buffer!");
+        }
+        vkWaitForFences(device_, 1, &fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(device_, fence, nullptr);
+
+        vkFreeCommandBuffers(device_, getThreadCommandPool(), 1, &commandBuffer);
+    }
+
+    VkResult VulkanDevice::submitGraphics(uint32_t submitCount, const VkSubmitInfo* submits, VkFence fence) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return vkQueueSubmit(graphicsQueue_, submitCount, submits, fence);
+    }
 
-        vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
+    VkResult VulkanDevice::present(const VkPresentInfoKHR& presentInfo) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return vkQueuePresentKHR(presentQueue_, &presentInfo);
+    }
+
+    void VulkanDevice::waitIdle() {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        vkDeviceWaitIdle(device_);
     }
 
     void VulkanDevice::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
@@ -309,6 +509,9 @@ namespace AhnrealEngine {
         if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
             throw std::runtime_error("failed to allocate image memory!");
         }
+        if (properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+            deviceLocalBytesAllocated.fetch_add(memRequirements.size, std::memory_order_relaxed);
+        }
 
         if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS) {
             throw std::runtime_error("failed to bind image memory!");
@@ -4,6 +4,10 @@
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <optional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace AhnrealEngine {
 
@@ -17,6 +21,34 @@ namespace AhnrealEngine {
         }
     };
 
+    // Optional device features detected at startup. Systems that depend on
+    // them check these flags and fall back to the classic path when unset.
+    struct DeviceCapabilities {
+        bool descriptorIndexing = false;
+        uint32_t maxBindlessStorageBuffers = 0;
+        uint32_t maxBindlessSampledImages = 0;
+        uint32_t maxBindlessSamplers = 0;
+        // Descriptors of all types one stage may access through update-after-bind sets
+        uint32_t maxBindlessResources = 0;
+
+        // Limits used when sub-allocating several descriptors from one buffer
+        VkDeviceSize minStorageBufferOffsetAlignment = 256;
+
+        // Compute shaders may use subgroup reductions and scans
+        // (GL_KHR_shader_subgroup_arithmetic)
+        bool subgroupArithmetic = false;
+        uint32_t subgroupSize = 1;
+
+        // VK_EXT_mesh_shader with task shaders
+        bool meshShader = false;
+        // VK_KHR_draw_indirect_count: GPU-written draw counts
+        bool drawIndirectCount = false;
+        // Indirect draws may start at a non-zero firstInstance
+        bool drawIndirectFirstInstance = false;
+        // Pipeline statistics queries, e.g. fragment shader invocations
+        bool pipelineStatistics = false;
+    };
+
     struct SwapChainSupportDetails {
         VkSurfaceCapabilitiesKHR capabilities;
         std::vector<VkSurfaceFormatKHR> formats;
@@ -36,6 +68,7 @@ namespace AhnrealEngine {
         VkQueue presentQueue() { return presentQueue_; }
         VkQueue computeQueue() { return computeQueue_; }
         VkCommandPool getCommandPool() { return commandPool; }
+        const DeviceCapabilities& capabilities() const { return capabilities_; }
 
         SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice_); }
         uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -43,17 +76,40 @@ namespace AhnrealEngine {
         VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
         void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+
+        // One-time transfer commands may be recorded on any thread, so scenes
+        // can upload while loading in the background. Threads other than the
+        // one that created the device record into their own transient pool.
         VkCommandBuffer beginSingleTimeCommands();
         void endSingleTimeCommands(VkCommandBuffer commandBuffer);
 
+        // Queue access must be externally synchronized once uploads can come
+        // from loading threads; every submit, present and device-wide wait
+        // goes through these
+        VkResult submitGraphics(uint32_t submitCount, const VkSubmitInfo* submits, VkFence fence);
+        VkResult present(const VkPresentInfoKHR& presentInfo);
+        void waitIdle();
+
         void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
         void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 
         void createImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-        
+
+        // Running total of device-local memory allocated through createBuffer
+        // and createImageWithInfo. Frees are not tracked; callers measure the
+        // difference across a span of work (e.g. a scene's initialize()).
+        uint64_t getDeviceLocalBytesAllocated() const { return deviceLocalBytesAllocated.load(std::memory_order_relaxed); }
+
+        // Extension commands, valid only when the matching capability is set
+        void cmdDrawMeshTasks(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
+        void cmdDrawIndexedIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset,
+                                         VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride);
+
 
     private:
         void createCommandPool();
+        VkCommandPool createGraphicsCommandPool();
+        VkCommandPool getThreadCommandPool();
 
         VkInstance instance;
         VkDebugUtilsMessengerEXT debugMessenger;
@@ -66,15 +122,26 @@ namespace AhnrealEngine {
         VkQueue graphicsQueue_;
         VkQueue presentQueue_;
         VkQueue computeQueue_;
+        DeviceCapabilities capabilities_;
+        PFN_vkCmdDrawMeshTasksEXT vkCmdDrawMeshTasks_ = nullptr;
+        PFN_vkCmdDrawIndexedIndirectCountKHR vkCmdDrawIndexedIndirectCount_ = nullptr;
+        std::atomic<uint64_t> deviceLocalBytesAllocated{0};
+
+        std::mutex queueMutex;
+        std::thread::id ownerThread;
+        std::mutex threadCommandPoolMutex;
+        std::unordered_map<std::thread::id, VkCommandPool> threadCommandPools;
 
         const std::vector<const char*> validationLayers = {"VK_LAYER_KHRONOS_validation"};
         const std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
         void pickPhysicalDevice();
+        void queryCapabilities();
         void createLogicalDevice();
         bool isDeviceSuitable(VkPhysicalDevice device);
         QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device);
         bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+        bool isExtensionAvailable(VkPhysicalDevice device, const char* extensionName);
         SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
     };
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "VulkanRenderer.h"
 #include "VulkanSwapChain.h"
+#include "BindlessHeap.h"
+#include "DescriptorAllocator.h"
+#include "RenderQueue.h"
 #include <cassert>
 #include <stdexcept>
 #include <array>
@@ -9,6 +12,16 @@ namespace AhnrealEngine {
     VulkanRenderer::VulkanRenderer(GLFWwindow* window, VulkanDevice* device) : window{window}, device{device} {
         recreateSwapChain();
         createCommandBuffers();
+
+        if (device->capabilities().descriptorIndexing) {
+            bindlessHeap = std::make_unique<BindlessHeap>(device);
+        }
+
+        descriptorLayoutCache = std::make_unique<DescriptorLayoutCache>(device);
+        for (int i = 0; i < VulkanSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+            frameDescriptorAllocators.push_back(std::make_unique<DescriptorAllocator>(device));
+        }
+        renderQueue = std::make_unique<RenderQueue>();
     }
 
     VulkanRenderer::~VulkanRenderer() { 
@@ -17,11 +30,19 @@ namespace AhnrealEngine {
 
     void VulkanRenderer::recreateSwapChain() {
         auto extent = getSwapChainExtent();
-        while (extent.width == 0 || extent.height == 0) {
-            extent = getSwapChainExtent();
-            glfwWaitEvents();
+        if (extent.width == 0 || extent.height == 0) {
+            // Minimized: keep the old swap chain. The application stops
+            // rendering until the window has a size, and the next acquire
+            // reports out-of-date and lands back here.
+            if (swapChain != nullptr) {
+                return;
+            }
+            while (extent.width == 0 || extent.height == 0) {
+                glfwWaitEvents();
+                extent = getSwapChainExtent();
+            }
         }
-        vkDeviceWaitIdle(device->device());
+        device->waitIdle();
 
         if (swapChain == nullptr) {
             swapChain = std::make_unique<VulkanSwapChain>(device, extent);
@@ -33,6 +54,7 @@ namespace AhnrealEngine {
                 throw std::runtime_error("Swap chain image(or depth) format has changed!");
             }
         }
+        swapChainGeneration++;
     }
 
     void VulkanRenderer::createCommandBuffers() {
@@ -47,11 +69,19 @@ namespace AhnrealEngine {
         if (vkAllocateCommandBuffers(device->device(), &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
             throw std::runtime_error("failed to allocate command buffers!");
         }
+
+        passCommandBuffers.resize(VulkanSwapChain::MAX_FRAMES_IN_FLIGHT);
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        if (vkAllocateCommandBuffers(device->device(), &allocInfo, passCommandBuffers.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate pass command buffers!");
+        }
     }
 
     void VulkanRenderer::freeCommandBuffers() {
         vkFreeCommandBuffers(device->device(), device->getCommandPool(), static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+        vkFreeCommandBuffers(device->device(), device->getCommandPool(), static_cast<uint32_t>(passCommandBuffers.size()), passCommandBuffers.data());
         commandBuffers.clear();
+        passCommandBuffers.clear();
     }
 
     VkCommandBuffer VulkanRenderer::beginFrame() {
@@ -69,6 +99,13 @@ namespace AhnrealEngine {
 
         isFrameStarted = true;
 
+        // acquireNextImage waited on this frame's fence, so descriptors used the
+        // last time this frame slot was recorded are no longer referenced
+        if (bindlessHeap) {
+            bindlessHeap->beginFrame(static_cast<uint32_t>(currentFrameIndex));
+        }
+        frameDescriptorAllocators[currentFrameIndex]->reset();
+
         auto commandBuffer = getCurrentCommandBuffer();
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -98,7 +135,7 @@ namespace AhnrealEngine {
         currentFrameIndex = (currentFrameIndex + 1) % VulkanSwapChain::MAX_FRAMES_IN_FLIGHT;
     }
 
-    void VulkanRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
+    void VulkanRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents) {
         assert(isFrameStarted && "Can't call beginSwapChainRenderPass if frame is not in progress");
         assert(commandBuffer == getCurrentCommandBuffer() && "Can't begin render pass on command buffer from a different frame");
 
@@ -116,8 +153,61 @@ namespace AhnrealEngine {
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
         renderPassInfo.pClearValues = clearValues.data();
 
-        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+        passContents = contents;
+
+        if (contents == VK_SUBPASS_CONTENTS_INLINE) {
+            setSwapChainViewport(commandBuffer);
+            return;
+        }
+
+        // Draws that aren't cached are collected in the pass secondary
+        VkCommandBuffer passCommandBuffer = passCommandBuffers[currentFrameIndex];
+        VkCommandBufferInheritanceInfo inheritance = getSwapChainPassInheritance();
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = &inheritance;
+
+        if (vkBeginCommandBuffer(passCommandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("failed to begin recording pass command buffer!");
+        }
+        setSwapChainViewport(passCommandBuffer);
+    }
 
+    void VulkanRenderer::endSwapChainRenderPass(VkCommandBuffer commandBuffer) {
+        assert(isFrameStarted && "Can't call endSwapChainRenderPass if frame is not in progress");
+        assert(commandBuffer == getCurrentCommandBuffer() && "Can't end render pass on command buffer from a different frame");
+
+        if (passContents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) {
+            VkCommandBuffer passCommandBuffer = passCommandBuffers[currentFrameIndex];
+            if (vkEndCommandBuffer(passCommandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record pass command buffer!");
+            }
+            vkCmdExecuteCommands(commandBuffer, 1, &passCommandBuffer);
+        }
+        vkCmdEndRenderPass(commandBuffer);
+        passContents = VK_SUBPASS_CONTENTS_INLINE;
+    }
+
+    VkCommandBuffer VulkanRenderer::getPassCommandBuffer() const {
+        if (passContents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) {
+            return passCommandBuffers[currentFrameIndex];
+        }
+        return getCurrentCommandBuffer();
+    }
+
+    VkCommandBufferInheritanceInfo VulkanRenderer::getSwapChainPassInheritance() const {
+        VkCommandBufferInheritanceInfo inheritance{};
+        inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance.renderPass = swapChain->getRenderPass();
+        inheritance.subpass = 0;
+        inheritance.framebuffer = swapChain->getFrameBuffer(currentImageIndex);
+        return inheritance;
+    }
+
+    void VulkanRenderer::setSwapChainViewport(VkCommandBuffer commandBuffer) const {
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
@@ -130,10 +220,9 @@ namespace AhnrealEngine {
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     }
 
-    void VulkanRenderer::endSwapChainRenderPass(VkCommandBuffer commandBuffer) {
-        assert(isFrameStarted && "Can't call endSwapChainRenderPass if frame is not in progress");
-        assert(commandBuffer == getCurrentCommandBuffer() && "Can't end render pass on command buffer from a different frame");
-        vkCmdEndRenderPass(commandBuffer);
+    void VulkanRenderer::flushRenderQueue(VkCommandBuffer commandBuffer) {
+        assert(isFrameStarted && "Can't flush the render queue if frame is not in progress");
+        renderQueue->flush(commandBuffer);
     }
 
     VulkanSwapChain* VulkanRenderer::getSwapChain() const {
@@ -9,6 +9,10 @@ namespace AhnrealEngine {
 
     class VulkanDevice;
     class VulkanSwapChain;
+    class BindlessHeap;
+    class DescriptorAllocator;
+    class DescriptorLayoutCache;
+    class RenderQueue;
 
     class VulkanRenderer {
     public:
@@ -19,17 +23,37 @@ namespace AhnrealEngine {
         
         VkCommandBuffer beginFrame();
         void endFrame();
-        void beginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+        // With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS, draws recorded
+        // during the pass go to getPassCommandBuffer(), which is executed
+        // after any cached secondaries when the pass ends
+        void beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
         void endSwapChainRenderPass(VkCommandBuffer commandBuffer);
 
         VulkanSwapChain* getSwapChain() const;
         VkRenderPass getSwapChainRenderPass() const;
         VkCommandBuffer getCurrentCommandBuffer() const { return commandBuffers[currentFrameIndex]; }
         int getFrameIndex() const { return currentFrameIndex; }
+        uint32_t getImageIndex() const { return currentImageIndex; }
+        // Incremented every time the swap chain (and its framebuffers) is recreated
+        uint64_t getSwapChainGeneration() const { return swapChainGeneration; }
         VkExtent2D getSwapChainExtent() const;
 
         bool isFrameInProgress() const { return isFrameStarted; }
         VulkanDevice* getDevice() const { return device; }
+        // nullptr when the device lacks descriptor indexing
+        BindlessHeap* getBindlessHeap() const { return bindlessHeap.get(); }
+        DescriptorLayoutCache& getDescriptorLayoutCache() const { return *descriptorLayoutCache; }
+        // Sets from this allocator live until the same frame slot comes around again
+        DescriptorAllocator& getFrameDescriptorAllocator() const { return *frameDescriptorAllocators[currentFrameIndex]; }
+        // Draws submitted here are sorted and recorded by flushRenderQueue()
+        RenderQueue& getRenderQueue() const { return *renderQueue; }
+        void flushRenderQueue(VkCommandBuffer commandBuffer);
+
+        // Command buffer for inline draws inside the swap chain pass: the
+        // frame's primary, or its pass secondary in secondary-contents mode
+        VkCommandBuffer getPassCommandBuffer() const;
+        VkCommandBufferInheritanceInfo getSwapChainPassInheritance() const;
+        void setSwapChainViewport(VkCommandBuffer commandBuffer) const;
 
     private:
         void createCommandBuffers();
@@ -38,10 +62,17 @@ namespace AhnrealEngine {
         GLFWwindow* window;
         VulkanDevice* device;
         std::unique_ptr<VulkanSwapChain> swapChain;
+        std::unique_ptr<BindlessHeap> bindlessHeap;
+        std::unique_ptr<DescriptorLayoutCache> descriptorLayoutCache;
+        std::vector<std::unique_ptr<DescriptorAllocator>> frameDescriptorAllocators;
+        std::unique_ptr<RenderQueue> renderQueue;
         std::vector<VkCommandBuffer> commandBuffers;
+        std::vector<VkCommandBuffer> passCommandBuffers;
 
-        uint32_t currentImageIndex;
+        uint32_t currentImageIndex = 0;
         int currentFrameIndex = 0;
         bool isFrameStarted = false;
+        VkSubpassContents passContents = VK_SUBPASS_CONTENTS_INLINE;
+        uint64_t swapChainGeneration = 0;
     };
 }
\ No newline at end of file
@@ -88,7 +88,7 @@ namespace AhnrealEngine {
         submitInfo.pSignalSemaphores = signalSemaphores;
 
         vkResetFences(device->device(), 1, &inFlightFences[currentFrame]);
-        if (vkQueueSubmit(device->graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+        if (device->submitGraphics(1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
             throw std::runtime_error("failed to submit draw command buffer!");
         }
 
@@ -104,7 +104,7 @@ namespace AhnrealEngine {
 
         presentInfo.pImageIndices = imageIndex;
 
-        auto result = vkQueuePresentKHR(device->presentQueue(), &presentInfo);
+        auto result = device->present(presentInfo);
 
         currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 
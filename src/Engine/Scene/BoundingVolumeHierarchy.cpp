@@ -0,0 +1,480 @@
+#include "BoundingVolumeHierarchy.h"
+#include <algorithm>
+#include <numeric>
+
+namespace AhnrealEngine {
+
+    void BoundingVolumeHierarchy::clear() {
+        nodes.clear();
+        itemOrder.clear();
+        itemBounds.clear();
+        centroids.clear();
+    }
+
+    void BoundingVolumeHierarchy::build(const Aabb* bounds, uint32_t count, const BuildSettings& buildSettings) {
+        clear();
+        if (count == 0) return;
+
+        settings = buildSettings;
+        settings.maxLeafSize = std::max(settings.maxLeafSize, 1u);
+        settings.binCount = std::clamp(settings.binCount, 2u, 64u);
+
+        itemBounds.assign(bounds, bounds + count);
+        centroids.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            centroids[i] = itemBounds[i].center();
+        }
+        itemOrder.resize(count);
+        std::iota(itemOrder.begin(), itemOrder.end(), 0u);
+
+        // A binary tree with at most one item per leaf never needs more
+        // than 2n - 1 nodes, so every task can own a fixed range of slots
+        nodes.assign(2 * static_cast<size_t>(count) - 1, Node{});
+
+        // Split the top of the tree here until the pieces are small enough to
+        // be one task each; every piece gets 2 * count - 2 slots for the
+        // nodes below it
+        std::vector<BuildTask> pending{{ROOT, 0, count}};
+        std::vector<std::pair<BuildTask, uint32_t>> tasks;
+        uint32_t nextNode = ROOT + 1;
+        while (!pending.empty()) {
+            BuildTask task = pending.back();
+            pending.pop_back();
+            if (task.count <= TASK_ITEM_COUNT) {
+                tasks.emplace_back(task, nextNode);
+                nextNode += 2 * task.count - 2;
+                continue;
+            }
+            BuildTask left, right;
+            if (splitNode(task, nextNode, left, right)) {
+                pending.push_back(right);
+                pending.push_back(left);
+            }
+        }
+
+        RangeFunction buildTasks = [this, &tasks](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                buildSubtree(tasks[i].first, tasks[i].second);
+            }
+        };
+        const uint32_t taskCount = static_cast<uint32_t>(tasks.size());
+        if (parallelFor && taskCount > 1) {
+            parallelFor(taskCount, buildTasks);
+        } else {
+            buildTasks(0, taskCount);
+        }
+
+        compactNodes();
+        centroids.clear();
+        centroids.shrink_to_fit();
+    }
+
+    bool BoundingVolumeHierarchy::splitNode(const BuildTask& task, uint32_t& nextNode, BuildTask& left, BuildTask& right) {
+        // Bounds come straight from the items, so no bottom-up pass is
+        // needed once the tasks finish
+        Node& node = nodes[task.node];
+        node.bounds = Aabb{};
+        Aabb centroidBounds;
+        for (uint32_t i = task.first; i < task.first + task.count; i++) {
+            node.bounds.expand(itemBounds[itemOrder[i]]);
+            centroidBounds.expand(centroids[itemOrder[i]]);
+        }
+
+        if (task.count <= settings.maxLeafSize) {
+            node.firstItem = task.first;
+            node.itemCount = task.count;
+            return false;
+        }
+
+        // Binned SAH: cost of a split after bin b is
+        // area(left) * count(left) + area(right) * count(right)
+        struct Bin {
+            Aabb bounds;
+            uint32_t count = 0;
+        };
+        Bin bins[64];
+        float rightCosts[64];
+        const uint32_t binCount = settings.binCount;
+        const glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+
+        int bestAxis = -1;
+        uint32_t bestSplit = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; axis++) {
+            if (extent[axis] <= 0.0f) continue;
+            const float scale = binCount / extent[axis];
+            for (uint32_t b = 0; b < binCount; b++) {
+                bins[b] = Bin{};
+            }
+            for (uint32_t i = task.first; i < task.first + task.count; i++) {
+                uint32_t item = itemOrder[i];
+                uint32_t b = std::min(static_cast<uint32_t>((centroids[item][axis] - centroidBounds.min[axis]) * scale), binCount - 1);
+                bins[b].bounds.expand(itemBounds[item]);
+                bins[b].count++;
+            }
+
+            Aabb sweep;
+            uint32_t sweepCount = 0;
+            for (uint32_t b = binCount - 1; b > 0; b--) {
+                sweep.expand(bins[b].bounds);
+                sweepCount += bins[b].count;
+                rightCosts[b] = sweepCount > 0 ? sweep.surfaceArea() * sweepCount : 0.0f;
+            }
+            sweep = Aabb{};
+            sweepCount = 0;
+            for (uint32_t b = 0; b + 1 < binCount; b++) {
+                sweep.expand(bins[b].bounds);
+                sweepCount += bins[b].count;
+                if (sweepCount == 0 || sweepCount == task.count) continue;
+                float cost = sweep.surfaceArea() * sweepCount + rightCosts[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b + 1;
+                }
+            }
+        }
+
+        // With no valid split every centroid coincides, so halving is as good
+        // as anything
+        uint32_t leftCount = task.count / 2;
+        if (bestAxis >= 0) {
+            const float scale = binCount / extent[bestAxis];
+            const float minimum = centroidBounds.min[bestAxis];
+            auto* begin = itemOrder.data() + task.first;
+            auto* middle = std::partition(begin, begin + task.count, [&](uint32_t item) {
+                uint32_t b = std::min(static_cast<uint32_t>((centroids[item][bestAxis] - minimum) * scale), binCount - 1);
+                return b < bestSplit;
+            });
+            leftCount = static_cast<uint32_t>(middle - begin);
+        }
+
+        node.left = nextNode;
+        node.right = nextNode + 1;
+        node.itemCount = 0;
+        nodes[node.left].parent = task.node;
+        nodes[node.right].parent = task.node;
+        nextNode += 2;
+
+        left = {node.left, task.first, leftCount};
+        right = {node.right, task.first + leftCount, task.count - leftCount};
+        return true;
+    }
+
+    void BoundingVolumeHierarchy::buildSubtree(const BuildTask& task, uint32_t firstNode) {
+        std::vector<BuildTask> stack{task};
+        uint32_t nextNode = firstNode;
+        while (!stack.empty()) {
+            BuildTask current = stack.back();
+            stack.pop_back();
+            BuildTask left, right;
+            if (splitNode(current, nextNode, left, right)) {
+                stack.push_back(right);
+                stack.push_back(left);
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::compactNodes() {
+        // Preorder: a node, then its left subtree, then its right subtree
+        std::vector<uint32_t> order;
+        order.reserve(nodes.size());
+        std::vector<uint32_t> stack{ROOT};
+        while (!stack.empty()) {
+            uint32_t node = stack.back();
+            stack.pop_back();
+            order.push_back(node);
+            if (!nodes[node].isLeaf()) {
+                stack.push_back(nodes[node].right);
+                stack.push_back(nodes[node].left);
+            }
+        }
+
+        std::vector<uint32_t> newIndex(nodes.size(), INVALID);
+        for (uint32_t i = 0; i < order.size(); i++) {
+            newIndex[order[i]] = i;
+        }
+        std::vector<Node> compacted(order.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            Node node = nodes[order[i]];
+            node.parent = node.parent != INVALID ? newIndex[node.parent] : INVALID;
+            if (!node.isLeaf()) {
+                node.left = newIndex[node.left];
+                node.right = newIndex[node.right];
+            }
+            compacted[i] = node;
+        }
+        nodes = std::move(compacted);
+    }
+
+    void BoundingVolumeHierarchy::refit(const Aabb* bounds) {
+        if (nodes.empty()) return;
+        std::copy(bounds, bounds + itemBounds.size(), itemBounds.begin());
+
+        // Depth-first order puts every child after its parent
+        for (uint32_t i = static_cast<uint32_t>(nodes.size()); i-- > 0;) {
+            Node& node = nodes[i];
+            if (node.isLeaf()) {
+                node.bounds = Aabb{};
+                for (uint32_t j = node.firstItem; j < node.firstItem + node.itemCount; j++) {
+                    node.bounds.expand(itemBounds[itemOrder[j]]);
+                }
+            } else {
+                node.bounds = nodes[node.left].bounds;
+                node.bounds.expand(nodes[node.right].bounds);
+            }
+        }
+    }
+
+    uint32_t BoundingVolumeHierarchy::optimize() {
+        if (nodes.size() < 5) return 0;
+
+        auto merged = [this](uint32_t a, uint32_t b) {
+            Aabb bounds = nodes[a].bounds;
+            bounds.expand(nodes[b].bounds);
+            return bounds;
+        };
+
+        // Bottom-up, try swapping each child with a grandchild on the other
+        // side. Only the surface area of the child that receives the swap
+        // changes, so the best rotation is the one shrinking it the most.
+        uint32_t rotations = 0;
+        for (uint32_t i = static_cast<uint32_t>(nodes.size()); i-- > 0;) {
+            if (nodes[i].isLeaf()) continue;
+
+            float bestGain = 0.0f;
+            uint32_t bestChild = INVALID;      // Child that loses a grandchild
+            uint32_t bestGrandchild = INVALID;
+            Aabb bestBounds;
+            for (int side = 0; side < 2; side++) {
+                uint32_t child = side == 0 ? nodes[i].left : nodes[i].right;
+                uint32_t sibling = side == 0 ? nodes[i].right : nodes[i].left;
+                const Node& childNode = nodes[child];
+                if (childNode.isLeaf()) continue;
+
+                const float area = childNode.bounds.surfaceArea();
+                for (int g = 0; g < 2; g++) {
+                    uint32_t grandchild = g == 0 ? childNode.left : childNode.right;
+                    uint32_t kept = g == 0 ? childNode.right : childNode.left;
+                    Aabb bounds = merged(sibling, kept);
+                    float gain = area - bounds.surfaceArea();
+                    if (gain > bestGain) {
+                        bestGain = gain;
+                        bestChild = child;
+                        bestGrandchild = grandchild;
+                        bestBounds = bounds;
+                    }
+                }
+            }
+
+            // Ignore rounding-level gains so refit/optimize cycles settle
+            if (bestChild == INVALID || bestGain <= nodes[i].bounds.surfaceArea() * 1e-4f) continue;
+
+            Node& parent = nodes[i];
+            uint32_t sibling = parent.left == bestChild ? parent.right : parent.left;
+            Node& child = nodes[bestChild];
+            if (child.left == bestGrandchild) {
+                child.left = sibling;
+            } else {
+                child.right = sibling;
+            }
+            if (parent.left == sibling) {
+                parent.left = bestGrandchild;
+            } else {
+                parent.right = bestGrandchild;
+            }
+            nodes[sibling].parent = bestChild;
+            nodes[bestGrandchild].parent = i;
+            child.bounds = bestBounds;
+            rotations++;
+        }
+
+        // Rotations move subtrees out of depth-first order, which refit() and
+        // flatten() rely on
+        if (rotations > 0) {
+            compactNodes();
+        }
+        return rotations;
+    }
+
+    void BoundingVolumeHierarchy::collectItems(uint32_t node, std::vector<uint32_t>& items) const {
+        std::vector<uint32_t> stack{node};
+        while (!stack.empty()) {
+            const Node& current = nodes[stack.back()];
+            stack.pop_back();
+            if (current.isLeaf()) {
+                items.insert(items.end(), itemOrder.begin() + current.firstItem,
+                             itemOrder.begin() + current.firstItem + current.itemCount);
+            } else {
+                stack.push_back(current.right);
+                stack.push_back(current.left);
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& items) const {
+        if (nodes.empty()) return;
+
+        std::vector<uint32_t> stack{ROOT};
+        while (!stack.empty()) {
+            uint32_t index = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[index];
+            Frustum::Containment containment = frustum.classifyBox(node.bounds.min, node.bounds.max);
+            if (containment == Frustum::Outside) continue;
+            if (containment == Frustum::Inside) {
+                collectItems(index, items);
+            } else if (node.isLeaf()) {
+                for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; i++) {
+                    const Aabb& bounds = itemBounds[itemOrder[i]];
+                    if (frustum.intersectsBox(bounds.min, bounds.max)) {
+                        items.push_back(itemOrder[i]);
+                    }
+                }
+            } else {
+                stack.push_back(node.right);
+                stack.push_back(node.left);
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::queryBox(const Aabb& box, std::vector<uint32_t>& items) const {
+        if (nodes.empty()) return;
+
+        std::vector<uint32_t> stack{ROOT};
+        while (!stack.empty()) {
+            const Node& node = nodes[stack.back()];
+            stack.pop_back();
+            if (!node.bounds.overlaps(box)) continue;
+            if (node.isLeaf()) {
+                for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; i++) {
+                    if (itemBounds[itemOrder[i]].overlaps(box)) {
+                        items.push_back(itemOrder[i]);
+                    }
+                }
+            } else {
+                stack.push_back(node.right);
+                stack.push_back(node.left);
+            }
+        }
+    }
+
+    // Slab test; returns the entry distance, or a negative value on a miss
+    static float intersectRay(const Aabb& box, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance) {
+        glm::vec3 t0 = (box.min - origin) * inverseDirection;
+        glm::vec3 t1 = (box.max - origin) * inverseDirection;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float entry = std::max({tNear.x, tNear.y, tNear.z, 0.0f});
+        float exit = std::min({tFar.x, tFar.y, tFar.z, maxDistance});
+        return entry <= exit ? entry : -1.0f;
+    }
+
+    bool BoundingVolumeHierarchy::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                                          uint32_t& item, float& distance) const {
+        if (nodes.empty()) return false;
+
+        // Infinities from zero components are fine for the slab test
+        const glm::vec3 inverseDirection = 1.0f / direction;
+        float nearest = maxDistance;
+        bool hit = false;
+
+        std::vector<std::pair<uint32_t, float>> stack;
+        float rootEntry = intersectRay(nodes[ROOT].bounds, origin, inverseDirection, nearest);
+        if (rootEntry >= 0.0f) stack.emplace_back(ROOT, rootEntry);
+        while (!stack.empty()) {
+            auto [index, entry] = stack.back();
+            stack.pop_back();
+            if (entry > nearest) continue;
+
+            const Node& node = nodes[index];
+            if (node.isLeaf()) {
+                for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; i++) {
+                    float t = intersectRay(itemBounds[itemOrder[i]], origin, inverseDirection, nearest);
+                    if (t >= 0.0f && (!hit || t < nearest)) {
+                        nearest = t;
+                        item = itemOrder[i];
+                        hit = true;
+                    }
+                }
+                continue;
+            }
+
+            // Visit the nearer child first so the farther one is often
+            // rejected by the closer hit
+            float leftEntry = intersectRay(nodes[node.left].bounds, origin, inverseDirection, nearest);
+            float rightEntry = intersectRay(nodes[node.right].bounds, origin, inverseDirection, nearest);
+            std::pair<uint32_t, float> first{node.left, leftEntry};
+            std::pair<uint32_t, float> second{node.right, rightEntry};
+            if (second.second >= 0.0f && (first.second < 0.0f || second.second < first.second)) {
+                std::swap(first, second);
+            }
+            if (second.second >= 0.0f) stack.push_back(second);
+            if (first.second >= 0.0f) stack.push_back(first);
+        }
+
+        if (hit) distance = nearest;
+        return hit;
+    }
+
+    void BoundingVolumeHierarchy::flatten(BvhGpuLayout& layout, uint32_t maxSubtreeLeaves) const {
+        layout.nodes.clear();
+        layout.itemLeaf.assign(itemBounds.size(), 0);
+        layout.subtreeRoots.clear();
+        layout.leafCount = 0;
+        if (nodes.empty()) return;
+
+        // Nodes are already depth-first, so GPU indices match ours and a
+        // subtree is a contiguous range
+        const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+        std::vector<uint32_t> subtreeSize(nodeCount, 1);
+        std::vector<uint32_t> leafCounts(nodeCount, 1);
+        for (uint32_t i = nodeCount; i-- > 0;) {
+            const Node& node = nodes[i];
+            if (!node.isLeaf()) {
+                subtreeSize[i] = 1 + subtreeSize[node.left] + subtreeSize[node.right];
+                leafCounts[i] = leafCounts[node.left] + leafCounts[node.right];
+            }
+        }
+
+        layout.nodes.resize(nodeCount);
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            const Node& node = nodes[i];
+            BvhGpuNode& gpuNode = layout.nodes[i];
+            gpuNode.min = node.bounds.min;
+            gpuNode.max = node.bounds.max;
+            gpuNode.skip = i + subtreeSize[i];
+            gpuNode.firstLeaf = layout.leafCount;
+            if (node.isLeaf()) {
+                for (uint32_t j = node.firstItem; j < node.firstItem + node.itemCount; j++) {
+                    layout.itemLeaf[itemOrder[j]] = layout.leafCount;
+                }
+                layout.leafCount++;
+            }
+        }
+
+        std::vector<uint32_t> stack{ROOT};
+        while (!stack.empty()) {
+            uint32_t index = stack.back();
+            stack.pop_back();
+            if (leafCounts[index] <= maxSubtreeLeaves) {
+                layout.subtreeRoots.push_back(index);
+            } else {
+                stack.push_back(nodes[index].right);
+                stack.push_back(nodes[index].left);
+            }
+        }
+    }
+
+    float BoundingVolumeHierarchy::getSahCost() const {
+        if (nodes.empty()) return 0.0f;
+        float rootArea = nodes[ROOT].bounds.surfaceArea();
+        if (rootArea <= 0.0f) return 0.0f;
+
+        float total = 0.0f;
+        for (const Node& node : nodes) {
+            total += node.bounds.surfaceArea();
+        }
+        return total / rootArea;
+    }
+}
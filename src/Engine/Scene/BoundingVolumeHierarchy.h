@@ -0,0 +1,147 @@
+#pragma once
+
+#include "../Core/Frustum.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    struct Aabb {
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{-std::numeric_limits<float>::max()};
+
+        void expand(const Aabb& other) {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+        void expand(const glm::vec3& point) {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+        glm::vec3 center() const { return (min + max) * 0.5f; }
+        float surfaceArea() const {
+            glm::vec3 d = glm::max(max - min, glm::vec3(0.0f));
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+        bool overlaps(const Aabb& other) const {
+            return min.x <= other.max.x && max.x >= other.min.x &&
+                   min.y <= other.max.y && max.y >= other.min.y &&
+                   min.z <= other.max.z && max.z >= other.min.z;
+        }
+    };
+
+    // Node of the flattened tree as read by cull_bvh_traverse.comp (std430,
+    // 32 bytes). Nodes are in depth-first order, so an internal node's first
+    // child is the next node and skip is the first node after its subtree;
+    // a node is a leaf when skip == index + 1. Leaves are numbered in the
+    // same order, so the leaves below a node are [firstLeaf, firstLeaf of
+    // node skip) (or the leaf count when skip is past the end).
+    struct BvhGpuNode {
+        glm::vec3 min;
+        uint32_t skip;
+        glm::vec3 max;
+        uint32_t firstLeaf;
+    };
+
+    struct BvhGpuLayout {
+        std::vector<BvhGpuNode> nodes;
+        std::vector<uint32_t> itemLeaf;     // Item index -> leaf number
+        std::vector<uint32_t> subtreeRoots; // Nodes one GPU thread each traverses
+        uint32_t leafCount = 0;
+    };
+
+    // Bounding volume hierarchy over items identified by their index in the
+    // bounds array passed to build(). Built top-down with binned SAH; the
+    // upper levels are split on the calling thread and the remaining
+    // subtrees through the parallel-for hook.
+    //
+    // Moving items don't need a rebuild: refit() takes their new bounds and
+    // updates the tree bottom-up, and optimize() then applies tree rotations
+    // (Kopta et al., "Fast, Effective BVH Updates for Animated Scenes") to
+    // win back most of the quality a refit loses. Adding or removing items
+    // needs a new build().
+    class BoundingVolumeHierarchy {
+    public:
+        using RangeFunction = std::function<void(uint32_t begin, uint32_t end)>;
+        using ParallelFor = std::function<void(uint32_t count, const RangeFunction& fn)>;
+
+        struct BuildSettings {
+            uint32_t maxLeafSize = 4;
+            uint32_t binCount = 16;
+        };
+
+        void build(const Aabb* bounds, uint32_t count, const BuildSettings& settings);
+        void build(const Aabb* bounds, uint32_t count) { build(bounds, count, BuildSettings{}); }
+        void clear();
+
+        // bounds holds every item's new bounds, indexed as in build()
+        void refit(const Aabb* bounds);
+        // Returns the number of rotations applied
+        uint32_t optimize();
+
+        // Appends the items whose bounds intersect the query
+        void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& items) const;
+        void queryBox(const Aabb& box, std::vector<uint32_t>& items) const;
+        // Nearest item whose bounds the ray enters within maxDistance.
+        // direction need not be normalized; distance is in its units.
+        bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                     uint32_t& item, float& distance) const;
+
+        // Depth-first copy for the GPU. Subtree roots are the highest nodes
+        // with at most maxSubtreeLeaves leaves below them.
+        void flatten(BvhGpuLayout& layout, uint32_t maxSubtreeLeaves) const;
+
+        // Sum over nodes of surface area relative to the root's: lower is a
+        // better tree for the same items
+        float getSahCost() const;
+        uint32_t getNodeCount() const { return static_cast<uint32_t>(nodes.size()); }
+        uint32_t getItemCount() const { return static_cast<uint32_t>(itemBounds.size()); }
+        bool empty() const { return nodes.empty(); }
+        const Aabb& getBounds() const { return nodes[ROOT].bounds; }
+
+        // Defaults to running inline on the calling thread
+        void setParallelFor(ParallelFor parallelFor) { this->parallelFor = std::move(parallelFor); }
+
+    private:
+        static constexpr uint32_t ROOT = 0;
+        static constexpr uint32_t INVALID = 0xFFFFFFFFu;
+        // Subtrees at most this large are built by one parallel-for task
+        static constexpr uint32_t TASK_ITEM_COUNT = 4096;
+
+        struct Node {
+            Aabb bounds;
+            uint32_t parent = INVALID;
+            uint32_t left = INVALID;  // Internal nodes only; right = left's sibling
+            uint32_t right = INVALID;
+            uint32_t firstItem = 0;   // Leaves only, into itemOrder
+            uint32_t itemCount = 0;   // 0 for internal nodes
+            bool isLeaf() const { return itemCount > 0; }
+        };
+
+        struct BuildTask {
+            uint32_t node;
+            uint32_t first;
+            uint32_t count;
+        };
+
+        // Splits the task's items into two children allocated at nextNode,
+        // or makes it a leaf. Returns false for leaves.
+        bool splitNode(const BuildTask& task, uint32_t& nextNode, BuildTask& left, BuildTask& right);
+        // Builds below task.node, allocating nodes from firstNode upwards
+        void buildSubtree(const BuildTask& task, uint32_t firstNode);
+        // Renumbers the reachable nodes depth-first, dropping unused slots
+        void compactNodes();
+        void collectItems(uint32_t node, std::vector<uint32_t>& items) const;
+
+        std::vector<Node> nodes;
+        std::vector<uint32_t> itemOrder;   // Item indices grouped by leaf
+        std::vector<Aabb> itemBounds;
+        std::vector<glm::vec3> centroids;  // Build scratch
+        BuildSettings settings;
+
+        ParallelFor parallelFor;
+    };
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../Core/Camera.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+
+struct ImDrawData;
+
+namespace AhnrealEngine {
+
+    // Camera state captured by the simulation for the render stage
+    struct FrameCamera {
+        glm::mat4 view{1.0f};
+        glm::mat4 proj{1.0f};
+        glm::vec3 position{0.0f};
+        float nearPlane = DEFAULT_NEAR;
+        float farPlane = DEFAULT_FAR;
+
+        static FrameCamera capture(const Camera& camera, float aspectRatio) {
+            FrameCamera state;
+            state.view = camera.getViewMatrix();
+            state.proj = camera.getProjectionMatrix(aspectRatio);
+            state.position = camera.getPosition();
+            state.nearPlane = camera.getNear();
+            state.farPlane = camera.getFar();
+            return state;
+        }
+
+        // Blends two simulated states for rendering between ticks. Position is
+        // lerped and orientation nlerped, then the view is rebuilt; the
+        // projection is taken from b.
+        static FrameCamera interpolate(const FrameCamera& a, const FrameCamera& b, float t) {
+            if (t >= 1.0f) return b;
+
+            // Rows of a view matrix's rotation are the camera's right, up and -forward axes
+            auto forwardOf = [](const glm::mat4& view) { return -glm::vec3(view[0][2], view[1][2], view[2][2]); };
+            auto upOf = [](const glm::mat4& view) { return glm::vec3(view[0][1], view[1][1], view[2][1]); };
+
+            FrameCamera state = b;
+            state.position = glm::mix(a.position, b.position, t);
+            glm::vec3 forward = glm::normalize(glm::mix(forwardOf(a.view), forwardOf(b.view), t));
+            glm::vec3 up = glm::normalize(glm::mix(upOf(a.view), upOf(b.view), t));
+            state.view = glm::lookAt(state.position, state.position + forward, up);
+            return state;
+        }
+    };
+
+    // Everything the render stage needs from one simulated frame. The
+    // simulation writes a packet while the renderer reads the other one, so a
+    // pipelined scene must not touch simulation state while recording.
+    struct FramePacket {
+        uint64_t frameNumber = 0;
+        float deltaTime = 0.0f;
+        float aspectRatio = 1.0f; // Of the swap chain when the frame started
+
+        FrameCamera camera;
+
+        // Fixed-step interpolation: camera is the latest tick, previousCamera
+        // the one before, and interpolationAlpha how far rendering is between
+        // them. Variable-step frames have alpha 1.
+        FrameCamera previousCamera;
+        float interpolationAlpha = 1.0f;
+        uint32_t simulationSteps = 1;
+
+        // ImGui output for this frame, valid until the next UI frame begins
+        ImDrawData* uiDrawData = nullptr;
+
+        // Camera to render with, interpolated between the last two ticks
+        FrameCamera renderCamera() const {
+            return FrameCamera::interpolate(previousCamera, camera, interpolationAlpha);
+        }
+
+        // Starts a new frame, keeping allocations. Simulated state is carried
+        // over from the last packet so a frame that runs no tick still
+        // renders the latest state.
+        void reset(uint64_t number, float frameDeltaTime, float frameAspectRatio, const FramePacket& last) {
+            frameNumber = number;
+            deltaTime = frameDeltaTime;
+            aspectRatio = frameAspectRatio;
+            camera = last.camera;
+            previousCamera = last.previousCamera;
+            interpolationAlpha = 1.0f;
+            simulationSteps = 0;
+            uiDrawData = nullptr;
+        }
+    };
+
+    // Two packets: one being simulated, one being rendered
+    class FramePacketBuffer {
+    public:
+        FramePacket& simulationPacket() { return packets[simulationIndex]; }
+        FramePacket& renderPacket() { return packets[simulationIndex ^ 1]; }
+
+        // Hands the finished simulation packet to the render stage
+        void swap() { simulationIndex ^= 1; }
+
+    private:
+        FramePacket packets[2];
+        uint32_t simulationIndex = 0;
+    };
+}
@@ -1,7 +1,10 @@
 #include "Scene.h"
+#include "FramePacket.h"
 #include "../Renderer/VulkanRenderer.h"
 #include "../Renderer/VulkanDevice.h"
+#include "../Core/JobSystem.h"
 #include <algorithm>
+#include <iostream>
 #include <vector>
 
 namespace AhnrealEngine {
@@ -32,46 +35,200 @@ namespace AhnrealEngine {
     }
 
     void SceneManager::setCurrentScene(const std::string& name, VulkanRenderer* renderer) {
-         auto it = std::find_if(scenes.begin(), scenes.end(),
-            [&name](const std::unique_ptr<Scene>& scene) {
-                return scene->getName() == name;
-            });
+        Scene* scene = findScene(name);
+        if (!scene) return;
 
-        if (it != scenes.end()) {
-            nextScene = it->get();
+        // A newer request replaces any switch still waiting on a load
+        for (auto& load : pendingLoads) {
+            load->switchWhenReady = false;
+        }
+
+        if (scene == currentScene || isResident(scene) || !scene->supportsPreload() || !JobSystem::get()) {
             // Don't switch immediately. Wait for processPendingSwitch.
+            nextScene = scene;
+        } else {
+            nextScene = nullptr;
+            startPreload(scene, renderer, true);
+        }
+    }
+
+    void SceneManager::preloadScene(const std::string& name, VulkanRenderer* renderer) {
+        Scene* scene = findScene(name);
+        if (scene && scene != currentScene && !isResident(scene) && !isLoading(scene) &&
+            scene->supportsPreload() && JobSystem::get()) {
+            startPreload(scene, renderer, false);
+        }
+    }
+
+    void SceneManager::startPreload(Scene* scene, VulkanRenderer* renderer, bool switchWhenReady) {
+        for (auto& load : pendingLoads) {
+            if (load->scene == scene) {
+                load->switchWhenReady = switchWhenReady;
+                return;
+            }
+        }
+
+        auto load = std::make_unique<PendingLoad>();
+        load->scene = scene;
+        load->switchWhenReady = switchWhenReady;
+        // Other allocations made while the load runs are counted too; the
+        // footprint is an estimate either way
+        load->allocatedBefore = renderer->getDevice()->getDeviceLocalBytesAllocated();
+        load->counter = std::make_unique<JobCounter>();
+
+        PendingLoad* pending = load.get();
+        JobSystem::get()->run([pending, renderer]() {
+            try {
+                pending->scene->prepare(renderer, pending->progress);
+            } catch (...) {
+                pending->error = std::current_exception();
+            }
+            pending->progress.set(1.0f);
+        }, pending->counter.get());
+
+        pendingLoads.push_back(std::move(load));
+    }
+
+    void SceneManager::finishCompletedLoads(VulkanRenderer* renderer) {
+        for (auto it = pendingLoads.begin(); it != pendingLoads.end();) {
+            PendingLoad& load = **it;
+            if (!load.counter->isDone()) {
+                ++it;
+                continue;
+            }
+
+            if (load.error) {
+                try {
+                    std::rethrow_exception(load.error);
+                } catch (const std::exception& e) {
+                    std::cerr << "Failed to preload scene " << load.scene->getName() << ": " << e.what() << std::endl;
+                }
+                load.scene->cleanup();
+            } else {
+                // Finish on this thread, then park the scene until it's switched to
+                load.scene->initialize(renderer);
+                load.scene->suspend();
+                makeResident(load.scene, renderer->getDevice()->getDeviceLocalBytesAllocated() - load.allocatedBefore);
+                if (load.switchWhenReady) {
+                    nextScene = load.scene;
+                }
+            }
+            it = pendingLoads.erase(it);
         }
     }
 
     bool SceneManager::processPendingSwitch(VulkanRenderer* renderer) {
+        finishCompletedLoads(renderer);
+
+        bool switched = false;
         if (nextScene && nextScene != currentScene) {
             if (currentScene) {
-                vkDeviceWaitIdle(renderer->getDevice()->device());
-                currentScene->cleanup();
+                renderer->getDevice()->waitIdle();
+                currentScene->suspend();
             }
             currentScene = nextScene;
-            currentScene->initialize(renderer);
-            nextScene = nullptr;
-            return true;
+
+            auto resident = findResident(currentScene);
+            if (resident != residentScenes.end()) {
+                currentScene->resume(renderer);
+                resident->lastUsed = ++useCounter;
+            } else {
+                uint64_t allocatedBefore = renderer->getDevice()->getDeviceLocalBytesAllocated();
+                currentScene->initialize(renderer);
+                makeResident(currentScene, renderer->getDevice()->getDeviceLocalBytesAllocated() - allocatedBefore);
+            }
+            switched = true;
         }
-        return false;
+        nextScene = nullptr;
+
+        // The budget can also change from the UI between switches
+        enforceResidencyBudget();
+        return switched;
+    }
+
+    bool SceneManager::isLoading(const Scene* scene) const {
+        return std::any_of(pendingLoads.begin(), pendingLoads.end(),
+            [scene](const std::unique_ptr<PendingLoad>& load) { return load->scene == scene; });
     }
 
-    void SceneManager::update(float deltaTime) {
+    float SceneManager::getLoadProgress(const Scene* scene) const {
+        for (const auto& load : pendingLoads) {
+            if (load->scene == scene) return load->progress.get();
+        }
+        return isResident(scene) ? 1.0f : 0.0f;
+    }
+
+    Scene* SceneManager::findScene(const std::string& name) const {
+        auto it = std::find_if(scenes.begin(), scenes.end(),
+            [&name](const std::unique_ptr<Scene>& scene) {
+                return scene->getName() == name;
+            });
+        return it != scenes.end() ? it->get() : nullptr;
+    }
+
+    void SceneManager::makeResident(Scene* scene, uint64_t deviceBytes) {
+        residentScenes.push_back({scene, deviceBytes, ++useCounter});
+    }
+
+    void SceneManager::enforceResidencyBudget() {
+        while (getInactiveResidentBytes() > residencyBudget ||
+               (residencyBudget == 0 && residentScenes.size() > (currentScene ? 1u : 0u))) {
+            auto leastRecent = residentScenes.end();
+            for (auto it = residentScenes.begin(); it != residentScenes.end(); ++it) {
+                if (it->scene == currentScene) continue;
+                if (leastRecent == residentScenes.end() || it->lastUsed < leastRecent->lastUsed) {
+                    leastRecent = it;
+                }
+            }
+            if (leastRecent == residentScenes.end()) break;
+
+            // Scenes wait for the device in cleanup(); an inactive scene is
+            // not referenced by frames recorded since it was suspended
+            leastRecent->scene->cleanup();
+            residentScenes.erase(leastRecent);
+        }
+    }
+
+    std::vector<SceneManager::ResidentScene>::iterator SceneManager::findResident(const Scene* scene) {
+        return std::find_if(residentScenes.begin(), residentScenes.end(),
+            [scene](const ResidentScene& resident) { return resident.scene == scene; });
+    }
+
+    bool SceneManager::isResident(const Scene* scene) const {
+        return std::any_of(residentScenes.begin(), residentScenes.end(),
+            [scene](const ResidentScene& resident) { return resident.scene == scene; });
+    }
+
+    uint64_t SceneManager::getResidentBytes(const Scene* scene) const {
+        for (const ResidentScene& resident : residentScenes) {
+            if (resident.scene == scene) return resident.getBytes();
+        }
+        return 0;
+    }
+
+    uint64_t SceneManager::getInactiveResidentBytes() const {
+        uint64_t total = 0;
+        for (const ResidentScene& resident : residentScenes) {
+            if (resident.scene != currentScene) total += resident.getBytes();
+        }
+        return total;
+    }
+
+    void SceneManager::update(float deltaTime, FramePacket& packet) {
         if (currentScene) {
-            currentScene->update(deltaTime);
+            currentScene->update(deltaTime, packet);
         }
     }
 
-    void SceneManager::preRender(VulkanRenderer* renderer) {
+    void SceneManager::preRender(VulkanRenderer* renderer, const FramePacket& packet) {
         if (currentScene) {
-            currentScene->preRender(renderer);
+            currentScene->preRender(renderer, packet);
         }
     }
 
-    void SceneManager::render(VulkanRenderer* renderer) {
+    void SceneManager::render(VulkanRenderer* renderer, const FramePacket& packet) {
         if (currentScene) {
-            currentScene->render(renderer);
+            currentScene->render(renderer, packet);
         }
     }
 
@@ -82,10 +239,20 @@ namespace AhnrealEngine {
     }
 
     void SceneManager::cleanup() {
-        if (currentScene) {
-            currentScene->cleanup();
-            currentScene = nullptr;
+        // Loads still running reference their scenes
+        for (auto& load : pendingLoads) {
+            if (JobSystem* jobs = JobSystem::get()) {
+                jobs->wait(*load->counter);
+            }
+            load->scene->cleanup();
+        }
+        pendingLoads.clear();
+
+        for (const ResidentScene& resident : residentScenes) {
+            resident.scene->cleanup();
         }
+        residentScenes.clear();
+        currentScene = nullptr;
         scenes.clear();
     }
 }
\ No newline at end of file
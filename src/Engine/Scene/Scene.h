@@ -3,10 +3,25 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <cstdint>
+#include <atomic>
+#include <exception>
 
 namespace AhnrealEngine {
     
     class VulkanRenderer;
+    class JobCounter;
+    struct FramePacket;
+
+    // Written by a loading thread, read by the UI
+    class LoadProgress {
+    public:
+        void set(float fraction) { value.store(fraction, std::memory_order_relaxed); }
+        float get() const { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<float> value{0.0f};
+    };
 
     class Scene {
     public:
@@ -16,10 +31,54 @@ namespace AhnrealEngine {
         virtual void initialize() = 0;
         virtual void initialize(VulkanRenderer* renderer) { initialize(); }
         virtual void preRender(VulkanRenderer* renderer) {}
-        virtual void update(float deltaTime) = 0;
-        virtual void render(VulkanRenderer* renderer) = 0;
+        virtual void update(float deltaTime) {}
+        virtual void render(VulkanRenderer* renderer) {}
         virtual void cleanup() = 0;
         virtual void onImGuiRender() = 0;
+
+        // A scene switched away from may stay resident: suspend() is called
+        // instead of cleanup() and its GPU resources are kept, then resume()
+        // runs instead of initialize() when it becomes current again
+        virtual void suspend() {}
+        virtual void resume(VulkanRenderer* renderer) {}
+
+        // Preloadable scenes split initialization: prepare() runs on a job
+        // worker while the previous scene keeps rendering, doing file I/O,
+        // CPU generation and uploads (VulkanDevice transfers are thread-safe).
+        // It must not touch renderer frame state or shared caches.
+        // initialize() then runs on the main thread and only finishes what
+        // prepare() left, such as pipelines and descriptor sets. It must
+        // still work without a prior prepare().
+        virtual bool supportsPreload() const { return false; }
+        virtual void prepare(VulkanRenderer* renderer, LoadProgress& progress) {}
+
+        // A pipelined scene's update for frame N+1 runs on a worker while
+        // frame N is recorded. Its update writes what rendering needs into the
+        // packet, and preRender/render read only the packet and GPU resources.
+        // The packet overloads default to the plain ones for serial scenes.
+        virtual bool supportsPipelinedUpdate() const { return false; }
+        virtual void update(float deltaTime, FramePacket& packet) { update(deltaTime); }
+        virtual void preRender(VulkanRenderer* renderer, const FramePacket& packet) { preRender(renderer); }
+        virtual void render(VulkanRenderer* renderer, const FramePacket& packet) { render(renderer); }
+
+        // Scenes that only change in response to input return false, so the
+        // loop can stop redrawing them while the user is idle
+        virtual bool needsContinuousRedraw() const { return true; }
+
+        // Scenes that render with FramePacket::renderCamera() can run on the
+        // fixed timestep. Others would show the latest tick and judder, so
+        // they keep one step per frame even while fixed steps are enabled.
+        virtual bool supportsFixedTimestep() const { return false; }
+
+        // True while the scene replays cached secondary command buffers. The
+        // swap chain pass is then begun for secondaries, and any other draws
+        // must be recorded into renderer->getPassCommandBuffer().
+        virtual bool usesStaticCommandBuffers() const { return false; }
+
+        // Device-local bytes the scene holds right now, for scenes that
+        // allocate after initialize(). 0 keeps the residency footprint at
+        // what initialize() was measured to allocate.
+        virtual uint64_t getDeviceFootprint() const { return 0; }
         
         const std::string& getName() const { return sceneName; }
         
@@ -35,20 +94,71 @@ namespace AhnrealEngine {
         void addScene(std::unique_ptr<Scene> scene);
         void setCurrentScene(const std::string& name);
         void setCurrentScene(const std::string& name, VulkanRenderer* renderer);
-        void update(float deltaTime);
-        void preRender(VulkanRenderer* renderer);
-        void render(VulkanRenderer* renderer);
+        void update(float deltaTime, FramePacket& packet);
+        void preRender(VulkanRenderer* renderer, const FramePacket& packet);
+        void render(VulkanRenderer* renderer, const FramePacket& packet);
         void renderUI();
         void cleanup();
         
+        // Also finishes completed preloads and cleans up scenes pushed over
+        // the residency budget
         bool processPendingSwitch(VulkanRenderer* renderer);
+
+        // Starts preparing a scene on a worker. setCurrentScene() does this
+        // too for preloadable scenes that aren't resident, and switches once
+        // the scene is ready; until then the current scene keeps running.
+        void preloadScene(const std::string& name, VulkanRenderer* renderer);
+        bool isLoading(const Scene* scene) const;
+        float getLoadProgress(const Scene* scene) const;
         
         Scene* getCurrentScene() const { return currentScene; }
         const std::vector<std::unique_ptr<Scene>>& getScenes() const { return scenes; }
+
+        // Inactive scenes stay resident while the device-local memory they
+        // hold fits this budget; the least recently used are cleaned up
+        // first. 0 keeps only the current scene.
+        void setResidencyBudget(uint64_t bytes) { residencyBudget = bytes; }
+        uint64_t getResidencyBudget() const { return residencyBudget; }
+        bool isResident(const Scene* scene) const;
+        uint64_t getResidentBytes(const Scene* scene) const;
+        uint64_t getInactiveResidentBytes() const;
         
     private:
+        struct ResidentScene {
+            Scene* scene;
+            uint64_t deviceBytes; // Device-local memory allocated by initialize()
+            uint64_t lastUsed;
+
+            // The scene's own footprint where it reports one
+            uint64_t getBytes() const {
+                uint64_t current = scene->getDeviceFootprint();
+                return current != 0 ? current : deviceBytes;
+            }
+        };
+
+        struct PendingLoad {
+            Scene* scene;
+            bool switchWhenReady;
+            uint64_t allocatedBefore;
+            LoadProgress progress;
+            std::unique_ptr<JobCounter> counter;
+            std::exception_ptr error;
+        };
+
+        Scene* findScene(const std::string& name) const;
+        void startPreload(Scene* scene, VulkanRenderer* renderer, bool switchWhenReady);
+        void finishCompletedLoads(VulkanRenderer* renderer);
+        void makeResident(Scene* scene, uint64_t deviceBytes);
+        void enforceResidencyBudget();
+        std::vector<ResidentScene>::iterator findResident(const Scene* scene);
+
         std::vector<std::unique_ptr<Scene>> scenes;
         Scene* currentScene = nullptr;
         Scene* nextScene = nullptr;
+
+        std::vector<std::unique_ptr<PendingLoad>> pendingLoads;
+        std::vector<ResidentScene> residentScenes;
+        uint64_t residencyBudget = 256ull * 1024 * 1024;
+        uint64_t useCounter = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "SceneGraph.h"
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define AHNREAL_SCENEGRAPH_SSE 1
+#endif
+
+namespace AhnrealEngine {
+
+    // Below this many nodes a level is transformed inline; the dispatch cost
+    // of the parallel-for hook would outweigh the work
+    static constexpr uint32_t MIN_PARALLEL_BATCH = 256;
+
+    // out = a * b for column-major matrices (GLM layout). out must not alias a or b.
+    static inline void multiplyMatrices(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+#ifdef AHNREAL_SCENEGRAPH_SSE
+        const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+        const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+        const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+        const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+        for (int column = 0; column < 4; column++) {
+            // Column j of the result is a linear combination of a's columns
+            __m128 result = _mm_mul_ps(a0, _mm_set1_ps(b[column][0]));
+            result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(b[column][1])));
+            result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(b[column][2])));
+            result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_set1_ps(b[column][3])));
+            _mm_storeu_ps(&out[column][0], result);
+        }
+#else
+        out = a * b;
+#endif
+    }
+
+    NodeHandle SceneGraph::createNode(NodeHandle parent, const glm::mat4& localTransform) {
+        NodeHandle node = static_cast<NodeHandle>(parents.size());
+        parents.push_back(parent);
+        levels.push_back(parent == INVALID_NODE ? 0 : levels[parent] + 1);
+        localTransforms.push_back(localTransform);
+        worldTransforms.push_back(localTransform);
+        dirty.push_back(1);
+        anyDirty = true;
+        levelOrderValid = false;
+        return node;
+    }
+
+    void SceneGraph::clear() {
+        parents.clear();
+        levels.clear();
+        localTransforms.clear();
+        worldTransforms.clear();
+        dirty.clear();
+        levelOrder.clear();
+        levelStart.clear();
+        anyDirty = false;
+        levelOrderValid = true;
+    }
+
+    void SceneGraph::setLocalTransform(NodeHandle node, const glm::mat4& localTransform) {
+        localTransforms[node] = localTransform;
+        dirty[node] = 1;
+        anyDirty = true;
+    }
+
+    void SceneGraph::rebuildLevelOrder() {
+        // Counting sort of node indices by level; stable, so each level keeps
+        // index order and memory access stays mostly sequential
+        uint32_t levelCount = 0;
+        for (uint32_t level : levels) levelCount = std::max(levelCount, level + 1);
+
+        levelStart.assign(levelCount + 1, 0);
+        for (uint32_t level : levels) levelStart[level + 1]++;
+        for (uint32_t l = 0; l < levelCount; l++) levelStart[l + 1] += levelStart[l];
+
+        levelOrder.resize(parents.size());
+        std::vector<uint32_t> cursor(levelStart.begin(), levelStart.end() - 1);
+        for (NodeHandle node = 0; node < parents.size(); node++) {
+            levelOrder[cursor[levels[node]]++] = node;
+        }
+        levelOrderValid = true;
+    }
+
+    uint32_t SceneGraph::updateWorldTransforms() {
+        if (!anyDirty) return 0;
+        if (!levelOrderValid) rebuildLevelOrder();
+
+        // A dirty parent dirties its whole subtree. Parents precede children in
+        // index order, so one forward pass reaches every descendant.
+        for (NodeHandle node = 0; node < parents.size(); node++) {
+            NodeHandle parent = parents[node];
+            if (parent != INVALID_NODE && dirty[parent]) dirty[node] = 1;
+        }
+
+        uint32_t updated = 0;
+        const uint32_t levelCount = static_cast<uint32_t>(levelStart.size()) - 1;
+        for (uint32_t level = 0; level < levelCount; level++) {
+            batch.clear();
+            for (uint32_t i = levelStart[level]; i < levelStart[level + 1]; i++) {
+                if (dirty[levelOrder[i]]) batch.push_back(levelOrder[i]);
+            }
+            if (batch.empty()) continue;
+
+            auto transformRange = [this](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++) {
+                    NodeHandle node = batch[i];
+                    NodeHandle parent = parents[node];
+                    if (parent == INVALID_NODE) {
+                        worldTransforms[node] = localTransforms[node];
+                    } else {
+                        multiplyMatrices(worldTransforms[parent], localTransforms[node], worldTransforms[node]);
+                    }
+                }
+            };
+
+            uint32_t count = static_cast<uint32_t>(batch.size());
+            if (parallelFor && count >= MIN_PARALLEL_BATCH) {
+                parallelFor(count, transformRange);
+            } else {
+                transformRange(0, count);
+            }
+            updated += count;
+        }
+
+        std::fill(dirty.begin(), dirty.end(), 0);
+        anyDirty = false;
+        return updated;
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    using NodeHandle = uint32_t;
+    constexpr NodeHandle INVALID_NODE = 0xFFFFFFFFu;
+
+    // Transform hierarchy stored as flat arrays (structure of arrays). A node is
+    // always created after its parent, so index order is a valid topological
+    // order and a parent's world matrix is final before any child reads it.
+    //
+    // setLocalTransform() only marks the node dirty. updateWorldTransforms()
+    // then recomputes the dirty nodes and their descendants, one hierarchy
+    // level at a time; nodes of the same level are independent and are split
+    // into batches through the parallel-for hook.
+    class SceneGraph {
+    public:
+        using RangeFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+        // Runs fn(begin, end) over [0, count), possibly on several threads
+        using ParallelFor = std::function<void(uint32_t count, const RangeFunction& fn)>;
+
+        NodeHandle createNode(NodeHandle parent = INVALID_NODE, const glm::mat4& localTransform = glm::mat4(1.0f));
+        void clear();
+
+        void setLocalTransform(NodeHandle node, const glm::mat4& localTransform);
+        const glm::mat4& getLocalTransform(NodeHandle node) const { return localTransforms[node]; }
+        const glm::mat4& getWorldTransform(NodeHandle node) const { return worldTransforms[node]; }
+        NodeHandle getParent(NodeHandle node) const { return parents[node]; }
+        uint32_t getLevel(NodeHandle node) const { return levels[node]; }
+
+        // Returns the number of world matrices that were recomputed
+        uint32_t updateWorldTransforms();
+
+        // Contiguous world matrices indexed by NodeHandle
+        const glm::mat4* getWorldTransforms() const { return worldTransforms.data(); }
+
+        uint32_t size() const { return static_cast<uint32_t>(parents.size()); }
+
+        // Defaults to running inline on the calling thread
+        void setParallelFor(ParallelFor parallelFor) { this->parallelFor = std::move(parallelFor); }
+
+    private:
+        void rebuildLevelOrder();
+
+        std::vector<NodeHandle> parents;
+        std::vector<uint32_t> levels;
+        std::vector<glm::mat4> localTransforms;
+        std::vector<glm::mat4> worldTransforms;
+        std::vector<uint8_t> dirty;
+        bool anyDirty = false;
+
+        // Node indices grouped by level, with levelStart[l] .. levelStart[l + 1]
+        // covering level l. Rebuilt lazily when nodes are added.
+        std::vector<NodeHandle> levelOrder;
+        std::vector<uint32_t> levelStart;
+        bool levelOrderValid = true;
+
+        std::vector<NodeHandle> batch; // Scratch: dirty nodes of the current level
+
+        ParallelFor parallelFor;
+    };
+}
@@ -2,7 +2,11 @@
 #include "../Renderer/VulkanDevice.h"
 #include "../Renderer/VulkanRenderer.h"
 #include "../Renderer/VulkanSwapChain.h"
+#include "../Renderer/RenderQueue.h"
 #include "../Scene/Scene.h"
+#include "../Core/JobSystem.h"
+#include "../Core/SimulationClock.h"
+#include "../Core/FramePacer.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -66,15 +70,20 @@ namespace AhnrealEngine {
         renderSceneControls();
     }
 
-    void UISystem::render() {
+    ImDrawData* UISystem::finalizeFrame() {
         ImGui::Render();
-        ImDrawData* draw_data = ImGui::GetDrawData();
-        ImGui_ImplVulkan_RenderDrawData(draw_data, renderer->getCurrentCommandBuffer());
+        return ImGui::GetDrawData();
+    }
+
+    void UISystem::render(VkCommandBuffer commandBuffer, ImDrawData* drawData) {
+        if (drawData) {
+            ImGui_ImplVulkan_RenderDrawData(drawData, commandBuffer);
+        }
     }
 
     void UISystem::cleanup() {
         if (device) {
-            vkDeviceWaitIdle(device->device());
+            device->waitIdle();
         }
         
         ImGui_ImplVulkan_Shutdown();
@@ -171,7 +180,29 @@ namespace AhnrealEngine {
                 if (isSelected) {
                     ImGui::SetItemDefaultFocus();
                 }
+
+                if (sceneManager->isLoading(scene.get())) {
+                    ImGui::SameLine();
+                    ImGui::ProgressBar(sceneManager->getLoadProgress(scene.get()), ImVec2(100.0f, 0.0f));
+                } else if (sceneManager->isResident(scene.get())) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(resident, %.1f MB)", sceneManager->getResidentBytes(scene.get()) / (1024.0 * 1024.0));
+                } else if (scene->supportsPreload()) {
+                    ImGui::SameLine();
+                    ImGui::PushID(scene.get());
+                    if (ImGui::SmallButton("Preload")) {
+                        sceneManager->preloadScene(scene->getName(), renderer);
+                    }
+                    ImGui::PopID();
+                }
             }
+
+            ImGui::Separator();
+            int budgetMB = static_cast<int>(sceneManager->getResidencyBudget() / (1024 * 1024));
+            if (ImGui::SliderInt("Residency Budget (MB)", &budgetMB, 0, 2048)) {
+                sceneManager->setResidencyBudget(static_cast<uint64_t>(budgetMB) * 1024 * 1024);
+            }
+            ImGui::Text("Inactive scenes: %.1f MB", sceneManager->getInactiveResidentBytes() / (1024.0 * 1024.0));
         }
         
         ImGui::End();
@@ -191,6 +222,58 @@ namespace AhnrealEngine {
         if (sceneManager && sceneManager->getCurrentScene()) {
             ImGui::Text("Current Scene: %s", sceneManager->getCurrentScene()->getName().c_str());
         }
+
+        if (JobSystem* jobs = JobSystem::get()) {
+            ImGui::Text("Job workers: %u (+ main thread)", jobs->getWorkerCount());
+        }
+
+        if (simulationClock) {
+            ImGui::Separator();
+            bool fixedStep = simulationClock->isFixedStep();
+            if (ImGui::Checkbox("Fixed Timestep", &fixedStep)) {
+                simulationClock->setFixedStep(fixedStep);
+            }
+            if (fixedStep) {
+                float tickRate = simulationClock->getTickRate();
+                if (ImGui::SliderFloat("Tick Rate (Hz)", &tickRate, 10.0f, 240.0f, "%.0f")) {
+                    simulationClock->setTickRate(tickRate);
+                }
+                int maxSteps = static_cast<int>(simulationClock->getMaxStepsPerFrame());
+                if (ImGui::SliderInt("Max Steps / Frame", &maxSteps, 1, 16)) {
+                    simulationClock->setMaxStepsPerFrame(static_cast<uint32_t>(maxSteps));
+                }
+                ImGui::Text("Interpolation alpha: %.2f", simulationClock->getAlpha());
+                Scene* currentScene = sceneManager ? sceneManager->getCurrentScene() : nullptr;
+                if (currentScene && !currentScene->supportsFixedTimestep()) {
+                    ImGui::TextDisabled("Current scene steps once per frame");
+                }
+            }
+            ImGui::Text("Dropped simulation time: %.2f s", simulationClock->getDroppedTime());
+        }
+
+        if (framePacer) {
+            ImGui::Separator();
+            PowerPolicy& policy = framePacer->getPolicy();
+            float currentCap = framePacer->getCurrentFrameCap();
+            if (currentCap > 0.0f) {
+                ImGui::Text("Frame cap: %.0f FPS%s", currentCap, framePacer->isIdle() ? " (idle)" : "");
+            } else {
+                ImGui::Text("Frame cap: uncapped%s", framePacer->isIdle() ? " (idle)" : "");
+            }
+            ImGui::SliderFloat("Active Cap (FPS)", &policy.activeFrameCap, 0.0f, 240.0f, "%.0f");
+            ImGui::SliderFloat("Unfocused Cap (FPS)", &policy.unfocusedFrameCap, 0.0f, 60.0f, "%.0f");
+            ImGui::Checkbox("Event-driven Redraw", &policy.eventDrivenRedraw);
+        }
+
+        const RenderQueue::Stats& queueStats = renderer->getRenderQueue().getStats();
+        if (queueStats.draws > 0) {
+            ImGui::Separator();
+            ImGui::Text("Render Queue: %u draws", queueStats.draws);
+            ImGui::Text("Binds: %u pipeline, %u descriptor, %u vertex, %u index, %u push",
+                queueStats.pipelineBinds, queueStats.descriptorBinds, queueStats.vertexBufferBinds,
+                queueStats.indexBufferBinds, queueStats.pushConstantUpdates);
+            ImGui::Text("Binds saved: %u", queueStats.bindsSaved);
+        }
         
         ImGui::End();
     }
@@ -4,11 +4,15 @@
 #include <GLFW/glfw3.h>
 #include <functional>
 
+struct ImDrawData;
+
 namespace AhnrealEngine {
 
     class VulkanDevice;
     class VulkanRenderer;
     class SceneManager;
+    class SimulationClock;
+    class FramePacer;
 
     class UISystem {
     public:
@@ -17,10 +21,14 @@ namespace AhnrealEngine {
 
         void initialize();
         void newFrame();
-        void render();
+        // Ends the UI frame; the draw data stays valid until the next newFrame()
+        ImDrawData* finalizeFrame();
+        void render(VkCommandBuffer commandBuffer, ImDrawData* drawData);
         void cleanup();
 
         void setSceneManager(SceneManager* sceneManager) { this->sceneManager = sceneManager; }
+        void setSimulationClock(SimulationClock* clock) { simulationClock = clock; }
+        void setFramePacer(FramePacer* pacer) { framePacer = pacer; }
         void setExitCallback(std::function<void()> callback) { exitCallback = callback; }
 
     private:
@@ -32,6 +40,8 @@ namespace AhnrealEngine {
         VulkanDevice* device;
         VulkanRenderer* renderer;
         SceneManager* sceneManager = nullptr;
+        SimulationClock* simulationClock = nullptr;
+        FramePacer* framePacer = nullptr;
         
         VkDescriptorPool imguiPool;
         bool showSceneSelector = true;
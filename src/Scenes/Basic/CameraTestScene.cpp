@@ -2,6 +2,7 @@
 #include "../../Engine/Core/Input.h"
 #include "../../Engine/Renderer/VulkanDevice.h"
 #include "../../Engine/Renderer/VulkanRenderer.h"
+#include "../../Engine/Renderer/RenderQueue.h"
 #include <cstring>
 #include <fstream>
 #include <imgui.h>
@@ -58,6 +59,12 @@ void CameraTestScene::initialize(VulkanRenderer *renderer) {
   createDescriptorPool();
   createDescriptorSets();
   createGraphicsPipeline(renderer);
+
+  occluderPositions.clear();
+  for (const CameraTestVertex &vertex : vertices) {
+    occluderPositions.push_back(vertex.pos);
+  }
+  occluderIndices.assign(indices.begin(), indices.end());
 }
 
 void CameraTestScene::update(float deltaTime) {
@@ -111,53 +118,79 @@ void CameraTestScene::render(VulkanRenderer *renderer) {
   if (!device || graphicsPipeline == VK_NULL_HANDLE)
     return;
 
-  VkCommandBuffer commandBuffer = renderer->getCurrentCommandBuffer();
   uint32_t currentFrame = renderer->getFrameIndex();
   VkExtent2D extent = renderer->getSwapChainExtent();
 
+  // Camera data is shared by the whole grid
+  CameraTestUBO ubo{};
+  float aspectRatio =
+      static_cast<float>(extent.width) / static_cast<float>(extent.height);
+  ubo.view = camera.getViewMatrix();
+  ubo.proj = camera.getProjectionMatrix(aspectRatio);
+  memcpy(uniformBuffersMapped[currentFrame], &ubo, sizeof(ubo));
+
   // Choose pipeline based on wireframe mode
   VkPipeline currentPipeline =
       wireframeMode ? wireframePipeline : graphicsPipeline;
-  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    currentPipeline);
 
-  VkBuffer vertexBuffers[] = {vertexBuffer};
-  VkDeviceSize offsets[] = {0};
-  vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-  vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+  DrawPacket packet{};
+  packet.pipeline = currentPipeline;
+  packet.pipelineLayout = pipelineLayout;
+  packet.descriptorSet = descriptorSets[currentFrame];
+  packet.vertexBuffer = vertexBuffer;
+  packet.indexBuffer = indexBuffer;
+  packet.indexType = VK_INDEX_TYPE_UINT16;
+  packet.indexCount = static_cast<uint32_t>(indices.size());
+  packet.pushConstantStages = VK_SHADER_STAGE_VERTEX_BIT;
+
+  uint32_t pipelineKey = SortKey::pipelineId(currentPipeline);
+  uint32_t materialKey =
+      SortKey::materialId((uint64_t)descriptorSets[currentFrame]);
+  glm::vec3 cameraPos = camera.getPosition();
+
+  if (occlusionCulling) {
+    occlusionBuffer.begin(ubo.proj * ubo.view);
+    for (int x = -gridSize / 2; x <= gridSize / 2; x++) {
+      for (int z = -gridSize / 2; z <= gridSize / 2; z++) {
+        glm::vec3 cubePos(x * gridSpacing, 0.0f, z * gridSpacing);
+        occlusionBuffer.addOccluder(
+            occluderPositions.data(), occluderIndices.data(),
+            static_cast<uint32_t>(occluderIndices.size()),
+            glm::translate(glm::mat4(1.0f), cubePos));
+      }
+    }
+    occlusionBuffer.rasterize();
+  }
+  occludedCubes = 0;
 
-  // Render grid of cubes
-  int cubeIndex = 0;
+  // Submit grid of cubes; the render queue orders them front-to-back and
+  // records the shared binds only once
+  RenderQueue &queue = renderer->getRenderQueue();
   for (int x = -gridSize / 2; x <= gridSize / 2; x++) {
     for (int z = -gridSize / 2; z <= gridSize / 2; z++) {
-      updateUniformBuffer(cubeIndex);
-
-      vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                              pipelineLayout, 0, 1,
-                              &descriptorSets[currentFrame], 0, nullptr);
-
-      // Update model matrix for this cube position
-      CameraTestUBO ubo{};
-      ubo.model = glm::translate(
-          glm::mat4(1.0f), glm::vec3(x * gridSpacing, 0.0f, z * gridSpacing));
-
-      float aspectRatio =
-          static_cast<float>(extent.width) / static_cast<float>(extent.height);
-      ubo.view = camera.getViewMatrix();
-      ubo.proj = camera.getProjectionMatrix(aspectRatio);
+      glm::vec3 cubePos(x * gridSpacing, 0.0f, z * gridSpacing);
+      if (occlusionCulling &&
+          occlusionBuffer.isOccluded(cubePos - glm::vec3(0.5f),
+                                     cubePos + glm::vec3(0.5f))) {
+        occludedCubes++;
+        continue;
+      }
 
-      memcpy(uniformBuffersMapped[currentFrame], &ubo, sizeof(ubo));
+      CameraTestPushConstants push{};
+      push.model = glm::translate(glm::mat4(1.0f), cubePos);
 
-      vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1,
-                       0, 0, 0);
-      cubeIndex++;
+      uint32_t depth =
+          SortKey::quantizeDepth(glm::length(cubePos - cameraPos),
+                                 camera.getNear(), camera.getFar());
+      packet.sortKey = SortKey::make(0, pipelineKey, materialKey, depth);
+      queue.submit(packet, &push, sizeof(push));
     }
   }
 }
 
 void CameraTestScene::cleanup() {
   if (device) {
-    vkDeviceWaitIdle(device->device());
+    device->waitIdle();
 
     for (size_t i = 0; i < uniformBuffers.size(); i++) {
       if (uniformBuffersMapped[i]) {
@@ -264,6 +297,11 @@ void CameraTestScene::onImGuiRender() {
   // Rendering settings
   ImGui::Checkbox("Wireframe Mode", &wireframeMode);
   ImGui::Checkbox("Show Grid", &showGrid);
+  ImGui::Checkbox("Occlusion Culling", &occlusionCulling);
+  if (occlusionCulling) {
+    int cubeCount = (gridSize / 2 * 2 + 1) * (gridSize / 2 * 2 + 1);
+    ImGui::Text("Occluded: %u / %d cubes", occludedCubes, cubeCount);
+  }
 
   ImGui::Separator();
 
@@ -418,16 +456,12 @@ void CameraTestScene::createDescriptorSets() {
   }
 }
 
-void CameraTestScene::updateUniformBuffer(int cubeIndex) {
-  // This is handled directly in render() for per-cube updates
-}
-
 void CameraTestScene::createGraphicsPipeline(VulkanRenderer *renderer) {
   if (!device)
     return;
 
-  // Use the same cube shaders
-  auto vertShaderCode = readFile("shaders/cube.vert.spv");
+  // Cube fragment shader, vertex shader takes the model matrix as a push constant
+  auto vertShaderCode = readFile("shaders/camera_test.vert.spv");
   auto fragShaderCode = readFile("shaders/cube.frag.spv");
 
   VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
@@ -524,7 +558,12 @@ void CameraTestScene::createGraphicsPipeline(VulkanRenderer *renderer) {
   pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
   pipelineLayoutInfo.setLayoutCount = 1;
   pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-  pipelineLayoutInfo.pushConstantRangeCount = 0;
+  VkPushConstantRange pushConstantRange{};
+  pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+  pushConstantRange.offset = 0;
+  pushConstantRange.size = sizeof(CameraTestPushConstants);
+  pipelineLayoutInfo.pushConstantRangeCount = 1;
+  pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
   if (vkCreatePipelineLayout(device->device(), &pipelineLayoutInfo, nullptr,
                              &pipelineLayout) != VK_SUCCESS) {
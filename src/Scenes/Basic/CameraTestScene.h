@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../Engine/Core/Camera.h"
+#include "../../Engine/Core/OcclusionBuffer.h"
 #include "../../Engine/Scene/Scene.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -24,11 +25,15 @@ struct CameraTestVertex {
 };
 
 struct CameraTestUBO {
-  glm::mat4 model;
   glm::mat4 view;
   glm::mat4 proj;
 };
 
+// Per-cube data, pushed with each draw packet (see camera_test.vert)
+struct CameraTestPushConstants {
+  glm::mat4 model;
+};
+
 class CameraTestScene : public Scene {
 public:
   CameraTestScene();
@@ -40,6 +45,8 @@ public:
   void render(VulkanRenderer *renderer) override;
   void cleanup() override;
   void onImGuiRender() override;
+  // The camera only moves while input is held
+  bool needsContinuousRedraw() const override { return false; }
 
   void setDevice(VulkanDevice *dev) { device = dev; }
 
@@ -53,7 +60,6 @@ private:
   void createDescriptorSetLayout();
   void createDescriptorPool();
   void createDescriptorSets();
-  void updateUniformBuffer(int cubeIndex);
   void createGraphicsPipeline(VulkanRenderer *renderer);
 
   VulkanDevice *device = nullptr;
@@ -69,7 +75,7 @@ private:
   VkBuffer indexBuffer = VK_NULL_HANDLE;
   VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
 
-  // One UBO per cube (or use dynamic UBO)
+  // One camera UBO per frame in flight; cubes differ only by push constants
   std::vector<VkBuffer> uniformBuffers;
   std::vector<VkDeviceMemory> uniformBuffersMemory;
   std::vector<void *> uniformBuffersMapped;
@@ -108,6 +114,14 @@ private:
                                    // Top face
                                    3, 2, 6, 6, 7, 3};
 
+  // The cubes occlude each other: all of them are rasterized into the CPU
+  // depth buffer, then each is tested before it is submitted
+  bool occlusionCulling = false;
+  uint32_t occludedCubes = 0;
+  OcclusionBuffer occlusionBuffer;
+  std::vector<glm::vec3> occluderPositions;
+  std::vector<uint32_t> occluderIndices;
+
   // UI settings
   float cameraSpeed = 5.0f;
   float mouseSensitivity = 0.1f;
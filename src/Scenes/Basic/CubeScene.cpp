@@ -77,8 +77,20 @@ namespace AhnrealEngine {
     void CubeScene::render(VulkanRenderer* renderer) {
         if (!device || graphicsPipeline == VK_NULL_HANDLE) return;
 
-        VkCommandBuffer commandBuffer = renderer->getCurrentCommandBuffer();
+        if (!useStaticCommandBuffers) {
+            recordDraw(renderer->getPassCommandBuffer(), static_cast<uint32_t>(renderer->getFrameIndex()));
+            return;
+        }
+
+        if (!staticCommands) {
+            staticCommands = std::make_unique<StaticCommandCache>(device);
+        }
+        staticCommands->execute(renderer, [this](VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+            recordDraw(commandBuffer, frameIndex);
+        });
+    }
 
+    void CubeScene::recordDraw(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
         // Choose pipeline based on wireframe mode
         VkPipeline currentPipeline = wireframeMode ? wireframePipeline : graphicsPipeline;
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, currentPipeline);
@@ -88,9 +100,8 @@ namespace AhnrealEngine {
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
         vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
 
-        uint32_t currentFrame = renderer->getFrameIndex();
         vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 
-            pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+            pipelineLayout, 0, 1, &descriptorSets[frameIndex], 0, nullptr);
 
         vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
     }
@@ -98,7 +109,10 @@ namespace AhnrealEngine {
     void CubeScene::cleanup() {
         if (device) {
             // Wait for device to be idle before cleanup
-            vkDeviceWaitIdle(device->device());
+            device->waitIdle();
+
+            // Cached commands reference the pipelines and buffers destroyed below
+            staticCommands.reset();
             
             // Cleanup uniform buffers - unmap first, then destroy
             for (size_t i = 0; i < uniformBuffers.size(); i++) {
@@ -200,7 +214,13 @@ namespace AhnrealEngine {
 
         // Rendering settings
         ImGui::Text("Rendering Settings:");
-        ImGui::Checkbox("Wireframe Mode", &wireframeMode);
+        if (ImGui::Checkbox("Wireframe Mode", &wireframeMode) && staticCommands) {
+            staticCommands->markDirty();
+        }
+        ImGui::Checkbox("Static Command Buffers", &useStaticCommandBuffers);
+        if (useStaticCommandBuffers && staticCommands) {
+            ImGui::Text("Recordings: %u", staticCommands->getRecordCount());
+        }
 
         ImGui::Separator();
         ImGui::Text("Cube Info:");
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../Engine/Scene/Scene.h"
+#include "../../Engine/Renderer/StaticCommandCache.h"
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -37,6 +38,7 @@ namespace AhnrealEngine {
         void render(VulkanRenderer* renderer) override;
         void cleanup() override;
         void onImGuiRender() override;
+        bool usesStaticCommandBuffers() const override { return useStaticCommandBuffers; }
 
         void setDevice(VulkanDevice* dev) { device = dev; }
 
@@ -50,6 +52,7 @@ namespace AhnrealEngine {
         void updateUniformBuffer();
         void createGraphicsPipeline(VulkanRenderer* renderer);
         void updateVertexColors();
+        void recordDraw(VkCommandBuffer commandBuffer, uint32_t frameIndex);
 
         VulkanDevice* device = nullptr;
         
@@ -109,6 +112,11 @@ namespace AhnrealEngine {
         bool colorChanged = false;
         bool useBarycentricColors = false;
         bool lastUseBarycentricColors = false;
+
+        // Rotation lives in the uniform buffer and colors are rewritten in
+        // place, so cached commands only go stale on a pipeline switch
+        bool useStaticCommandBuffers = false;
+        std::unique_ptr<StaticCommandCache> staticCommands;
         
         VkShaderModule createShaderModule(const std::vector<char>& code);
         std::vector<char> readFile(const std::string& filename);
@@ -5,7 +5,9 @@
 #include <imgui.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <chrono>
+#include <cstddef>
 #include <fstream>
+#include <initializer_list>
 #include <iostream>
 
 namespace AhnrealEngine {
@@ -20,24 +22,37 @@ ModelLoadingScene::~ModelLoadingScene() {
 
 void ModelLoadingScene::initialize() { }
 
+void ModelLoadingScene::prepare(VulkanRenderer* renderer, LoadProgress& progress) {
+    device = renderer->getDevice();
+    progress.set(0.1f);
+    loadModel();
+    progress.set(0.9f);
+}
+
 void ModelLoadingScene::initialize(VulkanRenderer* renderer) {
     device = renderer->getDevice();
 
-    // 1. Create Model (Load Async or Sync)
-    // For now, we load synchronously. User should provide a valid path.
+    // Already loaded when the scene was preloaded
+    if (!model) {
+        loadModel();
+    }
+
+    createDescriptorSetLayout(renderer);
+    createUniformBuffers();
+    createGraphicsPipeline(renderer);
+}
+
+void ModelLoadingScene::loadModel() {
+    // User should provide a valid path.
     // We will create a dummy file if it doesn't exist for testing.
     try {
         model = std::make_unique<Model>(device, modelPath);
+        rootLocalTransform = model->getSceneGraph().getLocalTransform(model->getRootNode());
+        appliedRotation = 0.0f;
     } catch (const std::exception& e) {
         std::cerr << "Failed to load model: " << e.what() << std::endl;
         // In a real engine, we might load a fallback model or show an error
     }
-
-    createDescriptorSetLayout();
-    createUniformBuffers();
-    createDescriptorPool();
-    createDescriptorSets();
-    createGraphicsPipeline(renderer);
 }
 
 void ModelLoadingScene::update(float deltaTime) {
@@ -63,30 +78,110 @@ void ModelLoadingScene::update(float deltaTime) {
     if (autoRotate) {
         currentRotation += rotationSpeed * deltaTime;
     }
+
+    float nodeRotation = useStaticCommandBuffers ? 0.0f : currentRotation;
+    if (model && nodeRotation != appliedRotation) {
+        glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), nodeRotation, glm::vec3(0.0f, 1.0f, 0.0f));
+        model->getSceneGraph().setLocalTransform(model->getRootNode(), rotation * rootLocalTransform);
+        appliedRotation = nodeRotation;
+
+        // World matrices are baked into the cached commands
+        if (staticCommands) {
+            staticCommands->markDirty();
+        }
+    }
 }
 
 void ModelLoadingScene::render(VulkanRenderer* renderer) {
     if (!model || graphicsPipeline == VK_NULL_HANDLE) return;
 
-    VkCommandBuffer commandBuffer = renderer->getCurrentCommandBuffer();
     uint32_t currentFrame = renderer->getFrameIndex();
     
     // Update UBO
     updateUniformBuffer(currentFrame);
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    if (useStaticCommandBuffers) {
+        if (!staticCommands) {
+            createPersistentDescriptorSets();
+            staticCommands = std::make_unique<StaticCommandCache>(device);
+        }
+        staticCommands->execute(renderer, [this](VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                pipelineLayout, 0, 1, &persistentSets[frameIndex], 0, nullptr);
+            if (depthPrepass) {
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPrepassPipeline);
+                drawModel(commandBuffer, nullptr, VertexStreams::PositionOnly);
+            }
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                depthPrepass ? shadingAfterPrepassPipeline : graphicsPipeline);
+            drawModel(commandBuffer, nullptr, VertexStreams::All);
+        });
+        return;
+    }
+
+    VkCommandBuffer commandBuffer = renderer->getPassCommandBuffer();
+
+    // Transient set: reset together with the frame's pools, no explicit free
+    VkDescriptorSet descriptorSet = renderer->getFrameDescriptorAllocator().allocate(descriptorSetLayout);
+    UboDescriptorData descriptorData{{ uniformBuffers[currentFrame], 0, sizeof(UniformBufferObject) }};
+    uboUpdateTemplate->update(descriptorSet, &descriptorData);
 
+    // Every pipeline shares the layout, so the set stays bound across them
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 
-        pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+        pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+
+    // ubo.model is identity here, so node world space is world space
+    Frustum frustum;
+    if (frustumCulling) {
+        VkExtent2D extent = renderer->getSwapChainExtent();
+        float aspectRatio = (float)extent.width / (float)extent.height;
+        frustum = Frustum::fromCamera(camera, aspectRatio);
+        if (occlusionCulling) {
+            occlusionBuffer.begin(camera.getProjectionMatrix(aspectRatio) * camera.getViewMatrix());
+            occluderInstances = model->addOccluders(occlusionBuffer, frustum, camera.getPosition(),
+                static_cast<uint32_t>(occluderTriangleBudget));
+            occlusionBuffer.rasterize();
+        }
+    }
+
+    // Both passes cull the same way, so they draw the same instances
+    if (depthPrepass) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPrepassPipeline);
+        drawModel(commandBuffer, frustumCulling ? &frustum : nullptr, VertexStreams::PositionOnly);
+    }
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+        depthPrepass ? shadingAfterPrepassPipeline : graphicsPipeline);
+    drawnInstances = drawModel(commandBuffer, frustumCulling ? &frustum : nullptr, VertexStreams::All);
+}
+
+uint32_t ModelLoadingScene::drawModel(VkCommandBuffer commandBuffer, const Frustum* frustum, VertexStreams streams) {
+    if (frustum) {
+        return model->draw(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, *frustum,
+            occlusionCulling ? &occlusionBuffer : nullptr, streams);
+    }
+    model->draw(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, streams);
+    return static_cast<uint32_t>(model->getInstances().size());
+}
 
-    model->draw(commandBuffer);
+void ModelLoadingScene::createPersistentDescriptorSets() {
+    persistentDescriptors = std::make_unique<DescriptorAllocator>(device, static_cast<uint32_t>(uniformBuffers.size()));
+    persistentSets.resize(uniformBuffers.size());
+    for (size_t i = 0; i < uniformBuffers.size(); i++) {
+        persistentSets[i] = persistentDescriptors->allocate(descriptorSetLayout);
+        UboDescriptorData descriptorData{{ uniformBuffers[i], 0, sizeof(UniformBufferObject) }};
+        uboUpdateTemplate->update(persistentSets[i], &descriptorData);
+    }
 }
 
 void ModelLoadingScene::updateUniformBuffer(uint32_t currentFrame) {
     UniformBufferObject ubo{};
     
-    // Model matrix
-    ubo.model = glm::rotate(glm::mat4(1.0f), currentRotation, glm::vec3(0.0f, 1.0f, 0.0f));
+    // Rotation is applied to the root node of the model hierarchy instead, so
+    // the whole subtree is re-propagated only when it actually changes.
+    // Cached commands keep the hierarchy fixed and rotate here.
+    ubo.model = useStaticCommandBuffers
+        ? glm::rotate(glm::mat4(1.0f), currentRotation, glm::vec3(0.0f, 1.0f, 0.0f))
+        : glm::mat4(1.0f);
     
     // View/Proj
     ubo.view = camera.getViewMatrix();
@@ -112,6 +207,39 @@ void ModelLoadingScene::onImGuiRender() {
     ImGui::SliderFloat("Rotation Speed", &rotationSpeed, 0.0f, 5.0f);
     ImGui::SliderFloat("Manual Rotation", &currentRotation, 0.0f, glm::two_pi<float>());
 
+    ImGui::Separator();
+    // Static command buffers replay the whole model, so culling is ignored
+    ImGui::BeginDisabled(useStaticCommandBuffers);
+    ImGui::Checkbox("Frustum Culling", &frustumCulling);
+    if (frustumCulling) {
+        ImGui::Checkbox("Occlusion Culling", &occlusionCulling);
+        if (occlusionCulling) {
+            ImGui::SliderInt("Occluder Triangles", &occluderTriangleBudget, 1024, 262144, "%d", ImGuiSliderFlags_Logarithmic);
+            if (!useStaticCommandBuffers) {
+                ImGui::Text("Occluders: %u instances, %u / %u triangles rasterized (%ux%u)", occluderInstances,
+                    occlusionBuffer.getRasterizedTriangleCount(), occlusionBuffer.getOccluderTriangleCount(),
+                    occlusionBuffer.getWidth(), occlusionBuffer.getHeight());
+            }
+        }
+    }
+    ImGui::EndDisabled();
+    if (useStaticCommandBuffers) {
+        ImGui::TextDisabled("Culling off: cached commands are never culled");
+    }
+    if (model) {
+        ImGui::Text("Drawn: %u / %zu mesh instances", useStaticCommandBuffers ? static_cast<uint32_t>(model->getInstances().size()) : drawnInstances,
+            model->getInstances().size());
+    }
+
+    ImGui::Separator();
+    if (ImGui::Checkbox("Depth Pre-pass", &depthPrepass) && staticCommands) {
+        staticCommands->markDirty();
+    }
+    ImGui::Checkbox("Static Command Buffers", &useStaticCommandBuffers);
+    if (useStaticCommandBuffers && staticCommands) {
+        ImGui::Text("Recordings: %u", staticCommands->getRecordCount());
+    }
+
     ImGui::Separator();
     ImGui::Text("Camera:");
     glm::vec3 pos = camera.getPosition();
@@ -154,25 +282,25 @@ void ModelLoadingScene::onImGuiRender() {
 
 void ModelLoadingScene::cleanup() {
     if (device) {
-        vkDeviceWaitIdle(device->device());
+        device->waitIdle();
 
-        if (graphicsPipeline != VK_NULL_HANDLE) {
-            vkDestroyPipeline(device->device(), graphicsPipeline, nullptr);
-            graphicsPipeline = VK_NULL_HANDLE;
+        staticCommands.reset();
+        persistentSets.clear();
+        persistentDescriptors.reset();
+
+        for (VkPipeline* pipeline : { &graphicsPipeline, &depthPrepassPipeline, &shadingAfterPrepassPipeline }) {
+            if (*pipeline != VK_NULL_HANDLE) {
+                vkDestroyPipeline(device->device(), *pipeline, nullptr);
+                *pipeline = VK_NULL_HANDLE;
+            }
         }
         if (pipelineLayout != VK_NULL_HANDLE) {
             vkDestroyPipelineLayout(device->device(), pipelineLayout, nullptr);
             pipelineLayout = VK_NULL_HANDLE;
         }
 
-        if (descriptorPool != VK_NULL_HANDLE) {
-            vkDestroyDescriptorPool(device->device(), descriptorPool, nullptr);
-            descriptorPool = VK_NULL_HANDLE;
-        }
-        if (descriptorSetLayout != VK_NULL_HANDLE) {
-            vkDestroyDescriptorSetLayout(device->device(), descriptorSetLayout, nullptr);
-            descriptorSetLayout = VK_NULL_HANDLE;
-        }
+        uboUpdateTemplate.reset();
+        descriptorSetLayout = VK_NULL_HANDLE; // Owned by the layout cache
 
         for (size_t i = 0; i < uniformBuffers.size(); i++) {
             vkDestroyBuffer(device->device(), uniformBuffers[i], nullptr);
@@ -181,28 +309,29 @@ void ModelLoadingScene::cleanup() {
         uniformBuffers.clear();
         uniformBuffersMemory.clear();
         uniformBuffersMapped.clear();
+
+        // Released here rather than on destruction so an evicted scene
+        // gives its mesh memory back
+        model.reset();
     }
-    // Model is unique_ptr, handled automatically
 }
 
-void ModelLoadingScene::createDescriptorSetLayout() {
+void ModelLoadingScene::createDescriptorSetLayout(VulkanRenderer* renderer) {
     VkDescriptorSetLayoutBinding uboLayoutBinding{};
     uboLayoutBinding.binding = 0;
     uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     uboLayoutBinding.descriptorCount = 1;
     uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-    
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = 1;
-    layoutInfo.pBindings = &uboLayoutBinding;
 
-    if (vkCreateDescriptorSetLayout(device->device(), &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create descriptor set layout!");
-    }
+    descriptorSetLayout = renderer->getDescriptorLayoutCache().getLayout({ uboLayoutBinding });
+
+    uboUpdateTemplate = std::make_unique<DescriptorUpdateTemplate>(device, descriptorSetLayout,
+        std::vector<VkDescriptorUpdateTemplateEntry>{
+            DescriptorUpdateTemplate::bufferEntry(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, offsetof(UboDescriptorData, ubo))
+        });
 }
 
-// ... Boilerplate for uniform buffers, descriptor pool/sets (copied from Triangle/Cube scene pattern)
+// ... Boilerplate for uniform buffers (copied from Triangle/Cube scene pattern)
 void ModelLoadingScene::createUniformBuffers() {
     VkDeviceSize bufferSize = sizeof(UniformBufferObject);
     uniformBuffers.resize(2);
@@ -217,62 +346,40 @@ void ModelLoadingScene::createUniformBuffers() {
     }
 }
 
-void ModelLoadingScene::createDescriptorPool() {
-    VkDescriptorPoolSize poolSize{};
-    poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSize.descriptorCount = 2; // frames in flight
-
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = 1;
-    poolInfo.pPoolSizes = &poolSize;
-    poolInfo.maxSets = 2;
+void ModelLoadingScene::createGraphicsPipeline(VulkanRenderer* renderer) {
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
 
-    if (vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create descriptor pool!");
-    }
-}
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(glm::mat4);
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-void ModelLoadingScene::createDescriptorSets() {
-    std::vector<VkDescriptorSetLayout> layouts(2, descriptorSetLayout);
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = 2;
-    allocInfo.pSetLayouts = layouts.data();
-
-    descriptorSets.resize(2);
-    if (vkAllocateDescriptorSets(device->device(), &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate descriptor sets!");
+    if (vkCreatePipelineLayout(device->device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
     }
 
-    for (size_t i = 0; i < 2; i++) {
-        VkDescriptorBufferInfo bufferInfo{};
-        bufferInfo.buffer = uniformBuffers[i];
-        bufferInfo.offset = 0;
-        bufferInfo.range = sizeof(UniformBufferObject);
-
-        VkWriteDescriptorSet descriptorWrite{};
-        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = descriptorSets[i];
-        descriptorWrite.dstBinding = 0;
-        descriptorWrite.dstArrayElement = 0;
-        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        descriptorWrite.descriptorCount = 1;
-        descriptorWrite.pBufferInfo = &bufferInfo;
-
-        vkUpdateDescriptorSets(device->device(), 1, &descriptorWrite, 0, nullptr);
-    }
+    graphicsPipeline = createPipeline(renderer, PipelineKind::Shading);
+    depthPrepassPipeline = createPipeline(renderer, PipelineKind::DepthPrepass);
+    shadingAfterPrepassPipeline = createPipeline(renderer, PipelineKind::ShadingAfterPrepass);
 }
 
-void ModelLoadingScene::createGraphicsPipeline(VulkanRenderer* renderer) {
-    // Reuse cube shaders for now as they support basic 3D projection
-    // Ideally we should create a new shader for models (e.g., with normal support)
-    auto vertShaderCode = readFile("shaders/cube.vert.spv"); 
-    auto fragShaderCode = readFile("shaders/cube.frag.spv"); 
+VkPipeline ModelLoadingScene::createPipeline(VulkanRenderer* renderer, PipelineKind kind) {
+    const bool depthOnly = kind == PipelineKind::DepthPrepass;
 
+    // model.vert applies the per-node world matrix; the cube fragment shader is reused.
+    // The pre-pass has no fragment stage, depth comes from the rasterizer.
+    auto vertShaderCode = readFile(depthOnly ? "shaders/model_depth.vert.spv" : "shaders/model.vert.spv");
     VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+    VkShaderModule fragShaderModule = VK_NULL_HANDLE;
+    if (!depthOnly) {
+        auto fragShaderCode = readFile("shaders/cube.frag.spv");
+        fragShaderModule = createShaderModule(fragShaderCode);
+    }
 
     VkPipelineShaderStageCreateInfo shaderStages[] = {
         { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertShaderModule, "main", nullptr },
@@ -280,13 +387,21 @@ void ModelLoadingScene::createGraphicsPipeline(VulkanRenderer* renderer) {
     };
 
     // Vertex Input State - USING MESH VERTEX DEFINITION
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    // The pre-pass only fetches the tightly packed position stream
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions;
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+    if (depthOnly) {
+        bindingDescriptions = { Vertex::getPositionBindingDescription() };
+        attributeDescriptions = { Vertex::getPositionAttributeDescription() };
+    } else {
+        bindingDescriptions = Vertex::getBindingDescriptions();
+        attributeDescriptions = Vertex::getAttributeDescriptions();
+    }
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
@@ -315,14 +430,16 @@ void ModelLoadingScene::createGraphicsPipeline(VulkanRenderer* renderer) {
     multisampling.sampleShadingEnable = VK_FALSE;
     multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 
+    // After the pre-pass the depth buffer is final: shade only the surface
+    // that won, without writing depth again
     VkPipelineDepthStencilStateCreateInfo depthStencil{};
     depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
     depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_TRUE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthWriteEnable = kind == PipelineKind::ShadingAfterPrepass ? VK_FALSE : VK_TRUE;
+    depthStencil.depthCompareOp = kind == PipelineKind::ShadingAfterPrepass ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_LESS;
 
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.colorWriteMask = depthOnly ? 0 : VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
     colorBlendAttachment.blendEnable = VK_FALSE;
 
     VkPipelineColorBlendStateCreateInfo colorBlending{};
@@ -337,18 +454,9 @@ void ModelLoadingScene::createGraphicsPipeline(VulkanRenderer* renderer) {
     dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
     dynamicState.pDynamicStates = dynamicStates.data();
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-
-    if (vkCreatePipelineLayout(device->device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
-
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
+    pipelineInfo.stageCount = depthOnly ? 1 : 2;
     pipelineInfo.pStages = shaderStages;
     pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
@@ -362,12 +470,16 @@ void ModelLoadingScene::createGraphicsPipeline(VulkanRenderer* renderer) {
     pipelineInfo.renderPass = renderer->getSwapChainRenderPass();
     pipelineInfo.subpass = 0;
 
-    if (vkCreateGraphicsPipelines(device->device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(device->device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
 
-    vkDestroyShaderModule(device->device(), fragShaderModule, nullptr);
+    if (fragShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device->device(), fragShaderModule, nullptr);
+    }
     vkDestroyShaderModule(device->device(), vertShaderModule, nullptr);
+    return pipeline;
 }
 
 VkShaderModule ModelLoadingScene::createShaderModule(const std::vector<char>& code) {
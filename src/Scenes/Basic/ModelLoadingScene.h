@@ -2,7 +2,10 @@
 
 #include "../../Engine/Scene/Scene.h"
 #include "../../Engine/Core/Camera.h"
+#include "../../Engine/Core/OcclusionBuffer.h"
 #include "../../Engine/Renderer/Model.h"
+#include "../../Engine/Renderer/DescriptorAllocator.h"
+#include "../../Engine/Renderer/StaticCommandCache.h"
 #include <memory>
 #include <vulkan/vulkan.h>
 
@@ -19,13 +22,26 @@ public:
     void render(VulkanRenderer* renderer) override;
     void cleanup() override;
     void onImGuiRender() override;
+    bool usesStaticCommandBuffers() const override { return useStaticCommandBuffers; }
+
+    // The Assimp import and mesh uploads run in prepare()
+    bool supportsPreload() const override { return true; }
+    void prepare(VulkanRenderer* renderer, LoadProgress& progress) override;
 
 private:
+    // Pipelines drawn with the same layout. The depth pre-pass writes depth
+    // from the position stream alone; shading then only runs for the
+    // fragment that is already in the depth buffer.
+    enum class PipelineKind { Shading, DepthPrepass, ShadingAfterPrepass };
+
+    void loadModel();
+    // Without a frustum every instance is drawn
+    uint32_t drawModel(VkCommandBuffer commandBuffer, const Frustum* frustum, VertexStreams streams);
     void createGraphicsPipeline(VulkanRenderer* renderer);
-    void createDescriptorSetLayout();
-    void createDescriptorPool();
+    VkPipeline createPipeline(VulkanRenderer* renderer, PipelineKind kind);
+    void createDescriptorSetLayout(VulkanRenderer* renderer);
     void createUniformBuffers();
-    void createDescriptorSets();
+    void createPersistentDescriptorSets();
     void updateUniformBuffer(uint32_t currentFrame);
 
     VkShaderModule createShaderModule(const std::vector<char>& code);
@@ -41,10 +57,19 @@ private:
     // Vulkan resources
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
     VkPipeline graphicsPipeline = VK_NULL_HANDLE;
+    VkPipeline depthPrepassPipeline = VK_NULL_HANDLE;
+    VkPipeline shadingAfterPrepassPipeline = VK_NULL_HANDLE;
     
+    // Layout is owned by the renderer's layout cache. The set itself is
+    // allocated each frame from the transient allocator and written with the
+    // update template, so the scene keeps no pool of its own.
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
-    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
-    std::vector<VkDescriptorSet> descriptorSets;
+    std::unique_ptr<DescriptorUpdateTemplate> uboUpdateTemplate;
+
+    // Data layout consumed by uboUpdateTemplate
+    struct UboDescriptorData {
+        VkDescriptorBufferInfo ubo;
+    };
 
     struct UniformBufferObject {
         glm::mat4 model;
@@ -62,8 +87,34 @@ private:
     
     // UI Settings
     bool autoRotate = false;
+    // Per mesh instance against the camera frustum; not applied to cached
+    // command buffers, which are only re-recorded when the hierarchy changes
+    bool frustumCulling = true;
+    uint32_t drawnInstances = 0;
+    // On top of frustum culling: the largest visible instances are
+    // rasterized into a CPU depth buffer that the rest are tested against
+    bool occlusionCulling = false;
+    int occluderTriangleBudget = 32768;
+    uint32_t occluderInstances = 0;
+    OcclusionBuffer occlusionBuffer;
+    // Lay down depth first so each pixel is shaded once, at the cost of
+    // transforming every visible vertex twice
+    bool depthPrepass = false;
     float rotationSpeed = 1.0f;
     float currentRotation = 0.0f;
+
+    // Root node transform as loaded, and the rotation last written on top of it
+    glm::mat4 rootLocalTransform = glm::mat4(1.0f);
+    float appliedRotation = 0.0f;
+
+    // Node world matrices are recorded as push constants, so with static
+    // command buffers the rotation goes through ubo.model instead and the
+    // hierarchy stays as loaded. Cached commands can't use transient sets;
+    // one set per frame is allocated here and written once.
+    bool useStaticCommandBuffers = false;
+    std::unique_ptr<StaticCommandCache> staticCommands;
+    std::unique_ptr<DescriptorAllocator> persistentDescriptors;
+    std::vector<VkDescriptorSet> persistentSets;
 };
 
 } // namespace AhnrealEngine
@@ -83,10 +83,6 @@ namespace AhnrealEngine {
             return;
         }
 
-        VkCommandBuffer commandBuffer = renderer->getCurrentCommandBuffer();
-        
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-
         // Create rotation matrix
         float cosAngle = std::cos(currentRotation);
         float sinAngle = std::sin(currentRotation);
@@ -101,6 +97,26 @@ namespace AhnrealEngine {
         pushConstants.color = triangleColor;
         pushConstants.useBarycentricColors = useBarycentricColors ? 1 : 0;
 
+        if (!useStaticCommandBuffers) {
+            recordDraw(renderer->getPassCommandBuffer(), pushConstants);
+            return;
+        }
+
+        if (!staticCommands) {
+            staticCommands = std::make_unique<StaticCommandCache>(device);
+        }
+        if (std::memcmp(&pushConstants, &recordedPushConstants, sizeof(PushConstantData)) != 0) {
+            recordedPushConstants = pushConstants;
+            staticCommands->markDirty();
+        }
+        staticCommands->execute(renderer, [this](VkCommandBuffer commandBuffer, uint32_t) {
+            recordDraw(commandBuffer, recordedPushConstants);
+        });
+    }
+
+    void TriangleScene::recordDraw(VkCommandBuffer commandBuffer, const PushConstantData& pushConstants) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+
         vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstantData), &pushConstants);
 
         VkBuffer vertexBuffers[] = {vertexBuffer};
@@ -115,9 +131,12 @@ namespace AhnrealEngine {
         if (device) {
             std::cout << "Device exists, waiting for idle..." << std::endl;
             // Wait for device to be idle before cleanup
-            vkDeviceWaitIdle(device->device());
+            device->waitIdle();
             std::cout << "Device idle complete" << std::endl;
 
+            // Cached commands reference the pipeline destroyed below
+            staticCommands.reset();
+
             if (graphicsPipeline != VK_NULL_HANDLE) {
                 std::cout << "Destroying graphics pipeline..." << std::endl;
                 vkDestroyPipeline(device->device(), graphicsPipeline, nullptr);
@@ -162,6 +181,15 @@ namespace AhnrealEngine {
         if (ImGui::Button("Reset Rotation")) {
             currentRotation = 0.0f;
         }
+
+        ImGui::Separator();
+        ImGui::Checkbox("Static Command Buffers", &useStaticCommandBuffers);
+        if (useStaticCommandBuffers && staticCommands) {
+            ImGui::Text("Recordings: %u", staticCommands->getRecordCount());
+            if (rotationSpeed != 0.0f) {
+                ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "Rotation changes push constants: re-recorded every frame");
+            }
+        }
         
         ImGui::Separator();
         ImGui::Text("Vertices:");
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../Engine/Scene/Scene.h"
+#include "../../Engine/Renderer/StaticCommandCache.h"
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 #include <vector>
@@ -30,6 +31,8 @@ namespace AhnrealEngine {
         void render(VulkanRenderer* renderer) override;
         void cleanup() override;
         void onImGuiRender() override;
+        bool needsContinuousRedraw() const override { return rotationSpeed != 0.0f; }
+        bool usesStaticCommandBuffers() const override { return useStaticCommandBuffers; }
 
         void setDevice(VulkanDevice* dev) { device = dev; }
 
@@ -43,6 +46,7 @@ namespace AhnrealEngine {
 
         void createVertexBuffer();
         void createGraphicsPipeline(VulkanRenderer* renderer);
+        void recordDraw(VkCommandBuffer commandBuffer, const PushConstantData& pushConstants);
 
         VulkanDevice* device = nullptr;
         
@@ -62,6 +66,12 @@ namespace AhnrealEngine {
         float rotationSpeed = 1.0f;
         float currentRotation = 0.0f;
         bool useBarycentricColors = false;
+
+        // Push constants are baked into the cached commands, so they are
+        // re-recorded whenever the transform or color changes
+        bool useStaticCommandBuffers = false;
+        std::unique_ptr<StaticCommandCache> staticCommands;
+        PushConstantData recordedPushConstants{};
         
         VkShaderModule createShaderModule(const std::vector<char>& code);
         std::vector<char> readFile(const std::string& filename);
@@ -0,0 +1,417 @@
+#include "ClusteredLightingScene.h"
+#include "../../Engine/Renderer/VulkanRenderer.h"
+#include "../../Engine/Renderer/VulkanDevice.h"
+#include "../../Engine/Renderer/VulkanSwapChain.h"
+#include "../../Engine/Core/Input.h"
+#include <imgui.h>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace AhnrealEngine {
+
+    static std::vector<char> readShaderFile(const std::string& filename) {
+        std::vector<std::string> paths = {
+            "build/Debug/" + filename,
+            "../shaders/" + filename,
+            "../../shaders/" + filename,
+            "shaders/" + filename,
+            filename
+        };
+
+        for (const auto& path : paths) {
+            std::ifstream file(path, std::ios::ate | std::ios::binary);
+            if (file.is_open()) {
+                size_t fileSize = (size_t)file.tellg();
+                std::vector<char> buffer(fileSize);
+                file.seekg(0);
+                file.read(buffer.data(), fileSize);
+                return buffer;
+            }
+        }
+        throw std::runtime_error("Failed to find/open shader file: " + filename);
+    }
+
+    static VkShaderModule createShaderModule(VkDevice device, const std::string& filename) {
+        auto code = readShaderFile(filename);
+        VkShaderModuleCreateInfo createInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, nullptr, 0, code.size(), reinterpret_cast<const uint32_t*>(code.data())};
+        VkShaderModule module;
+        if (vkCreateShaderModule(device, &createInfo, nullptr, &module) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shader module!");
+        }
+        return module;
+    }
+
+    // Square of side 2 * halfSize facing normal, counter-clockwise seen from
+    // that side; tangent and cross(normal, tangent) span it
+    static void addQuad(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                        const glm::vec3& center, const glm::vec3& normal, const glm::vec3& tangent, float halfSize) {
+        const glm::vec3 bitangent = glm::cross(normal, tangent);
+        const uint32_t first = static_cast<uint32_t>(vertices.size());
+        const glm::vec2 corners[] = { {-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f} };
+        for (const glm::vec2& corner : corners) {
+            Vertex vertex{};
+            vertex.position = center + (tangent * corner.x + bitangent * corner.y) * halfSize;
+            vertex.normal = normal;
+            vertex.texCoord = corner * 0.5f + 0.5f;
+            vertex.tangent = tangent;
+            vertex.bitangent = bitangent;
+            vertices.push_back(vertex);
+        }
+        indices.insert(indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+    }
+
+    ClusteredLightingScene::ClusteredLightingScene()
+        : Scene("Clustered Lighting"), camera(glm::vec3(0.0f, 20.0f, 80.0f)) {
+        camera.setFar(300.0f);
+    }
+
+    ClusteredLightingScene::~ClusteredLightingScene() {
+        cleanup();
+    }
+
+    void ClusteredLightingScene::initialize() {
+        // Required by base class but we use initialize(renderer)
+    }
+
+    void ClusteredLightingScene::prepare(VulkanRenderer* renderer, LoadProgress& progress) {
+        device = renderer->getDevice();
+
+        createMeshes();
+        createLightSources();
+        progress.set(0.5f);
+
+        createBuffers();
+        progress.set(0.9f);
+    }
+
+    void ClusteredLightingScene::initialize(VulkanRenderer* renderer) {
+        device = renderer->getDevice();
+
+        // Already done when the scene was preloaded
+        if (!boxMesh) {
+            LoadProgress progress;
+            prepare(renderer, progress);
+        }
+
+        lighting = std::make_unique<ClusteredLighting>(device, MAX_LIGHTS);
+        createDescriptors();
+        createPipeline(renderer);
+    }
+
+    void ClusteredLightingScene::createMeshes() {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+
+        // Unit box, one quad per face so every face gets a flat normal
+        const glm::vec3 axes[] = { {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f} };
+        for (int axis = 0; axis < 3; axis++) {
+            const glm::vec3& tangent = axes[(axis + 1) % 3];
+            addQuad(vertices, indices, axes[axis] * 0.5f, axes[axis], tangent, 0.5f);
+            addQuad(vertices, indices, -axes[axis] * 0.5f, -axes[axis], tangent, 0.5f);
+        }
+        boxMesh = std::make_unique<Mesh>(device, vertices, indices);
+
+        // Per-pixel lighting, so one quad is enough for the floor
+        vertices.clear();
+        indices.clear();
+        const float floorHalfSize = GRID_SIZE * BOX_SPACING * 0.5f + BOX_SPACING;
+        addQuad(vertices, indices, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), floorHalfSize);
+        floorMesh = std::make_unique<Mesh>(device, vertices, indices);
+    }
+
+    void ClusteredLightingScene::createLightSources() {
+        std::mt19937 rng(1234);
+        const float half = GRID_SIZE * BOX_SPACING * 0.5f;
+        std::uniform_real_distribution<float> position(-half, half);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        lightSources.resize(MAX_LIGHTS);
+        for (LightSource& source : lightSources) {
+            source.center = glm::vec2(position(rng), position(rng));
+            source.orbitRadius = 1.0f + unit(rng) * BOX_SPACING;
+            source.height = 0.5f + unit(rng) * 4.0f;
+            source.speed = (unit(rng) - 0.5f) * 2.0f;
+            source.phase = unit(rng) * glm::two_pi<float>();
+            // Saturated hues so overlapping lights stay tellable apart
+            glm::vec3 hue = glm::clamp(glm::abs(glm::mod(unit(rng) * 6.0f + glm::vec3(0.0f, 4.0f, 2.0f), 6.0f) - 3.0f) - 1.0f, 0.0f, 1.0f);
+            source.color = hue * 8.0f;
+        }
+        lights.reserve(MAX_LIGHTS);
+    }
+
+    void ClusteredLightingScene::createBuffers() {
+        // Boxes of varying size on a grid, resting on the floor
+        std::mt19937 rng(5678);
+        std::uniform_real_distribution<float> scale(0.5f, 2.5f);
+        std::vector<glm::vec4> instances;
+        instances.reserve(BOX_COUNT + 1);
+        const float half = (GRID_SIZE - 1) * BOX_SPACING * 0.5f;
+        for (uint32_t z = 0; z < GRID_SIZE; z++) {
+            for (uint32_t x = 0; x < GRID_SIZE; x++) {
+                float size = scale(rng);
+                instances.emplace_back(x * BOX_SPACING - half, size * 0.5f, z * BOX_SPACING - half, size);
+            }
+        }
+        instances.emplace_back(0.0f, 0.0f, 0.0f, 1.0f);
+
+        VkDeviceSize instanceSize = sizeof(glm::vec4) * instances.size();
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        device->createBuffer(instanceSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer, stagingBufferMemory);
+        void* data;
+        vkMapMemory(device->device(), stagingBufferMemory, 0, instanceSize, 0, &data);
+        memcpy(data, instances.data(), static_cast<size_t>(instanceSize));
+        vkUnmapMemory(device->device(), stagingBufferMemory);
+
+        device->createBuffer(instanceSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, instanceBuffer, instanceBufferMemory);
+        device->copyBuffer(stagingBuffer, instanceBuffer, instanceSize);
+
+        vkDestroyBuffer(device->device(), stagingBuffer, nullptr);
+        vkFreeMemory(device->device(), stagingBufferMemory, nullptr);
+
+        const size_t frameCount = VulkanSwapChain::MAX_FRAMES_IN_FLIGHT;
+        cameraBuffers.resize(frameCount);
+        cameraBuffersMemory.resize(frameCount);
+        cameraBuffersMapped.resize(frameCount);
+        for (size_t i = 0; i < frameCount; i++) {
+            device->createBuffer(sizeof(ClusteredCameraData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                cameraBuffers[i], cameraBuffersMemory[i]);
+            vkMapMemory(device->device(), cameraBuffersMemory[i], 0, sizeof(ClusteredCameraData), 0, &cameraBuffersMapped[i]);
+        }
+    }
+
+    void ClusteredLightingScene::createDescriptors() {
+        const uint32_t frameCount = static_cast<uint32_t>(cameraBuffers.size());
+
+        VkDescriptorPoolSize poolSizes[] = {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frameCount },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frameCount }
+        };
+        VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, nullptr, 0, frameCount, 2, poolSizes};
+        vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &descriptorPool);
+
+        VkDescriptorSetLayoutBinding bindings[] = {
+            {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr}
+        };
+        VkDescriptorSetLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 2, bindings};
+        vkCreateDescriptorSetLayout(device->device(), &layoutInfo, nullptr, &sceneSetLayout);
+
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, sceneSetLayout);
+        sceneSets.resize(frameCount);
+        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr, descriptorPool, frameCount, layouts.data()};
+        if (vkAllocateDescriptorSets(device->device(), &allocInfo, sceneSets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate clustered lighting descriptor sets!");
+        }
+
+        VkDescriptorBufferInfo instanceInfo{ instanceBuffer, 0, VK_WHOLE_SIZE };
+        for (uint32_t i = 0; i < frameCount; i++) {
+            VkDescriptorBufferInfo camInfo{ cameraBuffers[i], 0, sizeof(ClusteredCameraData) };
+            VkWriteDescriptorSet writes[] = {
+                {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, sceneSets[i], 0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, nullptr, &camInfo, nullptr},
+                {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, sceneSets[i], 1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &instanceInfo, nullptr}
+            };
+            vkUpdateDescriptorSets(device->device(), 2, writes, 0, nullptr);
+        }
+    }
+
+    void ClusteredLightingScene::createPipeline(VulkanRenderer* renderer) {
+        VkDescriptorSetLayout setLayouts[] = { sceneSetLayout, lighting->getDescriptorSetLayout() };
+        VkPushConstantRange pushConstant{VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t)};
+        VkPipelineLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        layoutInfo.setLayoutCount = 2;
+        layoutInfo.pSetLayouts = setLayouts;
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges = &pushConstant;
+        vkCreatePipelineLayout(device->device(), &layoutInfo, nullptr, &pipelineLayout);
+
+        auto bindDesc = Vertex::getBindingDescriptions();
+        auto attrDesc = Vertex::getAttributeDescriptions();
+        VkPipelineVertexInputStateCreateInfo vertInput{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO, nullptr, 0, static_cast<uint32_t>(bindDesc.size()), bindDesc.data(), static_cast<uint32_t>(attrDesc.size()), attrDesc.data()};
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO, nullptr, 0, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_FALSE};
+
+        VkPipelineViewportStateCreateInfo viewportState{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO, nullptr, 0, 1, nullptr, 1, nullptr};
+        VkPipelineRasterizationStateCreateInfo rasterizer{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO, nullptr, 0, VK_FALSE, VK_FALSE, VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_FALSE, 0, 0, 0, 1.0f};
+        VkPipelineMultisampleStateCreateInfo multisample{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO, nullptr, 0, VK_SAMPLE_COUNT_1_BIT, VK_FALSE};
+        VkPipelineDepthStencilStateCreateInfo depthStencil{VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO, nullptr, 0, VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS, VK_FALSE, VK_FALSE};
+
+        VkPipelineColorBlendAttachmentState blendAtt{VK_FALSE, VK_BLEND_FACTOR_ZERO, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ZERO, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, 0xF};
+        VkPipelineColorBlendStateCreateInfo blend{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO, nullptr, 0, VK_FALSE, VK_LOGIC_OP_COPY, 1, &blendAtt};
+
+        std::vector<VkDynamicState> dynamics = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicInfo{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO, nullptr, 0, static_cast<uint32_t>(dynamics.size()), dynamics.data()};
+
+        VkShaderModule vertModule = createShaderModule(device->device(), "clustered.vert.spv");
+        VkShaderModule fragModule = createShaderModule(device->device(), "clustered.frag.spv");
+        VkPipelineShaderStageCreateInfo stages[] = {
+            {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertModule, "main", nullptr},
+            {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragModule, "main", nullptr}
+        };
+
+        VkGraphicsPipelineCreateInfo pipeInfo{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+        pipeInfo.stageCount = 2;
+        pipeInfo.pStages = stages;
+        pipeInfo.pVertexInputState = &vertInput;
+        pipeInfo.pInputAssemblyState = &inputAssembly;
+        pipeInfo.pViewportState = &viewportState;
+        pipeInfo.pRasterizationState = &rasterizer;
+        pipeInfo.pMultisampleState = &multisample;
+        pipeInfo.pDepthStencilState = &depthStencil;
+        pipeInfo.pColorBlendState = &blend;
+        pipeInfo.pDynamicState = &dynamicInfo;
+        pipeInfo.layout = pipelineLayout;
+        pipeInfo.renderPass = renderer->getSwapChainRenderPass();
+        pipeInfo.subpass = 0;
+
+        VkResult result = vkCreateGraphicsPipelines(device->device(), VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &pipeline);
+        vkDestroyShaderModule(device->device(), vertModule, nullptr);
+        vkDestroyShaderModule(device->device(), fragModule, nullptr);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to create clustered lighting pipeline!");
+        }
+    }
+
+    void ClusteredLightingScene::update(float deltaTime, FramePacket& packet) {
+        if (Input::isMouseButtonPressed(GLFW_MOUSE_BUTTON_RIGHT)) {
+            glm::vec2 delta = Input::getMouseDelta();
+            camera.processMouseMovement(delta.x, delta.y);
+        }
+        float scroll = Input::getScrollDelta();
+        if (scroll != 0.0f) camera.processMouseScroll(scroll);
+
+        if (Input::isKeyPressed(GLFW_KEY_W)) camera.processKeyboard(CameraMovement::Forward, deltaTime);
+        if (Input::isKeyPressed(GLFW_KEY_S)) camera.processKeyboard(CameraMovement::Backward, deltaTime);
+        if (Input::isKeyPressed(GLFW_KEY_A)) camera.processKeyboard(CameraMovement::Left, deltaTime);
+        if (Input::isKeyPressed(GLFW_KEY_D)) camera.processKeyboard(CameraMovement::Right, deltaTime);
+
+        packet.camera = FrameCamera::capture(camera, packet.aspectRatio);
+    }
+
+    void ClusteredLightingScene::updateLights(uint32_t frameIndex) {
+        const uint32_t count = std::min(static_cast<uint32_t>(lightCount), MAX_LIGHTS);
+        // Downward cone of 40 degrees, fading from 25
+        const float cosOuter = std::cos(glm::radians(40.0f));
+        const float cosInner = std::cos(glm::radians(25.0f));
+
+        lights.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            const LightSource& source = lightSources[i];
+            float angle = source.phase + source.speed * lightTime;
+
+            ClusterLight& light = lights[i];
+            light.position = glm::vec3(source.center.x + std::cos(angle) * source.orbitRadius, source.height,
+                                       source.center.y + std::sin(angle) * source.orbitRadius);
+            light.range = lightRange;
+            light.color = source.color;
+            light.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+            if (spotLights && i % 4 == 0) {
+                // Raised so the cone reaches the floor at a similar footprint
+                light.position.y += lightRange * 0.5f;
+                light.cosInner = cosInner;
+                light.cosOuter = cosOuter;
+            } else {
+                light.cosInner = -1.0f;
+                light.cosOuter = -1.0f;
+            }
+        }
+        lighting->setLights(frameIndex, lights);
+    }
+
+    void ClusteredLightingScene::preRender(VulkanRenderer* renderer, const FramePacket& packet) {
+        const uint32_t frameIndex = static_cast<uint32_t>(renderer->getFrameIndex());
+
+        // The slot's previous frame has completed, so its count is final
+        requestedIndices = lighting->getRequestedIndexCount(frameIndex);
+
+        if (animateLights) {
+            lightTime += packet.deltaTime;
+        }
+        updateLights(frameIndex);
+
+        FrameCamera frameCamera = packet.renderCamera();
+        ClusteredCameraData camData{};
+        camData.view = frameCamera.view;
+        camData.viewProj = frameCamera.proj * frameCamera.view;
+        memcpy(cameraBuffersMapped[frameIndex], &camData, sizeof(ClusteredCameraData));
+
+        lighting->recordAssignment(renderer->getCurrentCommandBuffer(), frameIndex, frameCamera, renderer->getSwapChainExtent());
+    }
+
+    void ClusteredLightingScene::render(VulkanRenderer* renderer, const FramePacket& packet) {
+        VkCommandBuffer commandBuffer = renderer->getCurrentCommandBuffer();
+        const uint32_t frameIndex = static_cast<uint32_t>(renderer->getFrameIndex());
+
+        VkDescriptorSet sets[] = { sceneSets[frameIndex], lighting->getDescriptorSet(frameIndex) };
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 2, sets, 0, nullptr);
+        uint32_t mode = static_cast<uint32_t>(shadingMode);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t), &mode);
+
+        boxMesh->bind(commandBuffer);
+        boxMesh->drawInstanced(commandBuffer, BOX_COUNT, 0);
+        floorMesh->bind(commandBuffer);
+        floorMesh->drawInstanced(commandBuffer, 1, BOX_COUNT);
+    }
+
+    void ClusteredLightingScene::onImGuiRender() {
+        ImGui::Begin("Clustered Lighting");
+        ImGui::Text("Clusters: %u x %u x %u (%u)", ClusteredLighting::CLUSTER_X, ClusteredLighting::CLUSTER_Y,
+            ClusteredLighting::CLUSTER_Z, ClusteredLighting::CLUSTER_COUNT);
+
+        ImGui::SliderInt("Lights", &lightCount, 1, static_cast<int>(MAX_LIGHTS), "%d", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("Light Range", &lightRange, 1.0f, 20.0f);
+        ImGui::Checkbox("Animate", &animateLights);
+        ImGui::Checkbox("Spot Lights (every 4th)", &spotLights);
+
+        int mode = static_cast<int>(shadingMode);
+        ImGui::RadioButton("Clustered", &mode, static_cast<int>(ClusteredShadingMode::Clustered));
+        ImGui::RadioButton("All lights per pixel", &mode, static_cast<int>(ClusteredShadingMode::AllLights));
+        ImGui::RadioButton("Lights per cluster", &mode, static_cast<int>(ClusteredShadingMode::Heatmap));
+        shadingMode = static_cast<ClusteredShadingMode>(mode);
+
+        ImGui::Separator();
+        ImGui::Text("Light indices: %u / %u (%.1f per cluster)", requestedIndices, ClusteredLighting::INDEX_CAPACITY,
+            static_cast<float>(requestedIndices) / ClusteredLighting::CLUSTER_COUNT);
+        if (requestedIndices > ClusteredLighting::INDEX_CAPACITY) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Index list full: distant clusters lose lights");
+        }
+        ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
+        ImGui::End();
+    }
+
+    void ClusteredLightingScene::cleanup() {
+        if (device) device->waitIdle();
+
+        if (pipeline != VK_NULL_HANDLE) { vkDestroyPipeline(device->device(), pipeline, nullptr); pipeline = VK_NULL_HANDLE; }
+        if (pipelineLayout != VK_NULL_HANDLE) { vkDestroyPipelineLayout(device->device(), pipelineLayout, nullptr); pipelineLayout = VK_NULL_HANDLE; }
+        if (sceneSetLayout != VK_NULL_HANDLE) { vkDestroyDescriptorSetLayout(device->device(), sceneSetLayout, nullptr); sceneSetLayout = VK_NULL_HANDLE; }
+        if (descriptorPool != VK_NULL_HANDLE) { vkDestroyDescriptorPool(device->device(), descriptorPool, nullptr); descriptorPool = VK_NULL_HANDLE; }
+        sceneSets.clear();
+
+        for (size_t i = 0; i < cameraBuffers.size(); i++) {
+            vkDestroyBuffer(device->device(), cameraBuffers[i], nullptr);
+            vkFreeMemory(device->device(), cameraBuffersMemory[i], nullptr);
+        }
+        cameraBuffers.clear();
+        cameraBuffersMemory.clear();
+        cameraBuffersMapped.clear();
+
+        if (instanceBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), instanceBuffer, nullptr); instanceBuffer = VK_NULL_HANDLE; }
+        if (instanceBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), instanceBufferMemory, nullptr); instanceBufferMemory = VK_NULL_HANDLE; }
+
+        lighting.reset();
+        boxMesh.reset();
+        floorMesh.reset();
+        lightSources.clear();
+        lights.clear();
+    }
+}
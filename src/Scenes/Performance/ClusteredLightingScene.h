@@ -0,0 +1,111 @@
+#pragma once
+
+#include "../../Engine/Scene/Scene.h"
+#include "../../Engine/Scene/FramePacket.h"
+#include "../../Engine/Core/Camera.h"
+#include "../../Engine/Renderer/Mesh.h"
+#include "../../Engine/Renderer/ClusteredLighting.h"
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace AhnrealEngine {
+
+    // Camera block of clustered.vert
+    struct ClusteredCameraData {
+        glm::mat4 view;
+        glm::mat4 viewProj;
+    };
+
+    // Push constant of clustered.frag
+    enum class ClusteredShadingMode : uint32_t {
+        Clustered = 0, // Only the lights binned into the fragment's cluster
+        AllLights = 1, // Every light per fragment, for comparison
+        Heatmap = 2    // Lights per cluster instead of shading
+    };
+
+    // A field of boxes lit by thousands of moving point and spot lights
+    // through ClusteredLighting. The light count can be raised until the
+    // all-lights reference path falls over, while the clustered path only
+    // pays for the lights near each pixel.
+    class ClusteredLightingScene : public Scene {
+    public:
+        ClusteredLightingScene();
+        ~ClusteredLightingScene();
+
+        void initialize() override;
+        void initialize(VulkanRenderer* renderer) override;
+        void onImGuiRender() override;
+
+        bool supportsPipelinedUpdate() const override { return true; }
+        bool supportsFixedTimestep() const override { return true; }
+        void update(float deltaTime, FramePacket& packet) override;
+        void preRender(VulkanRenderer* renderer, const FramePacket& packet) override;
+        void render(VulkanRenderer* renderer, const FramePacket& packet) override;
+
+        // Mesh generation and uploads run in prepare()
+        bool supportsPreload() const override { return true; }
+        void prepare(VulkanRenderer* renderer, LoadProgress& progress) override;
+
+    private:
+        // Animation parameters of one light; the GPU light is rebuilt from
+        // them every frame
+        struct LightSource {
+            glm::vec2 center;
+            float orbitRadius;
+            float height;
+            float speed;
+            float phase;
+            glm::vec3 color;
+        };
+
+        void cleanup();
+        void createMeshes();
+        void createLightSources();
+        void createBuffers();
+        void createDescriptors();
+        void createPipeline(VulkanRenderer* renderer);
+        void updateLights(uint32_t frameIndex);
+
+        VulkanDevice* device = nullptr;
+        Camera camera;
+
+        static constexpr uint32_t GRID_SIZE = 32;
+        static constexpr uint32_t BOX_COUNT = GRID_SIZE * GRID_SIZE;
+        static constexpr float BOX_SPACING = 4.0f;
+        static constexpr uint32_t MAX_LIGHTS = 16384;
+
+        std::unique_ptr<Mesh> boxMesh;
+        std::unique_ptr<Mesh> floorMesh;
+        std::unique_ptr<ClusteredLighting> lighting;
+
+        // Boxes, then the floor at index BOX_COUNT
+        VkBuffer instanceBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory instanceBufferMemory = VK_NULL_HANDLE;
+
+        // Per frame slot
+        std::vector<VkBuffer> cameraBuffers;
+        std::vector<VkDeviceMemory> cameraBuffersMemory;
+        std::vector<void*> cameraBuffersMapped;
+
+        // Set 0: [0: Camera(U), 1: Instances]; set 1 is the lighting's
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSetLayout sceneSetLayout = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> sceneSets;
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+
+        std::vector<LightSource> lightSources; // MAX_LIGHTS, the first lightCount are used
+        std::vector<ClusterLight> lights;
+
+        // Only the render stage touches the lights, so they are animated
+        // from the packet's delta time in preRender
+        float lightTime = 0.0f;
+        int lightCount = 2048;
+        float lightRange = 6.0f;
+        bool animateLights = true;
+        bool spotLights = true; // Every fourth light becomes a downward spot
+        ClusteredShadingMode shadingMode = ClusteredShadingMode::Clustered;
+        uint32_t requestedIndices = 0;
+    };
+}
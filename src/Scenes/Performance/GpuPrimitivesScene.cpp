@@ -0,0 +1,368 @@
+#include "GpuPrimitivesScene.h"
+#include "../../Engine/Renderer/VulkanRenderer.h"
+#include <imgui.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace AhnrealEngine {
+
+    static const char* const TEST_NAMES[] = {
+        "Exclusive scan", "Inclusive scan", "Stream compaction", "Segmented reduce", "Radix sort (32-bit keys)", "Radix sort (64-bit keys)"
+    };
+
+    GpuPrimitivesScene::GpuPrimitivesScene() : Scene("GPU Primitives") {}
+
+    GpuPrimitivesScene::~GpuPrimitivesScene() {
+        cleanup();
+    }
+
+    void GpuPrimitivesScene::initialize() {
+        // Required by base class but we use initialize(renderer)
+    }
+
+    void GpuPrimitivesScene::initialize(VulkanRenderer* renderer) {
+        device = renderer->getDevice();
+        primitives = std::make_unique<GpuPrimitives>(device);
+        descriptors = std::make_unique<DescriptorAllocator>(device);
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device->physicalDevice(), &properties);
+        timestampPeriod = properties.limits.timestampComputeAndGraphics ? properties.limits.timestampPeriod : 0.0f;
+
+        if (timestampPeriod > 0.0f) {
+            VkQueryPoolCreateInfo queryInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+            queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryInfo.queryCount = 2;
+            if (vkCreateQueryPool(device->device(), &queryInfo, nullptr, &queryPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create timestamp query pool!");
+            }
+        }
+    }
+
+    void GpuPrimitivesScene::cleanup() {
+        if (!device) return;
+
+        if (queryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device->device(), queryPool, nullptr);
+            queryPool = VK_NULL_HANDLE;
+        }
+        descriptors.reset();
+        primitives.reset();
+        device = nullptr;
+    }
+
+    GpuPrimitivesScene::Buffer GpuPrimitivesScene::createBuffer(VkDeviceSize size) {
+        Buffer buffer;
+        buffer.size = std::max<VkDeviceSize>(size, 4);
+        device->createBuffer(buffer.size,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer.buffer, buffer.memory);
+        return buffer;
+    }
+
+    void GpuPrimitivesScene::destroyBuffer(Buffer& buffer) {
+        if (buffer.buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device->device(), buffer.buffer, nullptr);
+            vkFreeMemory(device->device(), buffer.memory, nullptr);
+        }
+        buffer = Buffer{};
+    }
+
+    void GpuPrimitivesScene::upload(const Buffer& buffer, const void* data, VkDeviceSize size) {
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingMemory;
+        device->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+
+        void* mapped;
+        vkMapMemory(device->device(), stagingMemory, 0, size, 0, &mapped);
+        memcpy(mapped, data, static_cast<size_t>(size));
+        vkUnmapMemory(device->device(), stagingMemory);
+
+        device->copyBuffer(stagingBuffer, buffer.buffer, size);
+        vkDestroyBuffer(device->device(), stagingBuffer, nullptr);
+        vkFreeMemory(device->device(), stagingMemory, nullptr);
+    }
+
+    void GpuPrimitivesScene::download(const Buffer& buffer, void* data, VkDeviceSize size) {
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingMemory;
+        device->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+
+        device->copyBuffer(buffer.buffer, stagingBuffer, size);
+
+        void* mapped;
+        vkMapMemory(device->device(), stagingMemory, 0, size, 0, &mapped);
+        memcpy(data, mapped, static_cast<size_t>(size));
+        vkUnmapMemory(device->device(), stagingMemory);
+
+        vkDestroyBuffer(device->device(), stagingBuffer, nullptr);
+        vkFreeMemory(device->device(), stagingMemory, nullptr);
+    }
+
+    double GpuPrimitivesScene::timeGpu(const std::function<void(VkCommandBuffer)>& record, const std::function<void()>& reset) {
+        double best = 1e30;
+        for (int r = 0; r < REPETITIONS; r++) {
+            if (reset) reset();
+            descriptors->reset();
+
+            VkCommandBuffer commandBuffer = device->beginSingleTimeCommands();
+            if (queryPool != VK_NULL_HANDLE) {
+                vkCmdResetQueryPool(commandBuffer, queryPool, 0, 2);
+                vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+            }
+            record(commandBuffer);
+            if (queryPool != VK_NULL_HANDLE) {
+                vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+            }
+            // Results are read back with transfers
+            VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0, 1, &barrier, 0, nullptr, 0, nullptr);
+            device->endSingleTimeCommands(commandBuffer);
+
+            if (queryPool != VK_NULL_HANDLE) {
+                uint64_t timestamps[2] = {};
+                vkGetQueryPoolResults(device->device(), queryPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t),
+                    VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+                best = std::min(best, static_cast<double>(timestamps[1] - timestamps[0]) * timestampPeriod * 1e-6);
+            }
+        }
+        return queryPool != VK_NULL_HANDLE ? best : 0.0;
+    }
+
+    GpuPrimitivesScene::Result GpuPrimitivesScene::runScan(bool inclusive) {
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<uint32_t> valueDistribution(0, 255);
+        std::vector<uint32_t> values(ELEMENT_COUNT);
+        for (uint32_t& value : values) value = valueDistribution(rng);
+
+        const VkDeviceSize size = sizeof(uint32_t) * ELEMENT_COUNT;
+        Buffer input = createBuffer(size);
+        Buffer output = createBuffer(size);
+        Buffer scratch = createBuffer(primitives->getScanScratchSize(ELEMENT_COUNT));
+        upload(input, values.data(), size);
+
+        const GpuPrimitives::ScanType type = inclusive ? GpuPrimitives::ScanType::Inclusive : GpuPrimitives::ScanType::Exclusive;
+        Result result;
+        result.milliseconds = timeGpu([&](VkCommandBuffer commandBuffer) {
+            primitives->scan(commandBuffer, *descriptors, type, range(input), range(output), ELEMENT_COUNT, range(scratch));
+        });
+
+        std::vector<uint32_t> expected(ELEMENT_COUNT), actual(ELEMENT_COUNT);
+        if (inclusive) {
+            std::inclusive_scan(values.begin(), values.end(), expected.begin());
+        } else {
+            std::exclusive_scan(values.begin(), values.end(), expected.begin(), 0u);
+        }
+        download(output, actual.data(), size);
+        for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+            if (actual[i] != expected[i]) result.mismatches++;
+        }
+
+        destroyBuffer(input);
+        destroyBuffer(output);
+        destroyBuffer(scratch);
+        return result;
+    }
+
+    GpuPrimitivesScene::Result GpuPrimitivesScene::runCompact() {
+        std::mt19937 rng(5678);
+        std::vector<uint32_t> values(ELEMENT_COUNT), flags(ELEMENT_COUNT);
+        for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+            values[i] = rng();
+            flags[i] = (rng() % 3 == 0) ? 1u : 0u; // Keep about a third
+        }
+
+        const VkDeviceSize size = sizeof(uint32_t) * ELEMENT_COUNT;
+        Buffer input = createBuffer(size);
+        Buffer flagBuffer = createBuffer(size);
+        Buffer output = createBuffer(size);
+        Buffer outputCount = createBuffer(sizeof(uint32_t));
+        Buffer scratch = createBuffer(primitives->getCompactScratchSize(ELEMENT_COUNT));
+        upload(input, values.data(), size);
+        upload(flagBuffer, flags.data(), size);
+
+        Result result;
+        result.milliseconds = timeGpu([&](VkCommandBuffer commandBuffer) {
+            primitives->compact(commandBuffer, *descriptors, range(input), range(flagBuffer), ELEMENT_COUNT, 1,
+                                range(output), range(outputCount), range(scratch));
+        });
+
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+            if (flags[i]) expected.push_back(values[i]);
+        }
+        uint32_t count = 0;
+        download(outputCount, &count, sizeof(count));
+        if (count != expected.size()) {
+            result.mismatches = std::max<uint32_t>(static_cast<uint32_t>(expected.size()), 1);
+        } else if (count > 0) {
+            std::vector<uint32_t> actual(count);
+            download(output, actual.data(), sizeof(uint32_t) * count);
+            for (uint32_t i = 0; i < count; i++) {
+                if (actual[i] != expected[i]) result.mismatches++;
+            }
+        }
+
+        destroyBuffer(input);
+        destroyBuffer(flagBuffer);
+        destroyBuffer(output);
+        destroyBuffer(outputCount);
+        destroyBuffer(scratch);
+        return result;
+    }
+
+    GpuPrimitivesScene::Result GpuPrimitivesScene::runSegmentedReduce() {
+        std::mt19937 rng(9012);
+        std::uniform_int_distribution<uint32_t> valueDistribution(0, 1023);
+        std::vector<uint32_t> values(ELEMENT_COUNT);
+        for (uint32_t& value : values) value = valueDistribution(rng);
+
+        // Random cut points, so segment lengths vary and some are empty
+        std::vector<uint32_t> offsets(SEGMENT_COUNT + 1);
+        std::uniform_int_distribution<uint32_t> cutDistribution(0, ELEMENT_COUNT);
+        for (uint32_t& offset : offsets) offset = cutDistribution(rng);
+        offsets.front() = 0;
+        offsets.back() = ELEMENT_COUNT;
+        std::sort(offsets.begin(), offsets.end());
+
+        Buffer valueBuffer = createBuffer(sizeof(uint32_t) * ELEMENT_COUNT);
+        Buffer offsetBuffer = createBuffer(sizeof(uint32_t) * offsets.size());
+        Buffer output = createBuffer(sizeof(uint32_t) * SEGMENT_COUNT);
+        upload(valueBuffer, values.data(), valueBuffer.size);
+        upload(offsetBuffer, offsets.data(), offsetBuffer.size);
+
+        Result result;
+        result.milliseconds = timeGpu([&](VkCommandBuffer commandBuffer) {
+            primitives->segmentedReduce(commandBuffer, *descriptors, GpuPrimitives::ReduceOp::Add,
+                                        range(valueBuffer), range(offsetBuffer), SEGMENT_COUNT, range(output));
+        });
+
+        std::vector<uint32_t> actual(SEGMENT_COUNT);
+        download(output, actual.data(), output.size);
+        for (uint32_t s = 0; s < SEGMENT_COUNT; s++) {
+            uint32_t expected = std::accumulate(values.begin() + offsets[s], values.begin() + offsets[s + 1], 0u);
+            if (actual[s] != expected) result.mismatches++;
+        }
+
+        // The other operations are only checked, on the same data
+        for (GpuPrimitives::ReduceOp op : {GpuPrimitives::ReduceOp::Min, GpuPrimitives::ReduceOp::Max}) {
+            descriptors->reset();
+            VkCommandBuffer commandBuffer = device->beginSingleTimeCommands();
+            primitives->segmentedReduce(commandBuffer, *descriptors, op, range(valueBuffer), range(offsetBuffer), SEGMENT_COUNT, range(output));
+            device->endSingleTimeCommands(commandBuffer);
+
+            download(output, actual.data(), output.size);
+            for (uint32_t s = 0; s < SEGMENT_COUNT; s++) {
+                uint32_t expected = op == GpuPrimitives::ReduceOp::Min ? 0xFFFFFFFFu : 0u;
+                for (uint32_t i = offsets[s]; i < offsets[s + 1]; i++) {
+                    expected = op == GpuPrimitives::ReduceOp::Min ? std::min(expected, values[i]) : std::max(expected, values[i]);
+                }
+                if (actual[s] != expected) result.mismatches++;
+            }
+        }
+
+        destroyBuffer(valueBuffer);
+        destroyBuffer(offsetBuffer);
+        destroyBuffer(output);
+        return result;
+    }
+
+    GpuPrimitivesScene::Result GpuPrimitivesScene::runRadixSort(uint32_t keyWords) {
+        std::mt19937_64 rng(3456);
+        // Keys are drawn from a small range too, so stability is exercised
+        std::vector<uint32_t> keys(ELEMENT_COUNT * keyWords), values(ELEMENT_COUNT);
+        for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+            uint64_t key = (i & 1) ? rng() : rng() % 1024;
+            keys[i * keyWords] = static_cast<uint32_t>(key);
+            if (keyWords == 2) keys[i * keyWords + 1] = static_cast<uint32_t>(key >> 32);
+            values[i] = i;
+        }
+
+        const VkDeviceSize keySize = sizeof(uint32_t) * keys.size();
+        const VkDeviceSize valueSize = sizeof(uint32_t) * ELEMENT_COUNT;
+        Buffer keyBuffer = createBuffer(keySize);
+        Buffer valueBuffer = createBuffer(valueSize);
+        Buffer scratch = createBuffer(primitives->getRadixSortScratchSize(ELEMENT_COUNT, keyWords));
+
+        Result result;
+        result.milliseconds = timeGpu([&](VkCommandBuffer commandBuffer) {
+            primitives->radixSort(commandBuffer, *descriptors, range(keyBuffer), range(valueBuffer), ELEMENT_COUNT,
+                                  keyWords, 0, range(scratch));
+        }, [&]() {
+            // Sorting in place, so every repetition starts from the input again
+            upload(keyBuffer, keys.data(), keySize);
+            upload(valueBuffer, values.data(), valueSize);
+        });
+
+        auto keyAt = [&](const std::vector<uint32_t>& words, uint32_t i) {
+            uint64_t key = words[i * keyWords];
+            if (keyWords == 2) key |= static_cast<uint64_t>(words[i * keyWords + 1]) << 32;
+            return key;
+        };
+        std::vector<uint32_t> expectedOrder(ELEMENT_COUNT);
+        std::iota(expectedOrder.begin(), expectedOrder.end(), 0u);
+        std::stable_sort(expectedOrder.begin(), expectedOrder.end(), [&](uint32_t a, uint32_t b) {
+            return keyAt(keys, a) < keyAt(keys, b);
+        });
+
+        std::vector<uint32_t> actualKeys(keys.size()), actualValues(ELEMENT_COUNT);
+        download(keyBuffer, actualKeys.data(), keySize);
+        download(valueBuffer, actualValues.data(), valueSize);
+        for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+            if (actualValues[i] != expectedOrder[i] || keyAt(actualKeys, i) != keyAt(keys, expectedOrder[i])) {
+                result.mismatches++;
+            }
+        }
+
+        destroyBuffer(keyBuffer);
+        destroyBuffer(valueBuffer);
+        destroyBuffer(scratch);
+        return result;
+    }
+
+    void GpuPrimitivesScene::runTests() {
+        results[ExclusiveScan] = runScan(false);
+        results[InclusiveScan] = runScan(true);
+        results[Compact] = runCompact();
+        results[SegmentedReduce] = runSegmentedReduce();
+        results[RadixSort32] = runRadixSort(1);
+        results[RadixSort64] = runRadixSort(2);
+        descriptors->reset();
+        hasResults = true;
+    }
+
+    void GpuPrimitivesScene::onImGuiRender() {
+        ImGui::Begin("GPU Primitives");
+        ImGui::Text("Elements: %u (best of %d)", ELEMENT_COUNT, REPETITIONS);
+        if (timestampPeriod <= 0.0f) {
+            ImGui::Text("Timestamps not supported: correctness only");
+        }
+
+        if (primitives && ImGui::Button("Run")) {
+            runTests();
+        }
+
+        if (hasResults) {
+            ImGui::Separator();
+            for (int t = 0; t < TestCount; t++) {
+                const Result& result = results[t];
+                double throughput = result.milliseconds > 0.0 ? ELEMENT_COUNT / (result.milliseconds * 1e3) : 0.0;
+                ImGui::Text("%-26s %.3f ms  %.0f M elements/s  %s", TEST_NAMES[t], result.milliseconds, throughput,
+                            result.mismatches ? "MISMATCH" : "ok");
+                if (result.mismatches) {
+                    ImGui::SameLine();
+                    ImGui::Text("(%u wrong)", result.mismatches);
+                }
+            }
+        }
+        ImGui::End();
+    }
+}
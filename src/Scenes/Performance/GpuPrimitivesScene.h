@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../../Engine/Scene/Scene.h"
+#include "../../Engine/Renderer/GpuPrimitives.h"
+#include "../../Engine/Renderer/DescriptorAllocator.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    // Runs every GpuPrimitives operation on random data, checks the result
+    // against a CPU reference and reports GPU time from timestamp queries.
+    // Nothing is drawn; results are shown after "Run".
+    class GpuPrimitivesScene : public Scene {
+    public:
+        GpuPrimitivesScene();
+        ~GpuPrimitivesScene() override;
+
+        void initialize() override;
+        void initialize(VulkanRenderer* renderer) override;
+        void cleanup() override;
+        void onImGuiRender() override;
+        bool needsContinuousRedraw() const override { return false; }
+
+    private:
+        enum Test { ExclusiveScan, InclusiveScan, Compact, SegmentedReduce, RadixSort32, RadixSort64, TestCount };
+
+        struct Buffer {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize size = 0;
+        };
+
+        struct Result {
+            double milliseconds = 0.0;
+            uint32_t mismatches = 0;
+        };
+
+        void runTests();
+        Result runScan(bool inclusive);
+        Result runCompact();
+        Result runSegmentedReduce();
+        Result runRadixSort(uint32_t keyWords);
+
+        // Best GPU time of record over REPETITIONS submissions; reset runs
+        // before each one, outside the timed range
+        double timeGpu(const std::function<void(VkCommandBuffer)>& record, const std::function<void()>& reset = nullptr);
+
+        Buffer createBuffer(VkDeviceSize size);
+        void destroyBuffer(Buffer& buffer);
+        void upload(const Buffer& buffer, const void* data, VkDeviceSize size);
+        void download(const Buffer& buffer, void* data, VkDeviceSize size);
+        static GpuBufferRange range(const Buffer& buffer) { return {buffer.buffer, 0, buffer.size}; }
+
+        static constexpr uint32_t ELEMENT_COUNT = 1u << 20;
+        static constexpr uint32_t SEGMENT_COUNT = 4096;
+        static constexpr int REPETITIONS = 10;
+
+        VulkanDevice* device = nullptr;
+        std::unique_ptr<GpuPrimitives> primitives;
+        std::unique_ptr<DescriptorAllocator> descriptors;
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        float timestampPeriod = 0.0f; // Nanoseconds per tick, 0 without timestamps
+
+        Result results[TestCount];
+        bool hasResults = false;
+    };
+}
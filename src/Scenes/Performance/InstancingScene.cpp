@@ -1,19 +1,39 @@
 #include "InstancingScene.h"
 #include "../../Engine/Renderer/VulkanRenderer.h"
 #include "../../Engine/Renderer/VulkanDevice.h"
+#include "../../Engine/Renderer/VulkanSwapChain.h"
+#include "../../Engine/Renderer/DescriptorAllocator.h"
 #include "../../Engine/Core/Input.h"
+#include "../../Engine/Core/JobSystem.h"
+#include "../../Engine/Core/Frustum.h"
 #include <imgui.h>
-#include <random>
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <iostream>
 #include <fstream>
-#include <ctime>
+#include <initializer_list>
 
 namespace AhnrealEngine {
 
+    // instance_generate.comp's hash and random stream, bit for bit
+    static uint32_t pcgHash(uint32_t v) {
+        uint32_t state = v * 747796405u + 2891336453u;
+        uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    static float nextRandom(uint32_t& state) {
+        state = pcgHash(state);
+        return static_cast<float>(state >> 8u) * (1.0f / 16777216.0f);
+    }
+
     InstancingScene::InstancingScene() 
         : Scene("GPU Instancing Culling"), camera(glm::vec3(0.0f, 10.0f, 30.0f)) {
-        camera.setFar(200.0f);
+        // The generated field grows with the instance count (see recordInstanceGeneration)
+        camera.setFar(1000.0f);
     }
 
     InstancingScene::~InstancingScene() {
@@ -24,7 +44,7 @@ namespace AhnrealEngine {
         // Required by base class but we use initialize(renderer)
     }
 
-    void InstancingScene::initialize(VulkanRenderer* renderer) {
+    void InstancingScene::prepare(VulkanRenderer* renderer, LoadProgress& progress) {
         device = renderer->getDevice();
         
         // Load a simple cube model to use its mesh data
@@ -33,14 +53,67 @@ namespace AhnrealEngine {
         } catch (...) {
              std::cerr << "Failed to load cube model for instancing, make sure models/cube.obj exists" << std::endl;
         }
+        progress.set(0.3f);
 
         createBuffers();
+        progress.set(0.9f);
+    }
+
+    uint64_t InstancingScene::getDeviceFootprint() const {
+        if (!device) return 0;
+
+        uint64_t bytes = 0;
+        auto add = [this, &bytes](VkBuffer buffer) {
+            if (buffer == VK_NULL_HANDLE) return;
+            VkMemoryRequirements requirements;
+            vkGetBufferMemoryRequirements(device->device(), buffer, &requirements);
+            bytes += requirements.size;
+        };
+
+        for (VkBuffer buffer : {instanceBuffer, visibleInstanceBuffer, indirectDrawBuffer, groupCountBuffer, visibilityMaskBuffer,
+                                bvhNodeBuffer, bvhSubtreeBuffer, bvhInstanceLeafBuffer, bvhLeafStateBuffer,
+                                depthKeyBuffer, sortScratchBuffer}) {
+            add(buffer);
+        }
+        if (cubeModel) {
+            for (const auto& mesh : cubeModel->getMeshes()) {
+                add(mesh->getPositionBuffer());
+                add(mesh->getAttributeBuffer());
+                add(mesh->getIndexBuffer());
+            }
+        }
+        return bytes;
+    }
+
+    void InstancingScene::initialize(VulkanRenderer* renderer) {
+        device = renderer->getDevice();
+        bindlessHeap = renderer->getBindlessHeap();
+
+        // Already done when the scene was preloaded
+        if (instanceBuffer == VK_NULL_HANDLE) {
+            LoadProgress progress;
+            prepare(renderer, progress);
+        }
+
+        registerBindlessBuffers();
         createComputePipeline();
         createGraphicsPipeline(renderer); // This now handles descriptor sets internally correctly
-        createDescriptorSets(); // This is for Compute
+        writeInstanceDescriptors();
+        primitives = std::make_unique<GpuPrimitives>(device);
+
+        if (device->capabilities().pipelineStatistics) {
+            VkQueryPoolCreateInfo queryInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+            queryInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            queryInfo.queryCount = VulkanSwapChain::MAX_FRAMES_IN_FLIGHT;
+            queryInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+            if (vkCreateQueryPool(device->device(), &queryInfo, nullptr, &statisticsQueryPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create pipeline statistics query pool!");
+            }
+            statisticsQueries.assign(VulkanSwapChain::MAX_FRAMES_IN_FLIGHT, StatisticsQuery{});
+        }
     }
 
-    void InstancingScene::update(float deltaTime) {
+    void InstancingScene::update(float deltaTime, FramePacket& packet) {
         // Camera Controls
         if (Input::isMouseButtonPressed(GLFW_MOUSE_BUTTON_RIGHT)) {
             glm::vec2 delta = Input::getMouseDelta();
@@ -53,215 +126,610 @@ namespace AhnrealEngine {
         if (Input::isKeyPressed(GLFW_KEY_S)) camera.processKeyboard(CameraMovement::Backward, deltaTime);
         if (Input::isKeyPressed(GLFW_KEY_A)) camera.processKeyboard(CameraMovement::Left, deltaTime);
         if (Input::isKeyPressed(GLFW_KEY_D)) camera.processKeyboard(CameraMovement::Right, deltaTime);
-        
-        updateCameraBuffer();
+
+        packet.camera = FrameCamera::capture(camera, packet.aspectRatio);
     }
 
-    void InstancingScene::preRender(VulkanRenderer* renderer) {
+    void InstancingScene::preRender(VulkanRenderer* renderer, const FramePacket& packet) {
         VkCommandBuffer commandBuffer = renderer->getCurrentCommandBuffer();
-        
-        // 1. Reset Atomic Counter via UpdateBuffer
-        vkCmdUpdateBuffer(commandBuffer, indirectDrawBuffer, 4, 4, &visibleCountCheck); 
-        
-        // Barrier: Transfer -> Compute
-        VkMemoryBarrier bufferBarrier{};
-        bufferBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-        bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &bufferBarrier, 0, nullptr, 0, nullptr);
-
-        // 2. Compute Culling
+        const uint32_t frameIndex = static_cast<uint32_t>(renderer->getFrameIndex());
+
+        // This slot's previous frame has finished, so its query is available
+        readOverdrawStats(frameIndex);
+
+        // Applied before anything in this frame references the instance sets
+        if (requestedInstanceCount != instanceCount) {
+            resizeInstances(requestedInstanceCount);
+        }
+
+        updateCameraBuffer(packet.renderCamera());
+
+        if (instancesDirty) {
+            recordInstanceGeneration(commandBuffer);
+            instancesDirty = false;
+            // The uploaded tree bounds the previous field
+            bvhReady = false;
+        }
+        updateBvh();
+
+        // 1. Compute Culling
         if (!freezeCulling) {
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipelineLayout, 0, 1, &computeDescriptorSet, 0, nullptr);
-            
-            // Push Constants
-            uint32_t totalInstances = INSTANCE_COUNT;
-            vkCmdPushConstants(commandBuffer, computePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &totalInstances);
-
-            // Group Count: (10000 + 255) / 256 = 40 groups. 40 * 256 = 10240 threads. Enough for 10000 instances.
-            uint32_t groupCount = (INSTANCE_COUNT + 255) / 256;
-            vkCmdDispatch(commandBuffer, groupCount, 1, 1);
-
-            // Barrier: Compute -> Draw/Vertex
-            VkBufferMemoryBarrier barriers[2] = {};
-            // Indirect Argument Barrier
-            barriers[0].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-            barriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-            barriers[0].dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
-            barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barriers[0].buffer = indirectDrawBuffer;
-            barriers[0].offset = 0;
-            barriers[0].size = VK_WHOLE_SIZE;
-
-            // Visible Indices Barrier (Vertex Shader Read)
-            barriers[1].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-            barriers[1].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-            barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barriers[1].buffer = visibleInstanceBuffer;
-            barriers[1].offset = 0;
-            barriers[1].size = VK_WHOLE_SIZE;
-
-            vkCmdPipelineBarrier(commandBuffer, 
-                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
-                VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 
-                0, 0, nullptr, 2, barriers, 0, nullptr);
-        }
-    }
-
-    void InstancingScene::render(VulkanRenderer* renderer) {
+            recordCulling(commandBuffer, renderer->getFrameDescriptorAllocator(), packet.renderCamera().farPlane);
+        }
+
+        if (statisticsQueryPool != VK_NULL_HANDLE) {
+            // Queries can't be reset inside the render pass
+            vkCmdResetQueryPool(commandBuffer, statisticsQueryPool, frameIndex, 1);
+            VkExtent2D extent = renderer->getSwapChainExtent();
+            framePixels = extent.width * extent.height;
+        }
+    }
+
+    void InstancingScene::readOverdrawStats(uint32_t frameIndex) {
+        if (statisticsQueryPool == VK_NULL_HANDLE || !statisticsQueries[frameIndex].written) return;
+
+        uint64_t invocations = 0;
+        if (vkGetQueryPoolResults(device->device(), statisticsQueryPool, frameIndex, 1, sizeof(invocations), &invocations,
+                                  sizeof(invocations), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+            int mode = static_cast<int>(statisticsQueries[frameIndex].sortMode);
+            fragmentInvocations[mode] = invocations;
+            hasFragmentInvocations[mode] = true;
+        }
+        statisticsQueries[frameIndex].written = false;
+    }
+
+    void InstancingScene::recordCulling(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, float farPlane) {
+        // One thread per instance, 256 per group
+        uint32_t cullGroups = (instanceCount + 255) / 256;
+        uint32_t totalInstances = instanceCount;
+
+        // The previous frame may still be drawing from the visible list
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+        // Barrier: Compute -> Compute, between the three passes
+        VkMemoryBarrier passBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        passBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        passBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        // Cull: visibility mask and visible count per group
+        if (bvhCulling && bvhReady) {
+            // Classify BVH leaves first; instances then only test when their
+            // leaf crosses a frustum plane
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, bvhTraversePass.pipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, bvhTraversePass.layout, 0, 1, &bvhTraversePass.set, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, bvhTraversePass.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BvhTraverseParams), &bvhParams);
+            vkCmdDispatch(commandBuffer, (bvhParams.subtreeCount + 63) / 64, 1, 1);
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &passBarrier, 0, nullptr, 0, nullptr);
+
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, bvhCullPass.pipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, bvhCullPass.layout, 0, 1, &bvhCullPass.set, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, bvhCullPass.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &totalInstances);
+        } else {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPass.pipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPass.layout, 0, 1, &cullPass.set, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, cullPass.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &totalInstances);
+        }
+        vkCmdDispatch(commandBuffer, cullGroups, 1, 1);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &passBarrier, 0, nullptr, 0, nullptr);
+
+        // Scan: group counts -> output offsets, total -> indirect instanceCount
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, scanPass.pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, scanPass.layout, 0, 1, &scanPass.set, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, scanPass.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &cullGroups);
+        vkCmdDispatch(commandBuffer, 1, 1, 1);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &passBarrier, 0, nullptr, 0, nullptr);
+
+        // Compact: visible instance indices in instance order
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, compactPass.pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, compactPass.layout, 0, 1, &compactPass.set, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, compactPass.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &totalInstances);
+        vkCmdDispatch(commandBuffer, cullGroups, 1, 1);
+
+        appliedSortMode = DepthSortMode::Off;
+        if (depthSortMode != DepthSortMode::Off && primitives) {
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &passBarrier, 0, nullptr, 0, nullptr);
+            recordDepthSort(commandBuffer, descriptors, farPlane);
+        }
+
+        // Barrier: Compute -> Draw/Vertex
+        VkBufferMemoryBarrier barriers[2] = {};
+        // Indirect Argument Barrier
+        barriers[0].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barriers[0].dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].buffer = indirectDrawBuffer;
+        barriers[0].offset = 0;
+        barriers[0].size = VK_WHOLE_SIZE;
+
+        // Visible Indices Barrier (Vertex Shader Read)
+        barriers[1].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barriers[1].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[1].buffer = visibleInstanceBuffer;
+        barriers[1].offset = 0;
+        barriers[1].size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(commandBuffer, 
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 
+            0, 0, nullptr, 2, barriers, 0, nullptr);
+    }
+
+    void InstancingScene::recordDepthSort(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, float farPlane) {
+        if (sortCapacity < instanceLayout.capacity) {
+            createSortBuffers();
+        }
+
+        // Only the visible slots are keyed and sorted; their count is what
+        // cull_scan wrote into the indirect commands
+        VkMemoryBarrier countBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        countBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        countBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+            0, 1, &countBarrier, 0, nullptr, 0, nullptr);
+
+        const bool bucketed = depthSortMode == DepthSortMode::Buckets;
+        DepthKeyParams params{bucketed ? 1u : 0u, farPlane};
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, depthKeyPass.pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, depthKeyPass.layout, 0, 1, &depthKeyPass.set, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, depthKeyPass.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(DepthKeyParams), &params);
+        vkCmdDispatchIndirect(commandBuffer, indirectDrawBuffer, offsetof(CullIndirectCommands, depthKeys));
+        GpuPrimitives::computeBarrier(commandBuffer);
+
+        // The visible indices are the sorted values, so the list is reordered in place
+        primitives->radixSortIndirect(commandBuffer, descriptors,
+            GpuBufferRange{depthKeyBuffer, 0, VK_WHOLE_SIZE}, GpuBufferRange{visibleInstanceBuffer, 0, VK_WHOLE_SIZE},
+            GpuBufferRange{indirectDrawBuffer, 0, VK_WHOLE_SIZE},
+            offsetof(VkDrawIndexedIndirectCommand, instanceCount) / sizeof(uint32_t), instanceCount,
+            1, bucketed ? 16 : 32, GpuBufferRange{sortScratchBuffer, 0, VK_WHOLE_SIZE});
+        appliedSortMode = depthSortMode;
+    }
+
+    void InstancingScene::createSortBuffers() {
+        // Only called while no frame uses the old ones (see destroyInstanceBuffers)
+        destroySortBuffers();
+
+        sortCapacity = instanceLayout.capacity;
+        device->createBuffer(sizeof(uint32_t) * sortCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthKeyBuffer, depthKeyBufferMemory);
+        // radixSortIndirect dispatches from arguments it writes to the scratch
+        device->createBuffer(primitives->getRadixSortScratchSize(sortCapacity, 1),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sortScratchBuffer, sortScratchBufferMemory);
+
+        // Depth keys: 3 DepthKeys
+        VkDescriptorBufferInfo keyInfo{ depthKeyBuffer, 0, VK_WHOLE_SIZE };
+        VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, depthKeyPass.set, 3, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &keyInfo, nullptr};
+        vkUpdateDescriptorSets(device->device(), 1, &write, 0, nullptr);
+    }
+
+    void InstancingScene::destroySortBuffers() {
+        if (depthKeyBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), depthKeyBuffer, nullptr); depthKeyBuffer = VK_NULL_HANDLE; }
+        if (depthKeyBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), depthKeyBufferMemory, nullptr); depthKeyBufferMemory = VK_NULL_HANDLE; }
+        if (sortScratchBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), sortScratchBuffer, nullptr); sortScratchBuffer = VK_NULL_HANDLE; }
+        if (sortScratchBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), sortScratchBufferMemory, nullptr); sortScratchBufferMemory = VK_NULL_HANDLE; }
+        sortCapacity = 0;
+    }
+
+    void InstancingScene::render(VulkanRenderer* renderer, const FramePacket& packet) {
         VkCommandBuffer commandBuffer = renderer->getCurrentCommandBuffer();
 
         // 3. Draw
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
         
-        // Bind Sets: Set 0 (Camera), Set 1 (Instances/Visible)
-        if (graphicsDescriptorSets.size() >= 2) {
+        if (bindlessHeap) {
+            // Heap set is shared by every bindless pipeline; only the indices change per draw
+            bindlessHeap->bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bindlessHeap->getPipelineLayout());
+            vkCmdPushConstants(commandBuffer, bindlessHeap->getPipelineLayout(), VK_SHADER_STAGE_ALL, 0, sizeof(BindlessDrawIndices), &bindlessIndices);
+        } else if (graphicsDescriptorSets.size() >= 2) {
+            // Bind Sets: Set 0 (Camera), Set 1 (Instances/Visible)
             vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelineLayout, 0, 2, graphicsDescriptorSets.data(), 0, nullptr);
         }
 
         if (cubeModel && !cubeModel->getMeshes().empty()) {
             Mesh* mesh = cubeModel->getMeshes()[0].get(); // Just draw first mesh
-            VkBuffer vertexBuffers[] = { mesh->getVertexBuffer() };
-            VkDeviceSize offsets[] = { 0 };
-            vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-            vkCmdBindIndexBuffer(commandBuffer, mesh->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+            mesh->bind(commandBuffer);
 
+            const uint32_t frameIndex = static_cast<uint32_t>(renderer->getFrameIndex());
+            if (statisticsQueryPool != VK_NULL_HANDLE) {
+                vkCmdBeginQuery(commandBuffer, statisticsQueryPool, frameIndex, 0);
+            }
             vkCmdDrawIndexedIndirect(commandBuffer, indirectDrawBuffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+            if (statisticsQueryPool != VK_NULL_HANDLE) {
+                vkCmdEndQuery(commandBuffer, statisticsQueryPool, frameIndex);
+                statisticsQueries[frameIndex] = {true, appliedSortMode};
+            }
         }
     }
 
     void InstancingScene::createBuffers() {
-        // 1. Instance Data Generation
-        std::vector<InstanceData> instances(INSTANCE_COUNT);
-        std::default_random_engine rnd((unsigned)time(nullptr));
-        std::uniform_real_distribution<float> distPos(-50.0f, 50.0f);
-        std::uniform_real_distribution<float> distScale(0.5f, 1.5f);
-        std::uniform_real_distribution<float> distRot(0.0f, 360.0f);
-
-        for (int i = 0; i < INSTANCE_COUNT; i++) {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(distPos(rnd), distPos(rnd), distPos(rnd)));
-            model = glm::rotate(model, glm::radians(distRot(rnd)), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(distScale(rnd)));
-            instances[i].model = model;
-        }
-
-        VkDeviceSize instanceBufferSize = sizeof(InstanceData) * INSTANCE_COUNT;
-        
-        // Staging
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        device->createBuffer(instanceBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-            stagingBuffer, stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(device->device(), stagingBufferMemory, 0, instanceBufferSize, 0, &data);
-        memcpy(data, instances.data(), (size_t)instanceBufferSize);
-        vkUnmapMemory(device->device(), stagingBufferMemory);
-
-        // Instance Buffer (Storage + TransferDst)
-        device->createBuffer(instanceBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, instanceBuffer, instanceBufferMemory);
-        device->copyBuffer(stagingBuffer, instanceBuffer, instanceBufferSize);
-        vkDestroyBuffer(device->device(), stagingBuffer, nullptr);
-        vkFreeMemory(device->device(), stagingBufferMemory, nullptr);
+        // Culling needs a world-space radius; take it from the mesh so it
+        // isn't assumed to be a unit cube
+        if (cubeModel && !cubeModel->getMeshes().empty()) {
+            meshRadius = cubeModel->getMeshes()[0]->getBoundingRadius();
+        }
+
+        // Contents are written by instance_generate.comp on the first frame
+        createInstanceBuffers(instanceCount);
+        instancesDirty = true;
 
-        // Camera Buffer
-        device->createBuffer(sizeof(CameraData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
+        // Camera Buffer (also a storage buffer so the bindless heap can expose it)
+        device->createBuffer(sizeof(CameraData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
             cameraBuffer, cameraBufferMemory);
         vkMapMemory(device->device(), cameraBufferMemory, 0, sizeof(CameraData), 0, &cameraBufferMapped);
 
         // Indirect Draw Buffer
-        device->createBuffer(sizeof(VkDrawIndexedIndirectCommand), 
+        device->createBuffer(sizeof(CullIndirectCommands), 
             VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indirectDrawBuffer, indirectDrawBufferMemory);
         
         // Init Indirect Command
         if (cubeModel && !cubeModel->getMeshes().empty()) {
-            VkDrawIndexedIndirectCommand cmd{};
-            cmd.indexCount = cubeModel->getMeshes()[0]->getIndexCount();
-            cmd.instanceCount = 0; // Start 0
-            cmd.firstIndex = 0;
-            cmd.vertexOffset = 0;
-            cmd.firstInstance = 0;
-
-            device->createBuffer(sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
+            CullIndirectCommands cmd{};
+            cmd.draw.indexCount = cubeModel->getMeshes()[0]->getIndexCount();
+            cmd.draw.instanceCount = 0; // Start 0
+            cmd.draw.firstIndex = 0;
+            cmd.draw.vertexOffset = 0;
+            cmd.draw.firstInstance = 0;
+            cmd.depthKeys = {0, 1, 1};
+
+            VkBuffer stagingBuffer;
+            VkDeviceMemory stagingBufferMemory;
+            device->createBuffer(sizeof(CullIndirectCommands), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
                 stagingBuffer, stagingBufferMemory);
             
-            vkMapMemory(device->device(), stagingBufferMemory, 0, sizeof(VkDrawIndexedIndirectCommand), 0, &data);
-            memcpy(data, &cmd, sizeof(VkDrawIndexedIndirectCommand));
+            void* data;
+            vkMapMemory(device->device(), stagingBufferMemory, 0, sizeof(CullIndirectCommands), 0, &data);
+            memcpy(data, &cmd, sizeof(CullIndirectCommands));
             vkUnmapMemory(device->device(), stagingBufferMemory);
             
-            device->copyBuffer(stagingBuffer, indirectDrawBuffer, sizeof(VkDrawIndexedIndirectCommand));
+            device->copyBuffer(stagingBuffer, indirectDrawBuffer, sizeof(CullIndirectCommands));
             vkDestroyBuffer(device->device(), stagingBuffer, nullptr);
             vkFreeMemory(device->device(), stagingBufferMemory, nullptr);
         }
+    }
+
+    void InstancingScene::createInstanceBuffers(uint32_t capacity) {
+        instanceLayout = InstanceStreamLayout::compute(capacity, device->capabilities().minStorageBufferOffsetAlignment);
+
+        // Instance streams, written by instance_generate.comp
+        device->createBuffer(instanceLayout.size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, instanceBuffer, instanceBufferMemory);
 
         // Visible Instances Buffer
-        device->createBuffer(sizeof(uint32_t) * INSTANCE_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
+        device->createBuffer(sizeof(uint32_t) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, visibleInstanceBuffer, visibleInstanceBufferMemory);
+
+        // Culling scratch: a count and 8 mask words per 256-instance group
+        uint32_t cullGroups = (capacity + 255) / 256;
+        device->createBuffer(sizeof(uint32_t) * cullGroups, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, groupCountBuffer, groupCountBufferMemory);
+        device->createBuffer(sizeof(uint32_t) * 8 * cullGroups, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, visibilityMaskBuffer, visibilityMaskBufferMemory);
+    }
+
+    void InstancingScene::destroyInstanceBuffers() {
+        if (instanceBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), instanceBuffer, nullptr); instanceBuffer = VK_NULL_HANDLE; }
+        if (instanceBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), instanceBufferMemory, nullptr); instanceBufferMemory = VK_NULL_HANDLE; }
+        if (visibleInstanceBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), visibleInstanceBuffer, nullptr); visibleInstanceBuffer = VK_NULL_HANDLE; }
+        if (visibleInstanceBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), visibleInstanceBufferMemory, nullptr); visibleInstanceBufferMemory = VK_NULL_HANDLE; }
+        if (groupCountBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), groupCountBuffer, nullptr); groupCountBuffer = VK_NULL_HANDLE; }
+        if (groupCountBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), groupCountBufferMemory, nullptr); groupCountBufferMemory = VK_NULL_HANDLE; }
+        if (visibilityMaskBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), visibilityMaskBuffer, nullptr); visibilityMaskBuffer = VK_NULL_HANDLE; }
+        if (visibilityMaskBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), visibilityMaskBufferMemory, nullptr); visibilityMaskBufferMemory = VK_NULL_HANDLE; }
+        // Sized by the capacity too; recreated by the next sorted frame
+        destroySortBuffers();
+    }
+
+    void InstancingScene::resizeInstances(uint32_t count) {
+        count = std::clamp(count, 1u, MAX_INSTANCE_COUNT);
+
+        if (count > instanceLayout.capacity) {
+            // Grow geometrically so dragging the count up doesn't reallocate every frame
+            uint32_t capacity = std::min(std::max(count, instanceLayout.capacity * 2), MAX_INSTANCE_COUNT);
+
+            // The old buffers and the sets pointing at them belong to frames in flight
+            device->waitIdle();
+            destroyInstanceBuffers();
+            createInstanceBuffers(capacity);
+            writeInstanceDescriptors();
+
+            if (bindlessHeap) {
+                bindlessHeap->updateStorageBuffer(bindlessIndices.positionScaleIndex, instanceBuffer, instanceLayout.positionScaleOffset, instanceLayout.positionScaleRange());
+                bindlessHeap->updateStorageBuffer(bindlessIndices.rotationIndex, instanceBuffer, instanceLayout.rotationOffset, instanceLayout.rotationRange());
+                bindlessHeap->updateStorageBuffer(bindlessIndices.visibleIndex, visibleInstanceBuffer);
+            }
+
+            // The frozen visible list lived in the old buffer
+            freezeCulling = false;
+        }
+
+        instanceCount = count;
+        requestedInstanceCount = count;
+        // The spread depends on the count, so the whole field is regenerated
+        instancesDirty = true;
+    }
+
+    void InstancingScene::recordInstanceGeneration(VkCommandBuffer commandBuffer) {
+        // Earlier frames may still be culling and drawing from these streams
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+        InstanceGenerateParams params{};
+        params.instanceCount = instanceCount;
+        params.seed = generationSeed;
+        params.spread = getSpread(instanceCount);
+        params.meshRadius = meshRadius;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, generatePass.pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, generatePass.layout, 0, 1, &generatePass.set, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, generatePass.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(InstanceGenerateParams), &params);
+        vkCmdDispatch(commandBuffer, (instanceCount + 255) / 256, 1, 1);
+
+        // Barrier: Generate -> Cull / Vertex
+        VkMemoryBarrier generateBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        generateBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        generateBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+            0, 1, &generateBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    float InstancingScene::getSpread(uint32_t count) {
+        // Keep the density of the default 10,000 instances in a 100-unit cube
+        return 50.0f * std::cbrt(std::max(1.0f, static_cast<float>(count) / DEFAULT_INSTANCE_COUNT));
+    }
+
+    void InstancingScene::updateBvh() {
+        if (bvhBuildCounter) {
+            if (!bvhBuildCounter->isDone()) return;
+            if (JobSystem* jobs = JobSystem::get()) jobs->wait(*bvhBuildCounter);
+            bvhBuildCounter.reset();
+
+            // The field may have changed again while the job ran
+            if (bvhBuildCount == instanceCount && bvhBuildSeed == generationSeed) {
+                uploadBvh();
+            }
+        }
+
+        if (bvhCulling && !bvhReady) {
+            startBvhBuild();
+        }
     }
 
-    void InstancingScene::updateCameraBuffer() {
+    void InstancingScene::startBvhBuild() {
+        const uint32_t count = instanceCount;
+        const uint32_t seed = generationSeed;
+        const float radius = meshRadius;
+        bvhBuildCount = count;
+        bvhBuildSeed = seed;
+
+        // Culling keeps the flat path until the tree is uploaded
+        bvhBuildCounter = std::make_unique<JobCounter>();
+        if (JobSystem* jobs = JobSystem::get()) {
+            jobs->run([this, count, seed, radius]() { buildBvh(count, seed, radius); }, bvhBuildCounter.get());
+        } else {
+            buildBvh(count, seed, radius);
+        }
+    }
+
+    void InstancingScene::buildBvh(uint32_t count, uint32_t seed, float radius) {
+        auto start = std::chrono::steady_clock::now();
+        JobSystem* jobs = JobSystem::get();
+
+        // Same sequence of draws as instance_generate.comp. The boxes are
+        // padded slightly so the GPU's rounding can't move an instance out
+        // of its leaf.
+        const float spread = getSpread(count);
+        const uint32_t seedHash = pcgHash(seed);
+        const float padding = spread * 1e-5f;
+        std::vector<Aabb> bounds(count);
+        JobSystem::RangeFunction generate = [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                uint32_t state = pcgHash(i ^ seedHash);
+                float x = nextRandom(state);
+                float y = nextRandom(state);
+                float z = nextRandom(state);
+                glm::vec3 position = (glm::vec3(x, y, z) * 2.0f - 1.0f) * spread;
+                float scale = 0.5f + nextRandom(state); // mix(0.5, 1.5, r)
+                glm::vec3 extent(radius * scale + padding);
+                bounds[i].min = position - extent;
+                bounds[i].max = position + extent;
+            }
+        };
+        if (jobs) {
+            jobs->parallelFor(count, generate, 4096);
+        } else {
+            generate(0, count);
+        }
+
+        BoundingVolumeHierarchy bvh;
+        if (jobs) {
+            bvh.setParallelFor([jobs](uint32_t taskCount, const BoundingVolumeHierarchy::RangeFunction& function) {
+                jobs->parallelFor(taskCount, function, 1);
+            });
+        }
+        BoundingVolumeHierarchy::BuildSettings settings;
+        settings.maxLeafSize = BVH_LEAF_SIZE;
+        bvh.build(bounds.data(), count, settings);
+        bvh.flatten(bvhLayout, BVH_SUBTREE_LEAVES);
+
+        bvhSahCost = bvh.getSahCost();
+        bvhBuildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void InstancingScene::uploadBvh() {
+        // Earlier frames may still be culling with the old tree
+        device->waitIdle();
+        destroyBvhBuffers();
+
+        auto upload = [this](const void* source, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory) {
+            device->createBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory);
+
+            VkBuffer stagingBuffer;
+            VkDeviceMemory stagingBufferMemory;
+            device->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                stagingBuffer, stagingBufferMemory);
+
+            void* data;
+            vkMapMemory(device->device(), stagingBufferMemory, 0, size, 0, &data);
+            memcpy(data, source, static_cast<size_t>(size));
+            vkUnmapMemory(device->device(), stagingBufferMemory);
+
+            device->copyBuffer(stagingBuffer, buffer, size);
+            vkDestroyBuffer(device->device(), stagingBuffer, nullptr);
+            vkFreeMemory(device->device(), stagingBufferMemory, nullptr);
+        };
+        upload(bvhLayout.nodes.data(), sizeof(BvhGpuNode) * bvhLayout.nodes.size(), bvhNodeBuffer, bvhNodeBufferMemory);
+        upload(bvhLayout.subtreeRoots.data(), sizeof(uint32_t) * bvhLayout.subtreeRoots.size(), bvhSubtreeBuffer, bvhSubtreeBufferMemory);
+        upload(bvhLayout.itemLeaf.data(), sizeof(uint32_t) * bvhLayout.itemLeaf.size(), bvhInstanceLeafBuffer, bvhInstanceLeafBufferMemory);
+        // Written by cull_bvh_traverse.comp every frame
+        device->createBuffer(sizeof(uint32_t) * bvhLayout.leafCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, bvhLeafStateBuffer, bvhLeafStateBufferMemory);
+
+        VkDescriptorBufferInfo nodeInfo{ bvhNodeBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo subtreeInfo{ bvhSubtreeBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo instanceLeafInfo{ bvhInstanceLeafBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo leafStateInfo{ bvhLeafStateBuffer, 0, VK_WHOLE_SIZE };
+
+        std::vector<VkWriteDescriptorSet> writes;
+        // Traverse: 1 Nodes, 2 SubtreeRoots, 3 LeafStates
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhTraversePass.set, 1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &nodeInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhTraversePass.set, 2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &subtreeInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhTraversePass.set, 3, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &leafStateInfo, nullptr});
+        // BVH cull: 5 InstanceLeaves, 6 LeafStates
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhCullPass.set, 5, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &instanceLeafInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhCullPass.set, 6, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &leafStateInfo, nullptr});
+        vkUpdateDescriptorSets(device->device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+        bvhParams.subtreeCount = static_cast<uint32_t>(bvhLayout.subtreeRoots.size());
+        bvhParams.nodeCount = static_cast<uint32_t>(bvhLayout.nodes.size());
+        bvhParams.leafCount = bvhLayout.leafCount;
+        // Only the counts are needed from here on
+        bvhLayout = BvhGpuLayout{};
+        bvhReady = true;
+    }
+
+    void InstancingScene::destroyBvhBuffers() {
+        if (bvhNodeBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), bvhNodeBuffer, nullptr); bvhNodeBuffer = VK_NULL_HANDLE; }
+        if (bvhNodeBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), bvhNodeBufferMemory, nullptr); bvhNodeBufferMemory = VK_NULL_HANDLE; }
+        if (bvhSubtreeBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), bvhSubtreeBuffer, nullptr); bvhSubtreeBuffer = VK_NULL_HANDLE; }
+        if (bvhSubtreeBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), bvhSubtreeBufferMemory, nullptr); bvhSubtreeBufferMemory = VK_NULL_HANDLE; }
+        if (bvhInstanceLeafBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), bvhInstanceLeafBuffer, nullptr); bvhInstanceLeafBuffer = VK_NULL_HANDLE; }
+        if (bvhInstanceLeafBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), bvhInstanceLeafBufferMemory, nullptr); bvhInstanceLeafBufferMemory = VK_NULL_HANDLE; }
+        if (bvhLeafStateBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), bvhLeafStateBuffer, nullptr); bvhLeafStateBuffer = VK_NULL_HANDLE; }
+        if (bvhLeafStateBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), bvhLeafStateBufferMemory, nullptr); bvhLeafStateBufferMemory = VK_NULL_HANDLE; }
+        bvhReady = false;
+    }
+
+    // The heap is shared with the frame being recorded, so this stays on the main thread
+    void InstancingScene::registerBindlessBuffers() {
+        if (bindlessHeap) {
+            bindlessIndices.cameraIndex = bindlessHeap->registerStorageBuffer(cameraBuffer, 0, sizeof(CameraData));
+            bindlessIndices.positionScaleIndex = bindlessHeap->registerStorageBuffer(instanceBuffer, instanceLayout.positionScaleOffset, instanceLayout.positionScaleRange());
+            bindlessIndices.rotationIndex = bindlessHeap->registerStorageBuffer(instanceBuffer, instanceLayout.rotationOffset, instanceLayout.rotationRange());
+            bindlessIndices.visibleIndex = bindlessHeap->registerStorageBuffer(visibleInstanceBuffer);
+        }
+    }
+
+    void InstancingScene::updateCameraBuffer(const FrameCamera& frameCamera) {
         CameraData camData{};
-        camData.view = camera.getViewMatrix();
-        VkExtent2D extent = device->getSwapChainSupport().capabilities.currentExtent;
-        float aspect = (float)extent.width / (float)extent.height;
-        camData.proj = camera.getProjectionMatrix(aspect);
-
-        // Frustum Culling Planes
-        // GLM is column-major, so m[col][row].
-        // We want rows of VP matrix.
-        // Direct access: Row i = vec4(vp[0][i], vp[1][i], vp[2][i], vp[3][i])
-        // Or simple transpose:
-        glm::mat4 vp = camData.proj * camData.view;
-        glm::mat4 vpT = glm::transpose(vp);
-        
-        camData.frustumPlanes[0] = vpT[3] + vpT[0]; // Left
-        camData.frustumPlanes[1] = vpT[3] - vpT[0]; // Right
-        camData.frustumPlanes[2] = vpT[3] + vpT[1]; // Bottom
-        camData.frustumPlanes[3] = vpT[3] - vpT[1]; // Top
-        camData.frustumPlanes[4] = vpT[3] + vpT[2]; // Near
-        camData.frustumPlanes[5] = vpT[3] - vpT[2]; // Far
+        camData.view = frameCamera.view;
+        camData.proj = frameCamera.proj;
+
+        camData.viewProj = camData.proj * camData.view;
 
-        for (int i = 0; i < 6; i++) {
-            camData.frustumPlanes[i] /= glm::length(glm::vec3(camData.frustumPlanes[i]));
+        Frustum frustum = Frustum::fromViewProjection(camData.viewProj);
+        for (int i = 0; i < Frustum::PlaneCount; i++) {
+            camData.frustumPlanes[i] = frustum.planes[i];
         }
 
         memcpy(cameraBufferMapped, &camData, sizeof(CameraData));
     }
 
     void InstancingScene::createComputePipeline() {
-        // [0: Instance(S), 1: Cam(U), 2: Indir(S), 3: Vis(S)]
-        std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
-        
-        bindings[0] = {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr};
-        bindings[1] = {1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr};
-        bindings[2] = {2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr};
-        bindings[3] = {3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr};
+        // --- Allocation ---
+        VkDescriptorPoolSize poolSizes[] = {
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 25 }, // Generate 3, Cull 4, Scan 2, Compact 3, Traverse 3, BVH cull 6, Depth keys 4
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 4 }   // Cam: Cull, Traverse, BVH cull, Depth keys
+        };
+        VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, nullptr, 0, 7, 2, poolSizes};
+        vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &computeDescriptorPool);
+
+        const VkDescriptorType storage = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        // [0: PositionScale, 1: Rotation, 2: Radius]
+        createComputePass(generatePass, "instance_generate.comp.spv", {storage, storage, storage}, sizeof(InstanceGenerateParams));
+        // [0: PositionScale(S), 1: Cam(U), 2: GroupCounts(S), 3: VisibilityMask(S), 4: Radius(S)]
+        createComputePass(cullPass, "cull.comp.spv", {storage, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, storage, storage, storage}, sizeof(uint32_t));
+        // [0: GroupCounts, 1: Indirect]
+        subgroupScan = device->capabilities().subgroupArithmetic;
+        createComputePass(scanPass, subgroupScan ? "cull_scan_subgroup.comp.spv" : "cull_scan.comp.spv", {storage, storage}, sizeof(uint32_t));
+        // [0: VisibilityMask, 1: GroupOffsets, 2: Visible]
+        createComputePass(compactPass, "cull_compact.comp.spv", {storage, storage, storage}, sizeof(uint32_t));
+        // [0: Cam(U), 1: Nodes, 2: SubtreeRoots, 3: LeafStates]
+        createComputePass(bvhTraversePass, "cull_bvh_traverse.comp.spv", {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, storage, storage, storage}, sizeof(BvhTraverseParams));
+        // Cull's bindings plus [5: InstanceLeaves, 6: LeafStates]
+        createComputePass(bvhCullPass, "cull_bvh.comp.spv", {storage, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, storage, storage, storage, storage, storage}, sizeof(uint32_t));
+        // [0: Cam(U), 1: PositionScale, 2: Visible, 3: DepthKeys, 4: Indirect]
+        createComputePass(depthKeyPass, "cull_depth_keys.comp.spv", {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, storage, storage, storage, storage}, sizeof(DepthKeyParams));
+
+        // --- Update Descriptor Set ---
+        // Instance stream and scratch bindings are written by writeInstanceDescriptors,
+        // BVH bindings by uploadBvh, depth keys by createSortBuffers
+        VkDescriptorBufferInfo camInfo{ cameraBuffer, 0, sizeof(CameraData) };
+        VkDescriptorBufferInfo indirInfo{ indirectDrawBuffer, 0, VK_WHOLE_SIZE };
+
+        std::vector<VkWriteDescriptorSet> computeWrites;
+        computeWrites.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, cullPass.set, 1, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, nullptr, &camInfo, nullptr});
+        computeWrites.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhTraversePass.set, 0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, nullptr, &camInfo, nullptr});
+        computeWrites.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhCullPass.set, 1, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, nullptr, &camInfo, nullptr});
+        computeWrites.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, scanPass.set, 1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &indirInfo, nullptr});
+        computeWrites.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, depthKeyPass.set, 0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, nullptr, &camInfo, nullptr});
+        computeWrites.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, depthKeyPass.set, 4, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &indirInfo, nullptr});
+
+        vkUpdateDescriptorSets(device->device(), static_cast<uint32_t>(computeWrites.size()), computeWrites.data(), 0, nullptr);
+    }
+
+    void InstancingScene::createComputePass(ComputePass& pass, const std::string& shaderFile,
+                                            const std::vector<VkDescriptorType>& bindings, uint32_t pushConstantSize) {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBindings(bindings.size());
+        for (uint32_t i = 0; i < layoutBindings.size(); i++) {
+            layoutBindings[i] = {i, bindings[i], 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr};
+        }
 
         VkDescriptorSetLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-        layoutInfo.pBindings = bindings.data();
+        layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
+        layoutInfo.pBindings = layoutBindings.data();
 
-        vkCreateDescriptorSetLayout(device->device(), &layoutInfo, nullptr, &computeDescriptorSetLayout);
+        vkCreateDescriptorSetLayout(device->device(), &layoutInfo, nullptr, &pass.setLayout);
 
-        VkPushConstantRange pushConstant{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t)};
+        VkPushConstantRange pushConstant{VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize};
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
         pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &computeDescriptorSetLayout;
+        pipelineLayoutInfo.pSetLayouts = &pass.setLayout;
         pipelineLayoutInfo.pushConstantRangeCount = 1;
         pipelineLayoutInfo.pPushConstantRanges = &pushConstant;
 
-        vkCreatePipelineLayout(device->device(), &pipelineLayoutInfo, nullptr, &computePipelineLayout);
+        vkCreatePipelineLayout(device->device(), &pipelineLayoutInfo, nullptr, &pass.layout);
+
+        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr, computeDescriptorPool, 1, &pass.setLayout};
+        if (vkAllocateDescriptorSets(device->device(), &allocInfo, &pass.set) != VK_SUCCESS) {
+             throw std::runtime_error("failed to allocate compute descriptor sets!");
+        }
 
         // Load Shader
         auto readFile = [](const std::string& filename) {
@@ -280,108 +748,32 @@ namespace AhnrealEngine {
                      std::vector<char> buffer(fileSize);
                      file.seekg(0);
                      file.read(buffer.data(), fileSize);
-                     // std::cout << "Loaded shader: " << path << std::endl; // Debug print if needed
                      return buffer;
                  }
              }
              
              throw std::runtime_error("Failed to find/open shader file: " + filename);
         };
-        auto computeCode = readFile("cull.comp.spv");
+        auto computeCode = readFile(shaderFile);
         VkShaderModule computeModule;
         VkShaderModuleCreateInfo createInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
         createInfo.codeSize = computeCode.size();
         createInfo.pCode = reinterpret_cast<const uint32_t*>(computeCode.data());
         vkCreateShaderModule(device->device(), &createInfo, nullptr, &computeModule);
-        
-        // --- Allocation ---
-        VkDescriptorPoolSize poolSizes[] = {
-            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 }, // Inst, Indir, Vis
-            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 }  // Cam
-        };
-        VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, nullptr, 0, 1, 2, poolSizes};
-        vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &computeDescriptorPool);
-
-        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr, computeDescriptorPool, 1, &computeDescriptorSetLayout};
-        if (vkAllocateDescriptorSets(device->device(), &allocInfo, &computeDescriptorSet) != VK_SUCCESS) {
-             throw std::runtime_error("failed to allocate compute descriptor sets!");
-        }
-
-        // --- Update Descriptor Set ---
-        VkDescriptorBufferInfo instInfo{ instanceBuffer, 0, VK_WHOLE_SIZE };
-        VkDescriptorBufferInfo camInfo{ cameraBuffer, 0, sizeof(CameraData) };
-        VkDescriptorBufferInfo indirInfo{ indirectDrawBuffer, 0, VK_WHOLE_SIZE };
-        VkDescriptorBufferInfo visInfo{ visibleInstanceBuffer, 0, VK_WHOLE_SIZE };
-
-        std::vector<VkWriteDescriptorSet> computeWrites;
-        computeWrites.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, computeDescriptorSet, 0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &instInfo, nullptr});
-        computeWrites.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, computeDescriptorSet, 1, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, nullptr, &camInfo, nullptr});
-        computeWrites.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, computeDescriptorSet, 2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &indirInfo, nullptr});
-        computeWrites.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, computeDescriptorSet, 3, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &visInfo, nullptr});
-
-        vkUpdateDescriptorSets(device->device(), static_cast<uint32_t>(computeWrites.size()), computeWrites.data(), 0, nullptr);
 
         VkComputePipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
-        pipelineInfo.layout = computePipelineLayout;
+        pipelineInfo.layout = pass.layout;
         pipelineInfo.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, computeModule, "main", nullptr};
 
-        vkCreateComputePipelines(device->device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline);
+        vkCreateComputePipelines(device->device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pass.pipeline);
         vkDestroyShaderModule(device->device(), computeModule, nullptr);
     }
 
     void InstancingScene::createGraphicsPipeline(VulkanRenderer* renderer) {
-        // Set 0: Camera (UBO)
-        VkDescriptorSetLayoutBinding camBinding = {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr};
-        VkDescriptorSetLayoutCreateInfo set0Info{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 1, &camBinding};
-        vkCreateDescriptorSetLayout(device->device(), &set0Info, nullptr, &graphicsSet0Layout);
-
-        // Set 1: Instance(SSBO), Visible(SSBO)
-        VkDescriptorSetLayoutBinding instBindings[] = {
-            {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr},
-            {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr}
-        };
-        VkDescriptorSetLayoutCreateInfo set1Info{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 2, instBindings};
-        VkDescriptorSetLayout set1Layout;
-        vkCreateDescriptorSetLayout(device->device(), &set1Info, nullptr, &set1Layout);
-
-        graphicsDescriptorSetLayout = set1Layout; 
-        std::array<VkDescriptorSetLayout, 2> layouts = { graphicsSet0Layout, graphicsDescriptorSetLayout };
-
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
-        pipelineLayoutInfo.setLayoutCount = 2;
-        pipelineLayoutInfo.pSetLayouts = layouts.data();
-        vkCreatePipelineLayout(device->device(), &pipelineLayoutInfo, nullptr, &graphicsPipelineLayout);
-
-        // --- Allocation ---
-        VkDescriptorPoolSize poolSizes[] = {
-            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 },
-            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 }
-        };
-        VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, nullptr, 0, 1, 2, poolSizes};
-        poolInfo.maxSets = 2; // We need 2 sets (Set 0 and Set 1)
-        vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &graphicsDescriptorPool);
-
-        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr, graphicsDescriptorPool, 2, layouts.data()};
-        graphicsDescriptorSets.resize(2);
-        if (vkAllocateDescriptorSets(device->device(), &allocInfo, graphicsDescriptorSets.data()) != VK_SUCCESS) {
-             throw std::runtime_error("failed to allocate graphics descriptor sets!");
+        if (!bindlessHeap) {
+            createGraphicsDescriptorSets();
         }
 
-        // Update Set 0
-        VkDescriptorBufferInfo camInfo{ cameraBuffer, 0, sizeof(CameraData) };
-        VkWriteDescriptorSet writeCam{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, graphicsDescriptorSets[0], 0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, nullptr, &camInfo, nullptr};
-        
-        // Update Set 1
-        VkDescriptorBufferInfo instInfo{ instanceBuffer, 0, VK_WHOLE_SIZE };
-        VkDescriptorBufferInfo visInfo{ visibleInstanceBuffer, 0, VK_WHOLE_SIZE };
-        VkWriteDescriptorSet writes[] = {
-            {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, graphicsDescriptorSets[1], 0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &instInfo, nullptr},
-            {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, graphicsDescriptorSets[1], 1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &visInfo, nullptr}
-        };
-        
-        vkUpdateDescriptorSets(device->device(), 1, &writeCam, 0, nullptr);
-        vkUpdateDescriptorSets(device->device(), 2, writes, 0, nullptr);
-
         // --- Pipeline ---
         auto readFile = [](const std::string& filename) {
              std::vector<std::string> paths = {
@@ -405,7 +797,7 @@ namespace AhnrealEngine {
              throw std::runtime_error("Failed to find/open shader file: " + filename);
         };
 
-        auto vertCode = readFile("instance.vert.spv");
+        auto vertCode = readFile(bindlessHeap ? "instance_bindless.vert.spv" : "instance.vert.spv");
         auto fragCode = readFile("instance.frag.spv");
         VkShaderModule vertModule, fragModule;
         VkShaderModuleCreateInfo vInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, nullptr, 0, vertCode.size(), reinterpret_cast<const uint32_t*>(vertCode.data())};
@@ -418,9 +810,9 @@ namespace AhnrealEngine {
             {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragModule, "main", nullptr}
         };
 
-        auto bindDesc = Vertex::getBindingDescription();
+        auto bindDesc = Vertex::getBindingDescriptions();
         auto attrDesc = Vertex::getAttributeDescriptions();
-        VkPipelineVertexInputStateCreateInfo vertInput{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO, nullptr, 0, 1, &bindDesc, static_cast<uint32_t>(attrDesc.size()), attrDesc.data()};
+        VkPipelineVertexInputStateCreateInfo vertInput{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO, nullptr, 0, static_cast<uint32_t>(bindDesc.size()), bindDesc.data(), static_cast<uint32_t>(attrDesc.size()), attrDesc.data()};
         VkPipelineInputAssemblyStateCreateInfo inputAssembly{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO, nullptr, 0, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_FALSE};
         
         VkPipelineViewportStateCreateInfo viewportState{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO, nullptr, 0, 1, nullptr, 1, nullptr};
@@ -445,7 +837,7 @@ namespace AhnrealEngine {
         pipeInfo.pDepthStencilState = &depthStencil;
         pipeInfo.pColorBlendState = &blend;
         pipeInfo.pDynamicState = &dynamicInfo;
-        pipeInfo.layout = graphicsPipelineLayout;
+        pipeInfo.layout = bindlessHeap ? bindlessHeap->getPipelineLayout() : graphicsPipelineLayout;
         pipeInfo.renderPass = renderer->getSwapChainRenderPass();
         pipeInfo.subpass = 0;
 
@@ -455,26 +847,183 @@ namespace AhnrealEngine {
         vkDestroyShaderModule(device->device(), fragModule, nullptr);
     }
     
-    void InstancingScene::createDescriptorSets() {
-        // Already handled in createComputePipeline and createGraphicsPipeline
-        // This function was originally just for Compute, logic moved to initialization for clarity in correct order
+    void InstancingScene::createGraphicsDescriptorSets() {
+        // Set 0: Camera (UBO)
+        VkDescriptorSetLayoutBinding camBinding = {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr};
+        VkDescriptorSetLayoutCreateInfo set0Info{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 1, &camBinding};
+        vkCreateDescriptorSetLayout(device->device(), &set0Info, nullptr, &graphicsSet0Layout);
+
+        // Set 1: PositionScale(SSBO), Visible(SSBO), Rotation(SSBO)
+        VkDescriptorSetLayoutBinding instBindings[] = {
+            {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr},
+            {2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr}
+        };
+        VkDescriptorSetLayoutCreateInfo set1Info{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 3, instBindings};
+        VkDescriptorSetLayout set1Layout;
+        vkCreateDescriptorSetLayout(device->device(), &set1Info, nullptr, &set1Layout);
+
+        graphicsDescriptorSetLayout = set1Layout; 
+        std::array<VkDescriptorSetLayout, 2> layouts = { graphicsSet0Layout, graphicsDescriptorSetLayout };
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        pipelineLayoutInfo.setLayoutCount = 2;
+        pipelineLayoutInfo.pSetLayouts = layouts.data();
+        vkCreatePipelineLayout(device->device(), &pipelineLayoutInfo, nullptr, &graphicsPipelineLayout);
+
+        // --- Allocation ---
+        VkDescriptorPoolSize poolSizes[] = {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 }
+        };
+        VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, nullptr, 0, 1, 2, poolSizes};
+        poolInfo.maxSets = 2; // We need 2 sets (Set 0 and Set 1)
+        vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &graphicsDescriptorPool);
+
+        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr, graphicsDescriptorPool, 2, layouts.data()};
+        graphicsDescriptorSets.resize(2);
+        if (vkAllocateDescriptorSets(device->device(), &allocInfo, graphicsDescriptorSets.data()) != VK_SUCCESS) {
+             throw std::runtime_error("failed to allocate graphics descriptor sets!");
+        }
+
+        // Update Set 0
+        VkDescriptorBufferInfo camInfo{ cameraBuffer, 0, sizeof(CameraData) };
+        VkWriteDescriptorSet writeCam{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, graphicsDescriptorSets[0], 0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, nullptr, &camInfo, nullptr};
+        
+        // Set 1 is written by writeInstanceDescriptors
+        vkUpdateDescriptorSets(device->device(), 1, &writeCam, 0, nullptr);
+    }
+
+    // Everything that points at instanceBuffer or visibleInstanceBuffer, so it
+    // can be rewritten when resizeInstances reallocates them
+    void InstancingScene::writeInstanceDescriptors() {
+        VkDescriptorBufferInfo positionInfo{ instanceBuffer, instanceLayout.positionScaleOffset, instanceLayout.positionScaleRange() };
+        VkDescriptorBufferInfo rotationInfo{ instanceBuffer, instanceLayout.rotationOffset, instanceLayout.rotationRange() };
+        VkDescriptorBufferInfo radiusInfo{ instanceBuffer, instanceLayout.radiusOffset, instanceLayout.radiusRange() };
+        VkDescriptorBufferInfo visInfo{ visibleInstanceBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo groupCountInfo{ groupCountBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo maskInfo{ visibilityMaskBuffer, 0, VK_WHOLE_SIZE };
+
+        std::vector<VkWriteDescriptorSet> writes;
+        // Generate: 0 PositionScale, 1 Rotation, 2 Radius
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, generatePass.set, 0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &positionInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, generatePass.set, 1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &rotationInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, generatePass.set, 2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &radiusInfo, nullptr});
+        // Cull: 0 PositionScale, 2 GroupCounts, 3 VisibilityMask, 4 Radius
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, cullPass.set, 0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &positionInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, cullPass.set, 2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &groupCountInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, cullPass.set, 3, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &maskInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, cullPass.set, 4, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &radiusInfo, nullptr});
+        // BVH cull: same as Cull
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhCullPass.set, 0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &positionInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhCullPass.set, 2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &groupCountInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhCullPass.set, 3, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &maskInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, bvhCullPass.set, 4, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &radiusInfo, nullptr});
+        // Scan: 0 GroupCounts
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, scanPass.set, 0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &groupCountInfo, nullptr});
+        // Compact: 0 VisibilityMask, 1 GroupOffsets, 2 Visible
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, compactPass.set, 0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &maskInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, compactPass.set, 1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &groupCountInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, compactPass.set, 2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &visInfo, nullptr});
+        // Depth keys: 1 PositionScale, 2 Visible
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, depthKeyPass.set, 1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &positionInfo, nullptr});
+        writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, depthKeyPass.set, 2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &visInfo, nullptr});
+        // Graphics Set 1: 0 PositionScale, 1 Visible, 2 Rotation
+        if (graphicsDescriptorSets.size() >= 2) {
+            writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, graphicsDescriptorSets[1], 0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &positionInfo, nullptr});
+            writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, graphicsDescriptorSets[1], 1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &visInfo, nullptr});
+            writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, graphicsDescriptorSets[1], 2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &rotationInfo, nullptr});
+        }
+
+        vkUpdateDescriptorSets(device->device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
     }
 
     void InstancingScene::onImGuiRender() {
         ImGui::Begin("GPU Instancing Stats");
-        ImGui::Text("Total Instances: %d", INSTANCE_COUNT);
+        ImGui::Text("Total Instances: %u", instanceCount);
         ImGui::Text("Visible Instances: %d (GPU)", visibleCountCheck); 
+        ImGui::Text("Instance Data: %u B/instance", static_cast<uint32_t>(InstanceStreamLayout::POSITION_SCALE_STRIDE + InstanceStreamLayout::ROTATION_STRIDE + InstanceStreamLayout::RADIUS_STRIDE));
+        ImGui::Text("Descriptors: %s", bindlessHeap ? "Bindless heap" : "Per-scene sets");
+        ImGui::Text("Visibility Scan: %s", subgroupScan ? "Subgroup" : "Shared memory");
+
+        // Applied in preRender; the buffers grow when the count exceeds capacity
+        int count = static_cast<int>(requestedInstanceCount);
+        if (ImGui::SliderInt("Instance Count", &count, 1, static_cast<int>(MAX_INSTANCE_COUNT), "%d", ImGuiSliderFlags_Logarithmic)) {
+            requestedInstanceCount = static_cast<uint32_t>(count);
+        }
+        int seed = static_cast<int>(generationSeed);
+        if (ImGui::InputInt("Seed", &seed)) {
+            generationSeed = static_cast<uint32_t>(seed);
+            instancesDirty = true;
+        }
+        ImGui::Text("Capacity: %u (%.1f MB)", instanceLayout.capacity,
+            (instanceLayout.size + instanceLayout.capacity * sizeof(uint32_t)) / (1024.0 * 1024.0));
         ImGui::Checkbox("Freeze Culling", &freezeCulling);
+        // Built on a worker; culling stays flat until the tree is uploaded
+        ImGui::Checkbox("BVH Culling", &bvhCulling);
+        if (bvhCulling) {
+            if (bvhReady) {
+                ImGui::Text("BVH: %u nodes, %u leaves, %u subtrees", bvhParams.nodeCount, bvhParams.leafCount, bvhParams.subtreeCount);
+                ImGui::Text("BVH Build: %.1f ms (SAH cost %.1f)", bvhBuildMs, bvhSahCost);
+            } else {
+                ImGui::Text("BVH: building...");
+            }
+        }
+
+        const char* sortModes[] = { "Off", "Buckets (16-bit)", "Full (32-bit)" };
+        int sortMode = static_cast<int>(depthSortMode);
+        if (ImGui::Combo("Depth Sort", &sortMode, sortModes, 3)) {
+            depthSortMode = static_cast<DepthSortMode>(sortMode);
+        }
+        if (statisticsQueryPool != VK_NULL_HANDLE) {
+            // Latest frame drawn in each order; compare from the same view
+            for (int mode = 0; mode < 3; mode++) {
+                if (!hasFragmentInvocations[mode]) continue;
+                ImGui::Text("Fragments (%s): %llu (%.2f per pixel)", sortModes[mode],
+                    static_cast<unsigned long long>(fragmentInvocations[mode]),
+                    framePixels > 0 ? static_cast<double>(fragmentInvocations[mode]) / framePixels : 0.0);
+            }
+            const int current = static_cast<int>(depthSortMode);
+            const int off = static_cast<int>(DepthSortMode::Off);
+            if (current != off && hasFragmentInvocations[current] && hasFragmentInvocations[off] && fragmentInvocations[off] > 0) {
+                ImGui::Text("Overdraw Saved: %.1f%%",
+                    100.0 * (1.0 - static_cast<double>(fragmentInvocations[current]) / fragmentInvocations[off]));
+            }
+        } else {
+            ImGui::Text("Fragments: pipeline statistics not supported");
+        }
         ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
         ImGui::End();
     }
     
     void InstancingScene::cleanup() {
-        if (device) vkDeviceWaitIdle(device->device());
+        // The build job writes into this scene
+        if (bvhBuildCounter) {
+            if (JobSystem* jobs = JobSystem::get()) jobs->wait(*bvhBuildCounter);
+            bvhBuildCounter.reset();
+        }
+        bvhLayout = BvhGpuLayout{};
+
+        if (device) device->waitIdle();
+
+        if (bindlessHeap) {
+            bindlessHeap->releaseStorageBuffer(bindlessIndices.cameraIndex);
+            bindlessHeap->releaseStorageBuffer(bindlessIndices.positionScaleIndex);
+            bindlessHeap->releaseStorageBuffer(bindlessIndices.rotationIndex);
+            bindlessHeap->releaseStorageBuffer(bindlessIndices.visibleIndex);
+            bindlessIndices = {INVALID_BINDLESS_INDEX, INVALID_BINDLESS_INDEX, INVALID_BINDLESS_INDEX, INVALID_BINDLESS_INDEX};
+        }
 
-        if (computePipeline != VK_NULL_HANDLE) { vkDestroyPipeline(device->device(), computePipeline, nullptr); computePipeline = VK_NULL_HANDLE; }
-        if (computePipelineLayout != VK_NULL_HANDLE) { vkDestroyPipelineLayout(device->device(), computePipelineLayout, nullptr); computePipelineLayout = VK_NULL_HANDLE; }
-        if (computeDescriptorSetLayout != VK_NULL_HANDLE) { vkDestroyDescriptorSetLayout(device->device(), computeDescriptorSetLayout, nullptr); computeDescriptorSetLayout = VK_NULL_HANDLE; }
+        primitives.reset();
+        if (statisticsQueryPool != VK_NULL_HANDLE) { vkDestroyQueryPool(device->device(), statisticsQueryPool, nullptr); statisticsQueryPool = VK_NULL_HANDLE; }
+        statisticsQueries.clear();
+
+        for (ComputePass* pass : {&generatePass, &cullPass, &scanPass, &compactPass, &bvhTraversePass, &bvhCullPass, &depthKeyPass}) {
+            if (pass->pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device->device(), pass->pipeline, nullptr);
+            if (pass->layout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device->device(), pass->layout, nullptr);
+            if (pass->setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device->device(), pass->setLayout, nullptr);
+            *pass = ComputePass{};
+        }
         if (computeDescriptorPool != VK_NULL_HANDLE) { vkDestroyDescriptorPool(device->device(), computeDescriptorPool, nullptr); computeDescriptorPool = VK_NULL_HANDLE; }
         
         if (graphicsPipeline != VK_NULL_HANDLE) { vkDestroyPipeline(device->device(), graphicsPipeline, nullptr); graphicsPipeline = VK_NULL_HANDLE; }
@@ -483,13 +1032,17 @@ namespace AhnrealEngine {
         if (graphicsSet0Layout != VK_NULL_HANDLE) { vkDestroyDescriptorSetLayout(device->device(), graphicsSet0Layout, nullptr); graphicsSet0Layout = VK_NULL_HANDLE; }
         if (graphicsDescriptorPool != VK_NULL_HANDLE) { vkDestroyDescriptorPool(device->device(), graphicsDescriptorPool, nullptr); graphicsDescriptorPool = VK_NULL_HANDLE; }
 
-        if (instanceBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), instanceBuffer, nullptr); instanceBuffer = VK_NULL_HANDLE; }
-        if (instanceBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), instanceBufferMemory, nullptr); instanceBufferMemory = VK_NULL_HANDLE; }
+        if (device) {
+            destroyInstanceBuffers();
+            destroyBvhBuffers();
+        }
         if (cameraBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), cameraBuffer, nullptr); cameraBuffer = VK_NULL_HANDLE; }
         if (cameraBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), cameraBufferMemory, nullptr); cameraBufferMemory = VK_NULL_HANDLE; }
         if (indirectDrawBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), indirectDrawBuffer, nullptr); indirectDrawBuffer = VK_NULL_HANDLE; }
         if (indirectDrawBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), indirectDrawBufferMemory, nullptr); indirectDrawBufferMemory = VK_NULL_HANDLE; }
-        if (visibleInstanceBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), visibleInstanceBuffer, nullptr); visibleInstanceBuffer = VK_NULL_HANDLE; }
-        if (visibleInstanceBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), visibleInstanceBufferMemory, nullptr); visibleInstanceBufferMemory = VK_NULL_HANDLE; }
+
+        cubeModel.reset();
+        graphicsDescriptorSets.clear();
+        instancesDirty = true;
     }
 }
@@ -1,21 +1,25 @@
 #pragma once
 
 #include "../../Engine/Scene/Scene.h"
+#include "../../Engine/Scene/FramePacket.h"
 #include "../../Engine/Core/Camera.h"
 #include "../../Engine/Renderer/Model.h"
+#include "../../Engine/Renderer/BindlessHeap.h"
+#include "../../Engine/Renderer/InstanceStreams.h"
+#include "../../Engine/Renderer/GpuPrimitives.h"
+#include "../../Engine/Scene/BoundingVolumeHierarchy.h"
+#include "../../Engine/Core/JobSystem.h"
+#include <string>
 #include <vector>
 #include <memory>
 #include <glm/glm.hpp>
 
 namespace AhnrealEngine {
 
-    struct InstanceData {
-        glm::mat4 model;
-    };
-
     struct CameraData {
         glm::mat4 view;
         glm::mat4 proj;
+        glm::mat4 viewProj;
         glm::vec4 frustumPlanes[6];
     };
 
@@ -28,6 +32,50 @@ namespace AhnrealEngine {
         uint32_t    firstInstance;
     };
 
+    // Push constants of instance_bindless.vert: heap slots of the draw's buffers
+    struct BindlessDrawIndices {
+        BindlessIndex cameraIndex;
+        BindlessIndex positionScaleIndex;
+        BindlessIndex rotationIndex;
+        BindlessIndex visibleIndex;
+    };
+
+    // Push constants of instance_generate.comp
+    struct InstanceGenerateParams {
+        uint32_t instanceCount;
+        uint32_t seed;
+        float spread;
+        float meshRadius;
+    };
+
+    // Push constants of cull_bvh_traverse.comp
+    struct BvhTraverseParams {
+        uint32_t subtreeCount;
+        uint32_t nodeCount;
+        uint32_t leafCount;
+    };
+
+    // Push constants of cull_depth_keys.comp
+    struct DepthKeyParams {
+        uint32_t bucketed;
+        float farPlane;
+    };
+
+    // Contents of indirectDrawBuffer. cull_scan writes the visible count into
+    // the draw and sizes the depth key dispatch by it.
+    struct CullIndirectCommands {
+        VkDrawIndexedIndirectCommand draw;
+        VkDispatchIndirectCommand depthKeys;
+    };
+
+    // One compute dispatch: its pipeline and the single descriptor set it uses
+    struct ComputePass {
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+        VkDescriptorSet set = VK_NULL_HANDLE;
+    };
+
     class InstancingScene : public Scene {
     public:
         InstancingScene();
@@ -35,18 +83,51 @@ namespace AhnrealEngine {
 
         void initialize() override; // Pure virtual implementation
         void initialize(VulkanRenderer* renderer) override;
-        void preRender(VulkanRenderer* renderer) override;
-        void update(float deltaTime) override;
-        void render(VulkanRenderer* renderer) override;
         void onImGuiRender() override;
 
+        // Camera movement runs on a worker; recording reads the packet's camera
+        bool supportsPipelinedUpdate() const override { return true; }
+        bool supportsFixedTimestep() const override { return true; }
+        void update(float deltaTime, FramePacket& packet) override;
+        void preRender(VulkanRenderer* renderer, const FramePacket& packet) override;
+        void render(VulkanRenderer* renderer, const FramePacket& packet) override;
+
+        // Mesh import and buffer allocation run in prepare()
+        bool supportsPreload() const override { return true; }
+        void prepare(VulkanRenderer* renderer, LoadProgress& progress) override;
+
+        // Instance, sort and BVH buffers grow after initialize()
+        uint64_t getDeviceFootprint() const override;
+
     private:
         void cleanup();
         void createBuffers();
+        void createInstanceBuffers(uint32_t capacity);
+        void destroyInstanceBuffers();
+        void resizeInstances(uint32_t count);
+        void writeInstanceDescriptors();
+        void recordInstanceGeneration(VkCommandBuffer commandBuffer);
+        void registerBindlessBuffers();
         void createComputePipeline();
+        void createComputePass(ComputePass& pass, const std::string& shaderFile,
+                               const std::vector<VkDescriptorType>& bindings, uint32_t pushConstantSize);
+        void recordCulling(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, float farPlane);
+        // Reorders the visible list front to back (see cull_depth_keys.comp)
+        void recordDepthSort(VkCommandBuffer commandBuffer, DescriptorAllocator& descriptors, float farPlane);
+        void createSortBuffers();
+        void destroySortBuffers();
+        void readOverdrawStats(uint32_t frameIndex);
+        // BVH culling: the tree is built by a job from a CPU replay of
+        // instance_generate.comp, then uploaded once the job is done
+        static float getSpread(uint32_t count);
+        void updateBvh();
+        void startBvhBuild();
+        void buildBvh(uint32_t count, uint32_t seed, float radius);
+        void uploadBvh();
+        void destroyBvhBuffers();
         void createGraphicsPipeline(VulkanRenderer* renderer);
-        void createDescriptorSets();
-        void updateCameraBuffer();
+        void createGraphicsDescriptorSets();
+        void updateCameraBuffer(const FrameCamera& frameCamera);
 
         VulkanDevice* device = nullptr;
         Camera camera;
@@ -57,8 +138,20 @@ namespace AhnrealEngine {
         std::unique_ptr<Model> cubeModel; // We will use this to get vertex/index data
 
         // Buffers
-        static const uint32_t INSTANCE_COUNT = 10000;
-        
+        static constexpr uint32_t DEFAULT_INSTANCE_COUNT = 10000;
+        static constexpr uint32_t MAX_INSTANCE_COUNT = 4u << 20;
+
+        // Instances are generated on the GPU by instance_generate.comp. The
+        // count can change at runtime; buffers only grow (see resizeInstances).
+        uint32_t instanceCount = DEFAULT_INSTANCE_COUNT;
+        uint32_t requestedInstanceCount = DEFAULT_INSTANCE_COUNT;
+        uint32_t generationSeed = 1;
+        bool instancesDirty = true;
+        float meshRadius = 0.866f;
+
+        // All instance streams share instanceBuffer at these offsets; the
+        // layout's capacity is the allocated instance count
+        InstanceStreamLayout instanceLayout;
         VkBuffer instanceBuffer = VK_NULL_HANDLE;
         VkDeviceMemory instanceBufferMemory = VK_NULL_HANDLE;
 
@@ -72,12 +165,75 @@ namespace AhnrealEngine {
         VkBuffer visibleInstanceBuffer = VK_NULL_HANDLE;
         VkDeviceMemory visibleInstanceBufferMemory = VK_NULL_HANDLE;
 
-        // Pipelines
-        VkPipeline computePipeline = VK_NULL_HANDLE;
-        VkPipelineLayout computePipelineLayout = VK_NULL_HANDLE;
-        VkDescriptorSetLayout computeDescriptorSetLayout = VK_NULL_HANDLE;
+        // Culling scratch, one entry per 256-instance workgroup: the visible
+        // count (turned into an output offset by the scan) and a 256-bit mask
+        VkBuffer groupCountBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory groupCountBufferMemory = VK_NULL_HANDLE;
+        VkBuffer visibilityMaskBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory visibilityMaskBufferMemory = VK_NULL_HANDLE;
+
+        // Instance BVH. bvhLayout and the build stats are written by the
+        // build job and only read once bvhBuildCounter is done.
+        static constexpr uint32_t BVH_LEAF_SIZE = 16;
+        static constexpr uint32_t BVH_SUBTREE_LEAVES = 64; // Per cull_bvh_traverse.comp invocation
+        bool bvhCulling = true;
+        bool bvhReady = false; // Uploaded tree matches the current instances
+        std::unique_ptr<JobCounter> bvhBuildCounter;
+        BvhGpuLayout bvhLayout;
+        uint32_t bvhBuildCount = 0; // Instances and seed the last build covered
+        uint32_t bvhBuildSeed = 0;
+        float bvhBuildMs = 0.0f;
+        float bvhSahCost = 0.0f;
+        BvhTraverseParams bvhParams{}; // Of the uploaded tree
+
+        VkBuffer bvhNodeBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory bvhNodeBufferMemory = VK_NULL_HANDLE;
+        VkBuffer bvhSubtreeBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory bvhSubtreeBufferMemory = VK_NULL_HANDLE;
+        VkBuffer bvhInstanceLeafBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory bvhInstanceLeafBufferMemory = VK_NULL_HANDLE;
+        VkBuffer bvhLeafStateBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory bvhLeafStateBufferMemory = VK_NULL_HANDLE;
+
+        // Depth sorting of the visible list, so opaque instances draw front
+        // to back and early depth testing rejects the ones behind. Buckets
+        // sort 16-bit quantized depth in two radix passes, Full sorts the
+        // float depth in four.
+        enum class DepthSortMode : int { Off, Buckets, Full };
+        DepthSortMode depthSortMode = DepthSortMode::Buckets;
+        std::unique_ptr<GpuPrimitives> primitives;
+        uint32_t sortCapacity = 0; // Instances the sort buffers hold
+        VkBuffer depthKeyBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory depthKeyBufferMemory = VK_NULL_HANDLE;
+        VkBuffer sortScratchBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory sortScratchBufferMemory = VK_NULL_HANDLE;
+
+        // Fragment shader invocations of the instanced draw, one query per
+        // frame in flight, read back when the slot comes around again. The
+        // latest count is kept per sort mode to show the overdraw saved.
+        struct StatisticsQuery {
+            bool written = false;
+            DepthSortMode sortMode = DepthSortMode::Off; // Order of that frame's draw
+        };
+        VkQueryPool statisticsQueryPool = VK_NULL_HANDLE;
+        std::vector<StatisticsQuery> statisticsQueries;
+        DepthSortMode appliedSortMode = DepthSortMode::Off; // Of the current visible list
+        uint64_t fragmentInvocations[3] = {}; // Latest, by DepthSortMode
+        bool hasFragmentInvocations[3] = {};
+        uint32_t framePixels = 0;
+
+        // Pipelines. Culling runs as cull -> scan -> compact (see cull.comp),
+        // or bvh traverse -> cull_bvh -> scan -> compact once the BVH is ready,
+        // then optionally depth keys -> radix sort.
+        ComputePass generatePass;
+        ComputePass cullPass;
+        ComputePass bvhTraversePass;
+        ComputePass bvhCullPass;
+        ComputePass scanPass;
+        ComputePass compactPass;
+        ComputePass depthKeyPass;
         VkDescriptorPool computeDescriptorPool = VK_NULL_HANDLE;
-        VkDescriptorSet computeDescriptorSet = VK_NULL_HANDLE;
+        bool subgroupScan = false; // cull_scan_subgroup.comp instead of cull_scan.comp
 
         VkPipeline graphicsPipeline = VK_NULL_HANDLE;
         VkPipelineLayout graphicsPipelineLayout = VK_NULL_HANDLE;
@@ -86,6 +242,11 @@ namespace AhnrealEngine {
         VkDescriptorPool graphicsDescriptorPool = VK_NULL_HANDLE;
         std::vector<VkDescriptorSet> graphicsDescriptorSets; // Set 0 (Cam), Set 1 (Inst)
 
+        // Bindless path: buffers are registered in the renderer's heap and the
+        // draw selects them through push constants instead of per-scene sets
+        BindlessHeap* bindlessHeap = nullptr;
+        BindlessDrawIndices bindlessIndices{INVALID_BINDLESS_INDEX, INVALID_BINDLESS_INDEX, INVALID_BINDLESS_INDEX, INVALID_BINDLESS_INDEX};
+
         // Sync
         // We might need a fence if we do async compute, but here we serialize in one command buffer
         
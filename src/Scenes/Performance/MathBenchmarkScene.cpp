@@ -0,0 +1,244 @@
+#include "MathBenchmarkScene.h"
+#include <imgui.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace AhnrealEngine {
+
+    static const char* const KERNEL_NAMES[] = { "Matrix multiply", "Compose TRS", "Sphere vs frustum", "Box vs frustum" };
+
+    MathBenchmarkScene::MathBenchmarkScene() : Scene("SIMD Math Benchmark") {}
+
+    MathBenchmarkScene::~MathBenchmarkScene() {
+        cleanup();
+    }
+
+    void MathBenchmarkScene::initialize() {
+        if (matricesA.empty()) {
+            generateData();
+        }
+    }
+
+    void MathBenchmarkScene::cleanup() {
+        for (auto* matrices : {&matricesA, &matricesB, &glmMatrices, &kernelMatrices}) {
+            matrices->clear();
+            matrices->shrink_to_fit();
+        }
+        for (auto* stream : {&positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scales}) {
+            stream->clear();
+            stream->shrink_to_fit();
+        }
+        positions.clear();
+        positions.shrink_to_fit();
+        rotations.clear();
+        rotations.shrink_to_fit();
+        spheres.clear();
+        spheres.shrink_to_fit();
+        glmVisible.clear();
+        glmVisible.shrink_to_fit();
+        kernelVisible.clear();
+        kernelVisible.shrink_to_fit();
+    }
+
+    void MathBenchmarkScene::generateData() {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> scale(0.25f, 2.0f);
+
+        matricesA.resize(ELEMENT_COUNT);
+        matricesB.resize(ELEMENT_COUNT);
+        positions.resize(ELEMENT_COUNT);
+        rotations.resize(ELEMENT_COUNT);
+        spheres.resize(ELEMENT_COUNT);
+        for (auto* stream : {&positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scales}) {
+            stream->resize(ELEMENT_COUNT);
+        }
+        glmMatrices.resize(ELEMENT_COUNT);
+        kernelMatrices.resize(ELEMENT_COUNT);
+        glmVisible.resize(ELEMENT_COUNT);
+        kernelVisible.resize(ELEMENT_COUNT);
+
+        for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+            for (int c = 0; c < 4; c++) {
+                matricesA[i][c] = glm::vec4(unit(rng), unit(rng), unit(rng), unit(rng));
+                matricesB[i][c] = glm::vec4(unit(rng), unit(rng), unit(rng), unit(rng));
+            }
+
+            // Spread around the frustum so roughly half of the tests pass
+            glm::vec3 position(unit(rng) * 60.0f, unit(rng) * 40.0f, unit(rng) * 60.0f);
+            glm::vec4 rotation(unit(rng), unit(rng), unit(rng), unit(rng));
+            rotation = glm::length(rotation) > 0.0f ? glm::normalize(rotation) : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            float s = scale(rng);
+
+            positions[i] = position;
+            rotations[i] = rotation;
+            spheres[i] = glm::vec4(position, s);
+            positionX[i] = position.x;
+            positionY[i] = position.y;
+            positionZ[i] = position.z;
+            rotationX[i] = rotation.x;
+            rotationY[i] = rotation.y;
+            rotationZ[i] = rotation.z;
+            rotationW[i] = rotation.w;
+            scales[i] = s;
+        }
+
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+        frustum = Frustum::fromViewProjection(proj * view);
+    }
+
+    double MathBenchmarkScene::timeGlm(Kernel kernel) {
+        double best = 1e30;
+        for (int r = 0; r < REPETITIONS; r++) {
+            auto start = std::chrono::steady_clock::now();
+            switch (kernel) {
+                case MultiplyMatrices:
+                    for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+                        glmMatrices[i] = matricesA[i] * matricesB[i];
+                    }
+                    break;
+                case ComposeTransforms:
+                    for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+                        const glm::vec4& q = rotations[i];
+                        glmMatrices[i] = glm::translate(glm::mat4(1.0f), positions[i]) *
+                                         glm::mat4_cast(glm::quat(q.w, q.x, q.y, q.z)) *
+                                         glm::scale(glm::mat4(1.0f), glm::vec3(scales[i]));
+                    }
+                    break;
+                case TestSpheres:
+                    for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+                        glmVisible[i] = frustum.intersectsSphere(positions[i], scales[i]) ? 1 : 0;
+                    }
+                    break;
+                case TestBoxes:
+                    for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+                        glm::vec3 extent(scales[i]);
+                        glmVisible[i] = frustum.intersectsBox(positions[i] - extent, positions[i] + extent) ? 1 : 0;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    }
+
+    double MathBenchmarkScene::timeKernel(Kernel kernel) {
+        MathKernels::TransformStreams transforms{positionX.data(), positionY.data(), positionZ.data(),
+                                                 rotationX.data(), rotationY.data(), rotationZ.data(), rotationW.data(),
+                                                 scales.data()};
+        MathKernels::SphereStreams sphereStreams{positionX.data(), positionY.data(), positionZ.data(), scales.data()};
+        MathKernels::BoxStreams boxStreams{positionX.data(), positionY.data(), positionZ.data(),
+                                           scales.data(), scales.data(), scales.data()};
+
+        double best = 1e30;
+        for (int r = 0; r < REPETITIONS; r++) {
+            auto start = std::chrono::steady_clock::now();
+            switch (kernel) {
+                case MultiplyMatrices:
+                    MathKernels::multiplyMatrices(matricesA.data(), matricesB.data(), kernelMatrices.data(), ELEMENT_COUNT);
+                    break;
+                case ComposeTransforms:
+                    MathKernels::composeTransforms(transforms, ELEMENT_COUNT, kernelMatrices.data());
+                    break;
+                case TestSpheres:
+                    MathKernels::testSpheres(frustum.planes, sphereStreams, ELEMENT_COUNT, kernelVisible.data());
+                    break;
+                case TestBoxes:
+                    MathKernels::testBoxes(frustum.planes, boxStreams, ELEMENT_COUNT, kernelVisible.data());
+                    break;
+                default:
+                    break;
+            }
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    }
+
+    uint32_t MathBenchmarkScene::verify(Kernel kernel) {
+        uint32_t count = 0;
+        if (kernel == MultiplyMatrices || kernel == ComposeTransforms) {
+            // FMA and a different summation order change the last bits
+            for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+                for (int c = 0; c < 4; c++) {
+                    glm::vec4 difference = glm::abs(glmMatrices[i][c] - kernelMatrices[i][c]);
+                    if (std::max({difference.x, difference.y, difference.z, difference.w}) > 1e-4f) {
+                        count++;
+                        break;
+                    }
+                }
+            }
+        } else {
+            for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+                if (glmVisible[i] != kernelVisible[i]) count++;
+            }
+        }
+        return count;
+    }
+
+    void MathBenchmarkScene::runBenchmarks() {
+        const MathKernels::SimdLevel previous = MathKernels::getSimdLevel();
+        const int supported = static_cast<int>(MathKernels::detectSimdLevel());
+
+        for (int k = 0; k < KernelCount; k++) {
+            Kernel kernel = static_cast<Kernel>(k);
+            glmTimes[k] = timeGlm(kernel);
+            for (int level = 0; level < LEVEL_COUNT; level++) {
+                if (level > supported) {
+                    kernelTimes[k][level] = 0.0;
+                    mismatches[k][level] = 0;
+                    continue;
+                }
+                MathKernels::setSimdLevel(static_cast<MathKernels::SimdLevel>(level));
+                kernelTimes[k][level] = timeKernel(kernel);
+                mismatches[k][level] = verify(kernel);
+            }
+        }
+
+        MathKernels::setSimdLevel(previous);
+        hasResults = true;
+    }
+
+    void MathBenchmarkScene::onImGuiRender() {
+        ImGui::Begin("SIMD Math Benchmark");
+        ImGui::Text("CPU Level: %s", MathKernels::getSimdLevelName(MathKernels::detectSimdLevel()));
+        ImGui::Text("Batch Size: %u (best of %d)", ELEMENT_COUNT, REPETITIONS);
+
+        int level = static_cast<int>(MathKernels::getSimdLevel());
+        const char* levelNames[LEVEL_COUNT];
+        for (int i = 0; i < LEVEL_COUNT; i++) {
+            levelNames[i] = MathKernels::getSimdLevelName(static_cast<MathKernels::SimdLevel>(i));
+        }
+        // Process-wide: every MathKernels caller uses it
+        if (ImGui::Combo("Active Level", &level, levelNames, LEVEL_COUNT)) {
+            MathKernels::setSimdLevel(static_cast<MathKernels::SimdLevel>(level));
+        }
+
+        if (ImGui::Button("Run")) {
+            runBenchmarks();
+        }
+
+        if (hasResults) {
+            const int supported = static_cast<int>(MathKernels::detectSimdLevel());
+            ImGui::Separator();
+            for (int k = 0; k < KernelCount; k++) {
+                ImGui::Text("%s", KERNEL_NAMES[k]);
+                ImGui::Text("  glm loop: %.3f ms", glmTimes[k]);
+                for (int l = 0; l <= supported; l++) {
+                    double speedup = kernelTimes[k][l] > 0.0 ? glmTimes[k] / kernelTimes[k][l] : 0.0;
+                    ImGui::Text("  %-7s %.3f ms (%.2fx)%s", levelNames[l], kernelTimes[k][l], speedup,
+                                mismatches[k][l] ? " MISMATCH" : "");
+                }
+            }
+        }
+        ImGui::End();
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../../Engine/Scene/Scene.h"
+#include "../../Engine/Core/Frustum.h"
+#include "../../Engine/Core/MathKernels.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace AhnrealEngine {
+
+    // Times each MathKernels batch against the equivalent per-element glm
+    // loop on the same data, at every SIMD level the CPU supports. Nothing is
+    // drawn; results are shown in the stats window after "Run".
+    class MathBenchmarkScene : public Scene {
+    public:
+        MathBenchmarkScene();
+        ~MathBenchmarkScene() override;
+
+        void initialize() override;
+        void cleanup() override;
+        void onImGuiRender() override;
+        bool needsContinuousRedraw() const override { return false; }
+
+    private:
+        enum Kernel { MultiplyMatrices, ComposeTransforms, TestSpheres, TestBoxes, KernelCount };
+        static constexpr int LEVEL_COUNT = 3; // MathKernels::SimdLevel values
+
+        void generateData();
+        void runBenchmarks();
+        double timeGlm(Kernel kernel);
+        double timeKernel(Kernel kernel);
+        // Counts mismatches between the glm and kernel results of a kernel
+        uint32_t verify(Kernel kernel);
+
+        static constexpr uint32_t ELEMENT_COUNT = 1u << 16;
+        static constexpr int REPETITIONS = 20; // Best of, per measurement
+
+        Frustum frustum{};
+
+        // Inputs: AoS for glm, SoA streams for the kernels
+        std::vector<glm::mat4> matricesA, matricesB;
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec4> rotations; // Quaternion (x, y, z, w)
+        std::vector<float> positionX, positionY, positionZ;
+        std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+        std::vector<float> scales;        // Also sphere radii and box extents
+        std::vector<glm::vec4> spheres;   // (center, radius)
+
+        std::vector<glm::mat4> glmMatrices, kernelMatrices;
+        std::vector<uint8_t> glmVisible, kernelVisible;
+
+        // Milliseconds per batch, kernels indexed by SimdLevel; levels the CPU
+        // lacks are left at 0
+        double glmTimes[KernelCount] = {};
+        double kernelTimes[KernelCount][LEVEL_COUNT] = {};
+        uint32_t mismatches[KernelCount][LEVEL_COUNT] = {};
+        bool hasResults = false;
+    };
+}
@@ -0,0 +1,578 @@
+#include "MeshletScene.h"
+#include "../../Engine/Renderer/VulkanRenderer.h"
+#include "../../Engine/Renderer/VulkanDevice.h"
+#include "../../Engine/Renderer/Meshlet.h"
+#include "../../Engine/Core/Input.h"
+#include "../../Engine/Core/Frustum.h"
+#include <imgui.h>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace AhnrealEngine {
+
+    static std::vector<char> readShaderFile(const std::string& filename) {
+        std::vector<std::string> paths = {
+            "build/Debug/" + filename,
+            "../shaders/" + filename,
+            "../../shaders/" + filename,
+            "shaders/" + filename,
+            filename
+        };
+
+        for (const auto& path : paths) {
+            std::ifstream file(path, std::ios::ate | std::ios::binary);
+            if (file.is_open()) {
+                size_t fileSize = (size_t)file.tellg();
+                std::vector<char> buffer(fileSize);
+                file.seekg(0);
+                file.read(buffer.data(), fileSize);
+                return buffer;
+            }
+        }
+        throw std::runtime_error("Failed to find/open shader file: " + filename);
+    }
+
+    static VkShaderModule createShaderModule(VkDevice device, const std::string& filename) {
+        auto code = readShaderFile(filename);
+        VkShaderModuleCreateInfo createInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, nullptr, 0, code.size(), reinterpret_cast<const uint32_t*>(code.data())};
+        VkShaderModule module;
+        if (vkCreateShaderModule(device, &createInfo, nullptr, &module) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shader module!");
+        }
+        return module;
+    }
+
+    MeshletScene::MeshletScene()
+        : Scene("Meshlet Culling"), camera(glm::vec3(0.0f, 8.0f, 40.0f)) {
+        camera.setFar(500.0f);
+    }
+
+    MeshletScene::~MeshletScene() {
+        cleanup();
+    }
+
+    void MeshletScene::initialize() {
+        // Required by base class but we use initialize(renderer)
+    }
+
+    void MeshletScene::prepare(VulkanRenderer* renderer, LoadProgress& progress) {
+        device = renderer->getDevice();
+
+        createMesh();
+        progress.set(0.7f);
+
+        createBuffers();
+        progress.set(0.9f);
+    }
+
+    void MeshletScene::initialize(VulkanRenderer* renderer) {
+        device = renderer->getDevice();
+
+        // Already done when the scene was preloaded
+        if (!mesh) {
+            LoadProgress progress;
+            prepare(renderer, progress);
+        }
+
+        if (renderPath == MeshletRenderPath::MeshShader && !device->capabilities().meshShader) {
+            renderPath = MeshletRenderPath::ComputeCull;
+        }
+        // The culled draws carry their instance in firstInstance
+        if ((renderPath == MeshletRenderPath::ComputeCull || renderPath == MeshletRenderPath::TriangleFilter) &&
+            !device->capabilities().drawIndirectFirstInstance) {
+            renderPath = MeshletRenderPath::NoCulling;
+        }
+
+        createDescriptors();
+        createComputePipelines();
+        createGraphicsPipelines(renderer);
+    }
+
+    void MeshletScene::createMesh() {
+        // UV sphere. The repo's sample models are far too coarse for cluster
+        // culling to matter, so the dense mesh is generated here.
+        std::vector<Vertex> vertices;
+        vertices.reserve((SPHERE_RINGS + 1) * (SPHERE_SEGMENTS + 1));
+        for (uint32_t r = 0; r <= SPHERE_RINGS; r++) {
+            float theta = glm::pi<float>() * r / SPHERE_RINGS;
+            for (uint32_t s = 0; s <= SPHERE_SEGMENTS; s++) {
+                float phi = 2.0f * glm::pi<float>() * s / SPHERE_SEGMENTS;
+                Vertex vertex{};
+                vertex.position = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+                vertex.normal = vertex.position;
+                vertex.texCoord = glm::vec2(static_cast<float>(s) / SPHERE_SEGMENTS, static_cast<float>(r) / SPHERE_RINGS);
+                vertex.tangent = glm::vec3(-std::sin(phi), 0.0f, std::cos(phi));
+                vertex.bitangent = glm::cross(vertex.normal, vertex.tangent);
+                vertices.push_back(vertex);
+            }
+        }
+
+        // Indices are emitted in 7x7-quad tiles (8x8 = 64 vertices) so the
+        // greedy meshlet builder closes each meshlet on a compact patch
+        // instead of a long strip along a ring
+        constexpr uint32_t TILE = 7;
+        const uint32_t rowStride = SPHERE_SEGMENTS + 1;
+        std::vector<uint32_t> indices;
+        for (uint32_t tileR = 0; tileR < SPHERE_RINGS; tileR += TILE) {
+            for (uint32_t tileS = 0; tileS < SPHERE_SEGMENTS; tileS += TILE) {
+                for (uint32_t r = tileR; r < std::min(tileR + TILE, SPHERE_RINGS); r++) {
+                    for (uint32_t s = tileS; s < std::min(tileS + TILE, SPHERE_SEGMENTS); s++) {
+                        uint32_t a = r * rowStride + s;
+                        uint32_t b = a + rowStride;
+                        uint32_t c = b + 1;
+                        uint32_t d = a + 1;
+                        // Counter-clockwise seen from outside; the pole rows
+                        // each lose their degenerate triangle
+                        if (r != 0) indices.insert(indices.end(), {a, b, d});
+                        if (r != SPHERE_RINGS - 1) indices.insert(indices.end(), {d, b, c});
+                    }
+                }
+            }
+        }
+
+        mesh = std::make_unique<Mesh>(device, vertices, indices, true);
+    }
+
+    void MeshletScene::createBuffers() {
+        // Instance grid on the XZ plane, translation and uniform scale only
+        std::vector<glm::vec4> instances;
+        instances.reserve(INSTANCE_COUNT);
+        const float spacing = 3.0f;
+        const float half = (GRID_SIZE - 1) * spacing * 0.5f;
+        for (uint32_t z = 0; z < GRID_SIZE; z++) {
+            for (uint32_t x = 0; x < GRID_SIZE; x++) {
+                instances.emplace_back(x * spacing - half, 0.0f, z * spacing - half, 1.0f);
+            }
+        }
+
+        VkDeviceSize instanceSize = sizeof(glm::vec4) * instances.size();
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        device->createBuffer(instanceSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer, stagingBufferMemory);
+        void* data;
+        vkMapMemory(device->device(), stagingBufferMemory, 0, instanceSize, 0, &data);
+        memcpy(data, instances.data(), static_cast<size_t>(instanceSize));
+        vkUnmapMemory(device->device(), stagingBufferMemory);
+
+        device->createBuffer(instanceSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, instanceBuffer, instanceBufferMemory);
+        device->copyBuffer(stagingBuffer, instanceBuffer, instanceSize);
+        vkDestroyBuffer(device->device(), stagingBuffer, nullptr);
+        vkFreeMemory(device->device(), stagingBufferMemory, nullptr);
+
+        device->createBuffer(sizeof(MeshletCameraData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            cameraBuffer, cameraBufferMemory);
+        vkMapMemory(device->device(), cameraBufferMemory, 0, sizeof(MeshletCameraData), 0, &cameraBufferMapped);
+
+        // Written by meshlet_cull.comp every frame
+        uint32_t maxDraws = mesh->getMeshlets()->getMeshletCount() * INSTANCE_COUNT;
+        device->createBuffer(sizeof(VkDrawIndexedIndirectCommand) * maxDraws,
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, drawCommandBuffer, drawCommandBufferMemory);
+        device->createBuffer(sizeof(uint32_t) * 2,
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, drawCountBuffer, drawCountBufferMemory);
+
+        // Static meshlet indices up front, triangle_cull.comp output after them
+        VkDeviceSize staticIndexSize = sizeof(uint32_t) * 3 * mesh->getMeshlets()->getTriangleCount();
+        device->createBuffer(staticIndexSize + sizeof(uint32_t) * 3 * FILTERED_TRIANGLE_CAPACITY,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, filteredIndexBuffer, filteredIndexBufferMemory);
+        device->copyBuffer(mesh->getMeshlets()->getIndexBuffer(), filteredIndexBuffer, staticIndexSize);
+    }
+
+    void MeshletScene::createDescriptors() {
+        const MeshletBuffers* meshlets = mesh->getMeshlets();
+        const bool meshShader = device->capabilities().meshShader;
+
+        VkDescriptorPoolSize poolSizes[] = {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3 },  // Camera in every set
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 21 }  // Cull 5, Graphics 7, Filter 9
+        };
+        VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, nullptr, 0, 3, 2, poolSizes};
+        vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &descriptorPool);
+
+        // Cull: [0: Camera(U), 1: Instances, 2: Meshlets, 3: Bounds, 4: DrawCommands, 5: DrawCount]
+        VkDescriptorSetLayoutBinding cullBindings[6];
+        for (uint32_t i = 0; i < 6; i++) {
+            cullBindings[i] = {i, i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr};
+        }
+        VkDescriptorSetLayoutCreateInfo cullLayoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 6, cullBindings};
+        vkCreateDescriptorSetLayout(device->device(), &cullLayoutInfo, nullptr, &cullSetLayout);
+
+        // Graphics: [0: Camera(U), 1: Instances, 2: Meshlets, 3: Bounds,
+        //            4: Vertices, 5: MeshletVertices, 6: MeshletTriangles, 7: Attributes]
+        // The vertex path reads 0-1; the rest is for the task and mesh stages
+        VkShaderStageFlags graphicsStages = VK_SHADER_STAGE_VERTEX_BIT;
+        if (meshShader) graphicsStages |= VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT;
+        VkDescriptorSetLayoutBinding graphicsBindings[8];
+        for (uint32_t i = 0; i < 8; i++) {
+            graphicsBindings[i] = {i, i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, graphicsStages, nullptr};
+        }
+        VkDescriptorSetLayoutCreateInfo graphicsLayoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 8, graphicsBindings};
+        vkCreateDescriptorSetLayout(device->device(), &graphicsLayoutInfo, nullptr, &graphicsSetLayout);
+
+        // Filter: [0: Camera(U), 1: Instances, 2: Meshlets, 3: Bounds, 4: Vertices,
+        //          5: MeshletVertices, 6: MeshletTriangles, 7: OutputIndices,
+        //          8: DrawCommands, 9: Counters]
+        VkDescriptorSetLayoutBinding filterBindings[10];
+        for (uint32_t i = 0; i < 10; i++) {
+            filterBindings[i] = {i, i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr};
+        }
+        VkDescriptorSetLayoutCreateInfo filterLayoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 10, filterBindings};
+        vkCreateDescriptorSetLayout(device->device(), &filterLayoutInfo, nullptr, &filterSetLayout);
+
+        VkDescriptorSetLayout layouts[] = { cullSetLayout, graphicsSetLayout, filterSetLayout };
+        VkDescriptorSet sets[3];
+        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr, descriptorPool, 3, layouts};
+        if (vkAllocateDescriptorSets(device->device(), &allocInfo, sets) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate meshlet descriptor sets!");
+        }
+        cullSet = sets[0];
+        graphicsSet = sets[1];
+        filterSet = sets[2];
+
+        VkDescriptorBufferInfo camInfo{ cameraBuffer, 0, sizeof(MeshletCameraData) };
+        VkDescriptorBufferInfo instanceInfo{ instanceBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo meshletInfo{ meshlets->getMeshletBuffer(), 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo boundsInfo{ meshlets->getBoundsBuffer(), 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo drawInfo{ drawCommandBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo countInfo{ drawCountBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo vertexInfo{ mesh->getPositionBuffer(), 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo attributeInfo{ mesh->getAttributeBuffer(), 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo vertexIndexInfo{ meshlets->getVertexIndexBuffer(), 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo triangleInfo{ meshlets->getTriangleBuffer(), 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo filteredIndexInfo{ filteredIndexBuffer, 0, VK_WHOLE_SIZE };
+
+        const VkDescriptorBufferInfo* cullInfos[] = { &camInfo, &instanceInfo, &meshletInfo, &boundsInfo, &drawInfo, &countInfo };
+        const VkDescriptorBufferInfo* graphicsInfos[] = { &camInfo, &instanceInfo, &meshletInfo, &boundsInfo, &vertexInfo, &vertexIndexInfo, &triangleInfo, &attributeInfo };
+        const VkDescriptorBufferInfo* filterInfos[] = { &camInfo, &instanceInfo, &meshletInfo, &boundsInfo, &vertexInfo, &vertexIndexInfo, &triangleInfo, &filteredIndexInfo, &drawInfo, &countInfo };
+
+        std::vector<VkWriteDescriptorSet> writes;
+        for (uint32_t i = 0; i < 6; i++) {
+            writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, cullSet, i, 0, 1, cullBindings[i].descriptorType, nullptr, cullInfos[i], nullptr});
+        }
+        for (uint32_t i = 0; i < 8; i++) {
+            writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, graphicsSet, i, 0, 1, graphicsBindings[i].descriptorType, nullptr, graphicsInfos[i], nullptr});
+        }
+        for (uint32_t i = 0; i < 10; i++) {
+            writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, filterSet, i, 0, 1, filterBindings[i].descriptorType, nullptr, filterInfos[i], nullptr});
+        }
+        vkUpdateDescriptorSets(device->device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    void MeshletScene::createComputePipelines() {
+        VkPushConstantRange pushConstant{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MeshletCullParams)};
+        VkPipelineLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        layoutInfo.setLayoutCount = 1;
+        layoutInfo.pSetLayouts = &cullSetLayout;
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges = &pushConstant;
+        vkCreatePipelineLayout(device->device(), &layoutInfo, nullptr, &cullPipelineLayout);
+        cullPipeline = createComputePipeline("meshlet_cull.comp.spv", cullPipelineLayout);
+
+        pushConstant.size = sizeof(TriangleFilterParams);
+        layoutInfo.pSetLayouts = &filterSetLayout;
+        vkCreatePipelineLayout(device->device(), &layoutInfo, nullptr, &filterPipelineLayout);
+        filterPipeline = createComputePipeline("triangle_cull.comp.spv", filterPipelineLayout);
+    }
+
+    VkPipeline MeshletScene::createComputePipeline(const std::string& shaderFile, VkPipelineLayout layout) {
+        VkShaderModule computeModule = createShaderModule(device->device(), shaderFile);
+        VkComputePipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+        pipelineInfo.layout = layout;
+        pipelineInfo.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, computeModule, "main", nullptr};
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        vkCreateComputePipelines(device->device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        vkDestroyShaderModule(device->device(), computeModule, nullptr);
+        return pipeline;
+    }
+
+    void MeshletScene::createGraphicsPipelines(VulkanRenderer* renderer) {
+        const bool meshShader = device->capabilities().meshShader;
+
+        // meshlet.task reads the meshlet count
+        VkPushConstantRange pushConstant{VK_SHADER_STAGE_TASK_BIT_EXT, 0, sizeof(uint32_t)};
+        VkPipelineLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        layoutInfo.setLayoutCount = 1;
+        layoutInfo.pSetLayouts = &graphicsSetLayout;
+        layoutInfo.pushConstantRangeCount = meshShader ? 1 : 0;
+        layoutInfo.pPushConstantRanges = &pushConstant;
+        vkCreatePipelineLayout(device->device(), &layoutInfo, nullptr, &graphicsPipelineLayout);
+
+        auto bindDesc = Vertex::getBindingDescriptions();
+        auto attrDesc = Vertex::getAttributeDescriptions();
+        VkPipelineVertexInputStateCreateInfo vertInput{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO, nullptr, 0, static_cast<uint32_t>(bindDesc.size()), bindDesc.data(), static_cast<uint32_t>(attrDesc.size()), attrDesc.data()};
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO, nullptr, 0, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_FALSE};
+
+        VkPipelineViewportStateCreateInfo viewportState{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO, nullptr, 0, 1, nullptr, 1, nullptr};
+        VkPipelineRasterizationStateCreateInfo rasterizer{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO, nullptr, 0, VK_FALSE, VK_FALSE, VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_FALSE, 0, 0, 0, 1.0f};
+        VkPipelineMultisampleStateCreateInfo multisample{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO, nullptr, 0, VK_SAMPLE_COUNT_1_BIT, VK_FALSE};
+        VkPipelineDepthStencilStateCreateInfo depthStencil{VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO, nullptr, 0, VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS, VK_FALSE, VK_FALSE};
+
+        VkPipelineColorBlendAttachmentState blendAtt{VK_FALSE, VK_BLEND_FACTOR_ZERO, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ZERO, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, 0xF};
+        VkPipelineColorBlendStateCreateInfo blend{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO, nullptr, 0, VK_FALSE, VK_LOGIC_OP_COPY, 1, &blendAtt};
+
+        std::vector<VkDynamicState> dynamics = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicInfo{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO, nullptr, 0, static_cast<uint32_t>(dynamics.size()), dynamics.data()};
+
+        VkShaderModule fragModule = createShaderModule(device->device(), "instance.frag.spv");
+        VkShaderModule vertModule = createShaderModule(device->device(), "meshlet.vert.spv");
+
+        VkPipelineShaderStageCreateInfo vertexStages[] = {
+            {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertModule, "main", nullptr},
+            {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragModule, "main", nullptr}
+        };
+
+        VkGraphicsPipelineCreateInfo pipeInfo{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+        pipeInfo.stageCount = 2;
+        pipeInfo.pStages = vertexStages;
+        pipeInfo.pVertexInputState = &vertInput;
+        pipeInfo.pInputAssemblyState = &inputAssembly;
+        pipeInfo.pViewportState = &viewportState;
+        pipeInfo.pRasterizationState = &rasterizer;
+        pipeInfo.pMultisampleState = &multisample;
+        pipeInfo.pDepthStencilState = &depthStencil;
+        pipeInfo.pColorBlendState = &blend;
+        pipeInfo.pDynamicState = &dynamicInfo;
+        pipeInfo.layout = graphicsPipelineLayout;
+        pipeInfo.renderPass = renderer->getSwapChainRenderPass();
+        pipeInfo.subpass = 0;
+
+        vkCreateGraphicsPipelines(device->device(), VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &vertexPipeline);
+        vkDestroyShaderModule(device->device(), vertModule, nullptr);
+
+        if (meshShader) {
+            VkShaderModule taskModule = createShaderModule(device->device(), "meshlet.task.spv");
+            VkShaderModule meshModule = createShaderModule(device->device(), "meshlet.mesh.spv");
+            VkPipelineShaderStageCreateInfo meshStages[] = {
+                {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_TASK_BIT_EXT, taskModule, "main", nullptr},
+                {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_MESH_BIT_EXT, meshModule, "main", nullptr},
+                {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragModule, "main", nullptr}
+            };
+
+            // No vertex input or input assembly: the mesh stage emits primitives
+            pipeInfo.stageCount = 3;
+            pipeInfo.pStages = meshStages;
+            pipeInfo.pVertexInputState = nullptr;
+            pipeInfo.pInputAssemblyState = nullptr;
+
+            vkCreateGraphicsPipelines(device->device(), VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &meshPipeline);
+            vkDestroyShaderModule(device->device(), taskModule, nullptr);
+            vkDestroyShaderModule(device->device(), meshModule, nullptr);
+        }
+
+        vkDestroyShaderModule(device->device(), fragModule, nullptr);
+    }
+
+    void MeshletScene::update(float deltaTime, FramePacket& packet) {
+        if (Input::isMouseButtonPressed(GLFW_MOUSE_BUTTON_RIGHT)) {
+            glm::vec2 delta = Input::getMouseDelta();
+            camera.processMouseMovement(delta.x, delta.y);
+        }
+        float scroll = Input::getScrollDelta();
+        if (scroll != 0.0f) camera.processMouseScroll(scroll);
+
+        if (Input::isKeyPressed(GLFW_KEY_W)) camera.processKeyboard(CameraMovement::Forward, deltaTime);
+        if (Input::isKeyPressed(GLFW_KEY_S)) camera.processKeyboard(CameraMovement::Backward, deltaTime);
+        if (Input::isKeyPressed(GLFW_KEY_A)) camera.processKeyboard(CameraMovement::Left, deltaTime);
+        if (Input::isKeyPressed(GLFW_KEY_D)) camera.processKeyboard(CameraMovement::Right, deltaTime);
+
+        packet.camera = FrameCamera::capture(camera, packet.aspectRatio);
+    }
+
+    void MeshletScene::preRender(VulkanRenderer* renderer, const FramePacket& packet) {
+        updateCameraBuffer(packet.renderCamera());
+
+        if (renderPath == MeshletRenderPath::ComputeCull || renderPath == MeshletRenderPath::TriangleFilter) {
+            recordCulling(renderer->getCurrentCommandBuffer(), renderer->getSwapChainExtent());
+        }
+    }
+
+    void MeshletScene::recordCulling(VkCommandBuffer commandBuffer, VkExtent2D extent) {
+        const bool compact = device->capabilities().drawIndirectCount;
+        const bool filter = renderPath == MeshletRenderPath::TriangleFilter;
+        const uint32_t meshletCount = mesh->getMeshlets()->getMeshletCount();
+
+        // The previous frame may still be reading the draw commands and indices
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+        // The filter reserves output space with the triangle counter even
+        // without drawIndirectCount
+        if (compact || filter) {
+            vkCmdFillBuffer(commandBuffer, drawCountBuffer, 0, VK_WHOLE_SIZE, 0);
+
+            VkMemoryBarrier resetBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+            resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &resetBarrier, 0, nullptr, 0, nullptr);
+        }
+
+        if (filter) {
+            TriangleFilterParams params{};
+            params.meshletCount = meshletCount;
+            params.instanceCount = INSTANCE_COUNT;
+            params.compact = compact ? 1 : 0;
+            params.tests = triangleTests;
+            params.triangleCapacity = FILTERED_TRIANGLE_CAPACITY;
+            params.outputOffset = mesh->getMeshlets()->getTriangleCount() * 3;
+            params.viewportSize = glm::vec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
+
+            // One workgroup per (meshlet, instance) pair
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, filterPipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, filterPipelineLayout, 0, 1, &filterSet, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, filterPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(TriangleFilterParams), &params);
+            vkCmdDispatch(commandBuffer, meshletCount * INSTANCE_COUNT, 1, 1);
+        } else {
+            MeshletCullParams params{};
+            params.meshletCount = meshletCount;
+            params.instanceCount = INSTANCE_COUNT;
+            params.compact = compact ? 1 : 0;
+
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1, &cullSet, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MeshletCullParams), &params);
+            vkCmdDispatch(commandBuffer, (meshletCount * INSTANCE_COUNT + 63) / 64, 1, 1);
+        }
+
+        // Barrier: Compute -> Indirect / Index
+        VkMemoryBarrier drawBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &drawBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    void MeshletScene::render(VulkanRenderer* renderer, const FramePacket& packet) {
+        VkCommandBuffer commandBuffer = renderer->getCurrentCommandBuffer();
+        const MeshletBuffers* meshlets = mesh->getMeshlets();
+
+        if (renderPath == MeshletRenderPath::MeshShader) {
+            uint32_t meshletCount = meshlets->getMeshletCount();
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshPipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelineLayout, 0, 1, &graphicsSet, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, graphicsPipelineLayout, VK_SHADER_STAGE_TASK_BIT_EXT, 0, sizeof(uint32_t), &meshletCount);
+            // 32 meshlets per task workgroup, one row of workgroups per instance
+            device->cmdDrawMeshTasks(commandBuffer, (meshletCount + 31) / 32, INSTANCE_COUNT, 1);
+            return;
+        }
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vertexPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipelineLayout, 0, 1, &graphicsSet, 0, nullptr);
+
+        if (renderPath == MeshletRenderPath::NoCulling) {
+            mesh->bind(commandBuffer);
+            mesh->drawInstanced(commandBuffer, INSTANCE_COUNT, 0);
+            return;
+        }
+
+        // Vertex streams only; the culled index buffer replaces the mesh's
+        mesh->bind(commandBuffer);
+        VkBuffer indexBuffer = renderPath == MeshletRenderPath::TriangleFilter ? filteredIndexBuffer : meshlets->getIndexBuffer();
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+        uint32_t maxDraws = meshlets->getMeshletCount() * INSTANCE_COUNT;
+        if (device->capabilities().drawIndirectCount) {
+            device->cmdDrawIndexedIndirectCount(commandBuffer, drawCommandBuffer, 0, drawCountBuffer, 0, maxDraws, sizeof(VkDrawIndexedIndirectCommand));
+        } else {
+            // Culled slots have instanceCount 0
+            vkCmdDrawIndexedIndirect(commandBuffer, drawCommandBuffer, 0, maxDraws, sizeof(VkDrawIndexedIndirectCommand));
+        }
+    }
+
+    void MeshletScene::updateCameraBuffer(const FrameCamera& frameCamera) {
+        MeshletCameraData camData{};
+        camData.viewProj = frameCamera.proj * frameCamera.view;
+        camData.position = glm::vec4(frameCamera.position, 1.0f);
+
+        Frustum frustum = Frustum::fromViewProjection(camData.viewProj);
+        for (int i = 0; i < Frustum::PlaneCount; i++) {
+            camData.frustumPlanes[i] = frustum.planes[i];
+        }
+
+        memcpy(cameraBufferMapped, &camData, sizeof(MeshletCameraData));
+    }
+
+    void MeshletScene::onImGuiRender() {
+        ImGui::Begin("Meshlet Culling");
+        if (mesh && mesh->getMeshlets()) {
+            const MeshletBuffers* meshlets = mesh->getMeshlets();
+            ImGui::Text("Meshlets: %u (max %u vertices, %u triangles)", meshlets->getMeshletCount(), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+            ImGui::Text("Triangles: %u per mesh, %u total", meshlets->getTriangleCount(), meshlets->getTriangleCount() * INSTANCE_COUNT);
+            ImGui::Text("Instances: %u, clusters tested: %u", INSTANCE_COUNT, meshlets->getMeshletCount() * INSTANCE_COUNT);
+        }
+
+        int path = static_cast<int>(renderPath);
+        ImGui::RadioButton("No culling", &path, static_cast<int>(MeshletRenderPath::NoCulling));
+        if (device && device->capabilities().drawIndirectFirstInstance) {
+            ImGui::RadioButton("Compute cull + indirect", &path, static_cast<int>(MeshletRenderPath::ComputeCull));
+            ImGui::RadioButton("Compute cull + triangle filter", &path, static_cast<int>(MeshletRenderPath::TriangleFilter));
+        } else {
+            ImGui::TextDisabled("Compute cull paths: not supported (drawIndirectFirstInstance)");
+        }
+        if (device && device->capabilities().meshShader) {
+            ImGui::RadioButton("Task/mesh shaders", &path, static_cast<int>(MeshletRenderPath::MeshShader));
+        } else {
+            ImGui::TextDisabled("Task/mesh shaders: not supported");
+        }
+        renderPath = static_cast<MeshletRenderPath>(path);
+
+        if (renderPath == MeshletRenderPath::TriangleFilter) {
+            ImGui::CheckboxFlags("Backface", &triangleTests, TRIANGLE_TEST_BACKFACE);
+            ImGui::CheckboxFlags("Zero area", &triangleTests, TRIANGLE_TEST_ZERO_AREA);
+            ImGui::CheckboxFlags("No pixel coverage", &triangleTests, TRIANGLE_TEST_SMALL);
+            ImGui::CheckboxFlags("Frustum", &triangleTests, TRIANGLE_TEST_FRUSTUM);
+            ImGui::Text("Output capacity: %u triangles", FILTERED_TRIANGLE_CAPACITY);
+        }
+        if (renderPath == MeshletRenderPath::ComputeCull || renderPath == MeshletRenderPath::TriangleFilter) {
+            bool countSupported = device && device->capabilities().drawIndirectCount;
+            ImGui::Text("Draw count: %s", countSupported ? "GPU (drawIndirectCount)" : "all slots, culled ones empty");
+        }
+        ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
+        ImGui::End();
+    }
+
+    void MeshletScene::cleanup() {
+        if (device) device->waitIdle();
+
+        if (cullPipeline != VK_NULL_HANDLE) { vkDestroyPipeline(device->device(), cullPipeline, nullptr); cullPipeline = VK_NULL_HANDLE; }
+        if (cullPipelineLayout != VK_NULL_HANDLE) { vkDestroyPipelineLayout(device->device(), cullPipelineLayout, nullptr); cullPipelineLayout = VK_NULL_HANDLE; }
+        if (filterPipeline != VK_NULL_HANDLE) { vkDestroyPipeline(device->device(), filterPipeline, nullptr); filterPipeline = VK_NULL_HANDLE; }
+        if (filterPipelineLayout != VK_NULL_HANDLE) { vkDestroyPipelineLayout(device->device(), filterPipelineLayout, nullptr); filterPipelineLayout = VK_NULL_HANDLE; }
+        if (vertexPipeline != VK_NULL_HANDLE) { vkDestroyPipeline(device->device(), vertexPipeline, nullptr); vertexPipeline = VK_NULL_HANDLE; }
+        if (meshPipeline != VK_NULL_HANDLE) { vkDestroyPipeline(device->device(), meshPipeline, nullptr); meshPipeline = VK_NULL_HANDLE; }
+        if (graphicsPipelineLayout != VK_NULL_HANDLE) { vkDestroyPipelineLayout(device->device(), graphicsPipelineLayout, nullptr); graphicsPipelineLayout = VK_NULL_HANDLE; }
+        if (cullSetLayout != VK_NULL_HANDLE) { vkDestroyDescriptorSetLayout(device->device(), cullSetLayout, nullptr); cullSetLayout = VK_NULL_HANDLE; }
+        if (graphicsSetLayout != VK_NULL_HANDLE) { vkDestroyDescriptorSetLayout(device->device(), graphicsSetLayout, nullptr); graphicsSetLayout = VK_NULL_HANDLE; }
+        if (filterSetLayout != VK_NULL_HANDLE) { vkDestroyDescriptorSetLayout(device->device(), filterSetLayout, nullptr); filterSetLayout = VK_NULL_HANDLE; }
+        if (descriptorPool != VK_NULL_HANDLE) { vkDestroyDescriptorPool(device->device(), descriptorPool, nullptr); descriptorPool = VK_NULL_HANDLE; }
+        cullSet = VK_NULL_HANDLE;
+        graphicsSet = VK_NULL_HANDLE;
+        filterSet = VK_NULL_HANDLE;
+
+        if (instanceBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), instanceBuffer, nullptr); instanceBuffer = VK_NULL_HANDLE; }
+        if (instanceBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), instanceBufferMemory, nullptr); instanceBufferMemory = VK_NULL_HANDLE; }
+        if (cameraBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), cameraBuffer, nullptr); cameraBuffer = VK_NULL_HANDLE; }
+        if (cameraBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), cameraBufferMemory, nullptr); cameraBufferMemory = VK_NULL_HANDLE; }
+        if (drawCommandBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), drawCommandBuffer, nullptr); drawCommandBuffer = VK_NULL_HANDLE; }
+        if (drawCommandBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), drawCommandBufferMemory, nullptr); drawCommandBufferMemory = VK_NULL_HANDLE; }
+        if (drawCountBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), drawCountBuffer, nullptr); drawCountBuffer = VK_NULL_HANDLE; }
+        if (drawCountBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), drawCountBufferMemory, nullptr); drawCountBufferMemory = VK_NULL_HANDLE; }
+        if (filteredIndexBuffer != VK_NULL_HANDLE) { vkDestroyBuffer(device->device(), filteredIndexBuffer, nullptr); filteredIndexBuffer = VK_NULL_HANDLE; }
+        if (filteredIndexBufferMemory != VK_NULL_HANDLE) { vkFreeMemory(device->device(), filteredIndexBufferMemory, nullptr); filteredIndexBufferMemory = VK_NULL_HANDLE; }
+        cameraBufferMapped = nullptr;
+
+        mesh.reset();
+    }
+}
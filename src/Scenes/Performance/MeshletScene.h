@@ -0,0 +1,140 @@
+#pragma once
+
+#include "../../Engine/Scene/Scene.h"
+#include "../../Engine/Scene/FramePacket.h"
+#include "../../Engine/Core/Camera.h"
+#include "../../Engine/Renderer/Mesh.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <glm/glm.hpp>
+
+namespace AhnrealEngine {
+
+    // Camera block shared by meshlet_cull.comp and the meshlet shaders
+    struct MeshletCameraData {
+        glm::mat4 viewProj;
+        glm::vec4 frustumPlanes[6];
+        glm::vec4 position;
+    };
+
+    // Push constants of meshlet_cull.comp
+    struct MeshletCullParams {
+        uint32_t meshletCount;
+        uint32_t instanceCount;
+        uint32_t compact; // Requires drawIndirectCount
+    };
+
+    // Push constants of triangle_cull.comp
+    struct TriangleFilterParams {
+        uint32_t meshletCount;
+        uint32_t instanceCount;
+        uint32_t compact;
+        uint32_t tests;            // TriangleFilterTest bits
+        uint32_t triangleCapacity; // Of the output region
+        uint32_t outputOffset;     // First output index in filteredIndexBuffer
+        glm::vec2 viewportSize;
+    };
+
+    enum TriangleFilterTest : uint32_t {
+        TRIANGLE_TEST_BACKFACE = 1u << 0,
+        TRIANGLE_TEST_ZERO_AREA = 1u << 1,
+        TRIANGLE_TEST_SMALL = 1u << 2,   // Covers no pixel center
+        TRIANGLE_TEST_FRUSTUM = 1u << 3,
+        TRIANGLE_TEST_ALL = 0xF
+    };
+
+    enum class MeshletRenderPath {
+        NoCulling,      // One instanced draw of the whole mesh
+        ComputeCull,    // meshlet_cull.comp -> indirect draws
+        TriangleFilter, // triangle_cull.comp -> compacted indices + indirect draws
+        MeshShader      // meshlet.task culls, meshlet.mesh expands
+    };
+
+    // Draws a grid of dense meshes split into meshlets (see Meshlet.h) and
+    // culls them per cluster on the GPU, so clusters outside the frustum or
+    // facing away from the camera are never rasterized. The triangle filter
+    // path additionally drops individual triangles before primitive setup.
+    class MeshletScene : public Scene {
+    public:
+        MeshletScene();
+        ~MeshletScene();
+
+        void initialize() override;
+        void initialize(VulkanRenderer* renderer) override;
+        void onImGuiRender() override;
+
+        bool supportsPipelinedUpdate() const override { return true; }
+        bool supportsFixedTimestep() const override { return true; }
+        void update(float deltaTime, FramePacket& packet) override;
+        void preRender(VulkanRenderer* renderer, const FramePacket& packet) override;
+        void render(VulkanRenderer* renderer, const FramePacket& packet) override;
+
+        // Mesh generation, meshlet build and uploads run in prepare()
+        bool supportsPreload() const override { return true; }
+        void prepare(VulkanRenderer* renderer, LoadProgress& progress) override;
+
+    private:
+        void cleanup();
+        void createMesh();
+        void createBuffers();
+        void createDescriptors();
+        void createComputePipelines();
+        VkPipeline createComputePipeline(const std::string& shaderFile, VkPipelineLayout layout);
+        void createGraphicsPipelines(VulkanRenderer* renderer);
+        void updateCameraBuffer(const FrameCamera& frameCamera);
+        void recordCulling(VkCommandBuffer commandBuffer, VkExtent2D extent);
+
+        VulkanDevice* device = nullptr;
+        Camera camera;
+
+        // Sphere tessellation and instance grid; see createMesh
+        static constexpr uint32_t SPHERE_SEGMENTS = 252;
+        static constexpr uint32_t SPHERE_RINGS = 126;
+        static constexpr uint32_t GRID_SIZE = 16;
+        static constexpr uint32_t INSTANCE_COUNT = GRID_SIZE * GRID_SIZE;
+        // Triangles the filter can output per frame; clusters that don't fit
+        // are drawn unfiltered
+        static constexpr uint32_t FILTERED_TRIANGLE_CAPACITY = 4u << 20;
+
+        std::unique_ptr<Mesh> mesh;
+
+        VkBuffer instanceBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory instanceBufferMemory = VK_NULL_HANDLE;
+
+        VkBuffer cameraBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory cameraBufferMemory = VK_NULL_HANDLE;
+        void* cameraBufferMapped = nullptr;
+
+        // One command slot per (meshlet, instance) pair, plus the GPU-written
+        // counters: draws, then triangles written by the filter
+        VkBuffer drawCommandBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory drawCommandBufferMemory = VK_NULL_HANDLE;
+        VkBuffer drawCountBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory drawCountBufferMemory = VK_NULL_HANDLE;
+
+        // The meshlet index buffer followed by the triangle filter's output
+        // region, so overflowing clusters can fall back to their static range
+        VkBuffer filteredIndexBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory filteredIndexBufferMemory = VK_NULL_HANDLE;
+
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSetLayout cullSetLayout = VK_NULL_HANDLE;
+        VkDescriptorSet cullSet = VK_NULL_HANDLE;
+        VkDescriptorSetLayout graphicsSetLayout = VK_NULL_HANDLE;
+        VkDescriptorSet graphicsSet = VK_NULL_HANDLE;
+        VkDescriptorSetLayout filterSetLayout = VK_NULL_HANDLE;
+        VkDescriptorSet filterSet = VK_NULL_HANDLE;
+
+        VkPipeline cullPipeline = VK_NULL_HANDLE;
+        VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+        VkPipeline filterPipeline = VK_NULL_HANDLE;
+        VkPipelineLayout filterPipelineLayout = VK_NULL_HANDLE;
+        VkPipelineLayout graphicsPipelineLayout = VK_NULL_HANDLE;
+        VkPipeline vertexPipeline = VK_NULL_HANDLE;
+        VkPipeline meshPipeline = VK_NULL_HANDLE; // Only with mesh shader support
+
+        MeshletRenderPath renderPath = MeshletRenderPath::ComputeCull;
+        uint32_t triangleTests = TRIANGLE_TEST_ALL;
+    };
+}
@@ -0,0 +1,100 @@
+#version 450
+
+// Clustered forward shading: only the lights cluster_lights.comp binned
+// into this fragment's froxel are evaluated
+
+layout(location = 0) in vec3 fragWorldPosition;
+layout(location = 1) in vec3 fragNormal;
+layout(location = 2) in float fragViewDepth;
+
+layout(location = 0) out vec4 outColor;
+
+struct Light {
+    vec3 position;
+    float range;
+    vec3 color;
+    float cosInner;
+    vec3 direction;
+    float cosOuter; // -1 for point lights
+};
+
+// Set 1 is ClusteredLighting's
+layout(set = 1, binding = 0) uniform ClusterParams {
+    mat4 view;
+    uvec4 grid;   // Clusters along x, y, z; light count
+    vec4 screen;  // Clusters per pixel (x, y); tan of the half field of view (x, y)
+    vec4 depth;   // Near, far, slice scale, slice bias
+    uvec4 limits; // Light index capacity
+} params;
+
+layout(std430, set = 1, binding = 1) readonly buffer Lights {
+    Light lights[];
+} lights;
+
+layout(std430, set = 1, binding = 2) readonly buffer Clusters {
+    uvec2 ranges[]; // Offset into indices, count
+} clusters;
+
+layout(std430, set = 1, binding = 3) readonly buffer LightIndices {
+    uint indices[];
+} lightIndices;
+
+layout(push_constant) uniform PushConstants {
+    uint mode; // ClusteredShadingMode
+} push;
+
+const uint MODE_CLUSTERED = 0;
+const uint MODE_ALL_LIGHTS = 1;
+const uint MODE_HEATMAP = 2;
+
+const vec3 ALBEDO = vec3(0.8);
+const vec3 AMBIENT = vec3(0.02);
+
+vec3 shade(Light light, vec3 position, vec3 normal) {
+    vec3 toLight = light.position - position;
+    float distanceSq = dot(toLight, toLight);
+    float rangeSq = light.range * light.range;
+    if (distanceSq >= rangeSq) return vec3(0.0);
+
+    vec3 l = toLight * inversesqrt(distanceSq);
+    // Inverse square, windowed to reach zero at the range the lights were binned with
+    float ratio = distanceSq / rangeSq;
+    float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+    float attenuation = window * window / (distanceSq + 1.0);
+
+    if (light.cosOuter > -1.0) {
+        attenuation *= smoothstep(light.cosOuter, light.cosInner, dot(-l, light.direction));
+    }
+    return light.color * ALBEDO * max(dot(normal, l), 0.0) * attenuation;
+}
+
+vec3 heatmap(float t) {
+    return clamp(vec3(t * 2.0 - 0.5, sin(t * 3.14159), 1.0 - t * 2.0), 0.0, 1.0);
+}
+
+void main() {
+    vec3 normal = normalize(fragNormal);
+
+    uvec2 tile = min(uvec2(gl_FragCoord.xy * params.screen.xy), params.grid.xy - 1u);
+    float slice = log(max(fragViewDepth, params.depth.x)) * params.depth.z + params.depth.w;
+    uint z = uint(clamp(slice, 0.0, float(params.grid.z - 1u)));
+    uvec2 range = clusters.ranges[tile.x + params.grid.x * (tile.y + params.grid.y * z)];
+
+    if (push.mode == MODE_HEATMAP) {
+        outColor = vec4(heatmap(float(range.y) / 64.0), 1.0);
+        return;
+    }
+
+    vec3 color = AMBIENT * ALBEDO;
+    if (push.mode == MODE_ALL_LIGHTS) {
+        // Reference path: every light, whatever its distance
+        for (uint i = 0; i < params.grid.w; i++) {
+            color += shade(lights.lights[i], fragWorldPosition, normal);
+        }
+    } else {
+        for (uint i = 0; i < range.y; i++) {
+            color += shade(lights.lights[lightIndices.indices[range.x + i]], fragWorldPosition, normal);
+        }
+    }
+    outColor = vec4(color, 1.0);
+}
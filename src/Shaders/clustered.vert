@@ -0,0 +1,29 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+
+layout(location = 0) out vec3 fragWorldPosition;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out float fragViewDepth;
+
+layout(set = 0, binding = 0) uniform CameraUBO {
+    mat4 view;
+    mat4 viewProj;
+} camera;
+
+// Translation and uniform scale per instance
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+    vec4 positionScale[];
+} instances;
+
+void main() {
+    vec4 positionScale = instances.positionScale[gl_InstanceIndex];
+    vec3 worldPosition = positionScale.xyz + inPosition * positionScale.w;
+
+    gl_Position = camera.viewProj * vec4(worldPosition, 1.0);
+    fragWorldPosition = worldPosition;
+    fragNormal = inNormal;
+    // Positive distance along the view direction, as the cluster slices use
+    fragViewDepth = -(camera.view * vec4(worldPosition, 1.0)).z;
+}
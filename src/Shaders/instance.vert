@@ -12,30 +12,39 @@ layout(location = 1) out vec2 fragTexCoord;
 layout(set = 0, binding = 0) uniform CameraUBO {
     mat4 view;
     mat4 proj;
-    // ... light info etc
+    mat4 viewProj; // Premultiplied on the CPU once per frame
+    vec4 frustumPlanes[6];
 } camera;
 
-// Same binding slot as Compute Shader for Instance Data? 
-// No, Graphics Pipeline will have its own descriptor set layout.
-// Let's assume Set 1 Binding 0 is Instance Data, Set 1 Binding 1 is Visible Indices (SSBO)
+// Set 1: instance streams (see InstanceStreams.h) and the visible list from cull.comp
+layout(std430, set = 1, binding = 0) readonly buffer PositionScaleStream {
+    vec4 positionScale[];
+} positions;
 
-layout(std140, set = 1, binding = 0) readonly buffer InstanceData {
-    mat4 modelMatrix[];
-} instances;
-
-layout(std140, set = 1, binding = 1) readonly buffer VisibleInstances {
+layout(std430, set = 1, binding = 1) readonly buffer VisibleInstances {
     uint indices[];
 } visibleInstances;
 
+layout(std430, set = 1, binding = 2) readonly buffer RotationStream {
+    uvec2 rotation[]; // Quaternion xyzw as 4 x snorm16
+} rotations;
+
+vec3 rotateByQuat(vec4 q, vec3 v) {
+    vec3 t = 2.0 * cross(q.xyz, v);
+    return v + q.w * t + cross(q.xyz, t);
+}
+
 void main() {
     // Indirect Draw: gl_InstanceIndex counts from 0 to instanceCount-1 (the visible ones)
     // We need to look up the ACTUAL original instance index
     uint originalIndex = visibleInstances.indices[gl_InstanceIndex];
-    
-    mat4 model = instances.modelMatrix[originalIndex];
-    mat4 mvp = camera.proj * camera.view * model;
-    
-    gl_Position = mvp * vec4(inPosition, 1.0);
+
+    vec4 positionScale = positions.positionScale[originalIndex];
+    uvec2 packedRotation = rotations.rotation[originalIndex];
+    vec4 rotation = normalize(vec4(unpackSnorm2x16(packedRotation.x), unpackSnorm2x16(packedRotation.y)));
+
+    vec3 worldPosition = positionScale.xyz + rotateByQuat(rotation, inPosition * positionScale.w);
+    gl_Position = camera.viewProj * vec4(worldPosition, 1.0);
     
     // Simple color based on normal
     fragColor = (inNormal + 1.0) * 0.5; 
@@ -0,0 +1,62 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec3 inTangent;
+layout(location = 4) in vec3 inBitangent;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+// Bindless heap (BindlessHeap::STORAGE_BUFFER_BINDING). Every storage buffer
+// lives in the same array; each block below is just a typed view of it.
+layout(std430, set = 0, binding = 0) readonly buffer CameraBuffer {
+    mat4 view;
+    mat4 proj;
+    mat4 viewProj;
+    vec4 frustumPlanes[6];
+} cameras[];
+
+// Instance streams (see InstanceStreams.h)
+layout(std430, set = 0, binding = 0) readonly buffer PositionScaleBuffer {
+    vec4 positionScale[];
+} positionBuffers[];
+
+layout(std430, set = 0, binding = 0) readonly buffer RotationBuffer {
+    uvec2 rotation[];
+} rotationBuffers[];
+
+layout(std430, set = 0, binding = 0) readonly buffer VisibleBuffer {
+    uint indices[];
+} visibleBuffers[];
+
+// Heap slots of the buffers used by this draw
+layout(push_constant) uniform DrawIndices {
+    uint cameraIndex;
+    uint positionScaleIndex;
+    uint rotationIndex;
+    uint visibleIndex;
+} draw;
+
+vec3 rotateByQuat(vec4 q, vec3 v) {
+    vec3 t = 2.0 * cross(q.xyz, v);
+    return v + q.w * t + cross(q.xyz, t);
+}
+
+void main() {
+    // Indirect Draw: gl_InstanceIndex counts the visible instances only
+    uint originalIndex = visibleBuffers[draw.visibleIndex].indices[gl_InstanceIndex];
+
+    vec4 positionScale = positionBuffers[draw.positionScaleIndex].positionScale[originalIndex];
+    uvec2 packedRotation = rotationBuffers[draw.rotationIndex].rotation[originalIndex];
+    vec4 rotation = normalize(vec4(unpackSnorm2x16(packedRotation.x), unpackSnorm2x16(packedRotation.y)));
+
+    vec3 worldPosition = positionScale.xyz + rotateByQuat(rotation, inPosition * positionScale.w);
+    gl_Position = cameras[draw.cameraIndex].viewProj * vec4(worldPosition, 1.0);
+
+    // Simple color based on normal
+    fragColor = (inNormal + 1.0) * 0.5;
+    fragTexCoord = inTexCoord;
+}
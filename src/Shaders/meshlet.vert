@@ -0,0 +1,31 @@
+#version 450
+
+// Vertex shader path of MeshletScene: plain indexed draws over the meshlet
+// index buffer, one instance per draw or one draw for every instance
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec3 inTangent;
+layout(location = 4) in vec3 inBitangent;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+layout(set = 0, binding = 0) uniform CameraData {
+    mat4 viewProj;
+    vec4 frustumPlanes[6];
+    vec4 position;
+} camera;
+
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+    vec4 positionScale[]; // xyz: translation, w: uniform scale
+} instances;
+
+void main() {
+    vec4 positionScale = instances.positionScale[gl_InstanceIndex];
+    gl_Position = camera.viewProj * vec4(positionScale.xyz + inPosition * positionScale.w, 1.0);
+
+    fragColor = (inNormal + 1.0) * 0.5;
+    fragTexCoord = inTexCoord;
+}
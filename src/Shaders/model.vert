@@ -0,0 +1,28 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    vec3 lightPos;
+    vec3 viewPos;
+} ubo;
+
+// World matrix of the mesh's node in the model hierarchy
+layout(push_constant) uniform NodeData {
+    mat4 world;
+} node;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+
+layout(location = 0) out vec3 fragColor;
+
+// Matches model_depth.vert bit for bit for the depth pre-pass
+invariant gl_Position;
+
+void main() {
+    gl_Position = ubo.proj * ubo.view * ubo.model * node.world * vec4(inPosition, 1.0);
+    // Same normal-as-color output the scene had with cube.vert
+    fragColor = inNormal;
+}
@@ -0,0 +1,24 @@
+#version 450
+
+// Depth pre-pass for model.vert: reads only the position stream and must
+// produce the exact same depth, since the shading pass tests with EQUAL
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    vec3 lightPos;
+    vec3 viewPos;
+} ubo;
+
+layout(push_constant) uniform NodeData {
+    mat4 world;
+} node;
+
+layout(location = 0) in vec3 inPosition;
+
+invariant gl_Position;
+
+void main() {
+    gl_Position = ubo.proj * ubo.view * ubo.model * node.world * vec4(inPosition, 1.0);
+}